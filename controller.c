@@ -1,15 +1,40 @@
+// controller  --  Prints state of the first attached game controller, 60 times per second.
+//
+// Build:  `cl controller.c` on Windows (DirectInput8 backend),
+//         `cc -O2 -pthread -o controller controller.c` on Linux (evdev backend, reads `/dev/input/event*`).
+// Usage:  `controller [--haptics]`
+//
+// Platform code sits behind `contrl_backend`:  enumeration, capabilities, state reads and force feedback.
+// Every backend reports state as `contrl_joystate`, laid out and scaled like DirectInput's `DIJOYSTATE`,
+//   so the `contrl_print_device_state_*` functions do not know which one produced it.
+// `--haptics` plays a short constant force (or rumble) effect once the device is acquired.
+
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
-
-#include <Windows.h>
-// DirectInput8, part of DirectX 8.
-#define DIRECTINPUT_VERSION 0x0800
-#include <dinput.h>
-
-#pragma comment(lib, "dinput8.lib")
-#pragma comment(lib, "dxguid.lib")
-#pragma comment(lib, "user32.lib")
+#include <stddef.h>
+#include <string.h>
+
+#if defined( _WIN32 )
+	#include <Windows.h>
+	// DirectInput8, part of DirectX 8.
+	#define DIRECTINPUT_VERSION 0x0800
+	#include <dinput.h>
+
+	#pragma comment(lib, "dinput8.lib")
+	#pragma comment(lib, "dxguid.lib")
+	#pragma comment(lib, "user32.lib")
+#elif defined( __linux__ )
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <time.h>
+	#include <unistd.h>
+	#include <sys/epoll.h>
+	#include <sys/ioctl.h>
+	#include <linux/input.h>
+#else
+	#error "No controller backend for this platform."
+#endif
 
 #define CONTRL_ALLOC( count, type )                          malloc( count * sizeof( type ) )
 #define CONTRL_REALLOC( pointer, old_size, new_size, type )  realloc( pointer, new_size * sizeof( type ) )
@@ -20,38 +45,34 @@
 	#define CONTRL_DEBUG 0
 #endif
 
-#if CONTRL_DEBUG
-	#define CONTRL_TRACE( format, ... )                        contrl__fprintf( stdout, "TRACE: ", 7, format, __VA_ARGS__ ); putc( '\n', stdout )
-	#define CONTRL_TRACE2( prefix, prefix_size, format, ... )  contrl__fprintf( stdout, prefix, prefix_size, format, __VA_ARGS__ )
-#else
-	#define CONTRL_TRACE( format, ... )
-	#define CONTRL_TRACE2( prefix, prefix_size, format, ... )
-#endif /* CONTRL_DEBUG */
+// Output goes through the asynchronous logger shared with `ftdc`, traces are compiled in with `CONTRL_DEBUG` only.
+#if CONTRL_DEBUG && !defined( LOGGER_LEVEL_MIN )
+	#define LOGGER_LEVEL_MIN LOGGER_LEVEL_TRACE
+#endif
+#define LOGGER_IMPLEMENTATION
+#include "logger.h"
 
-#define CONTRL_ERROR( exit_code, format, ... )  contrl__fprintf( stderr, "ERROR: ", 7, format, __VA_ARGS__ ); exit( exit_code )
-#define CONTRL_WARN( format, ... )              contrl__fprintf( stdout, "WARNING: ", 9, format, __VA_ARGS__ )
-#define CONTRL_PRINT( format, ... )             contrl__fprintf( stdout, NULL, 0, format, __VA_ARGS__ )
-#define CONTRL_WPRINT( format, ... )            contrl__fwprintf( stdout, NULL, 0, format, __VA_ARGS__ )
+#define CONTRL_TRACE( format, ... )                        LOGGER_TRACE( stdout, "TRACE: ", 7, format "\n", ##__VA_ARGS__ )
+#define CONTRL_TRACE2( prefix, prefix_size, format, ... )  LOGGER_TRACE( stdout, prefix, prefix_size, format, ##__VA_ARGS__ )
+
+#define CONTRL_ERROR( exit_code, format, ... )  LOGGER_ERROR( stderr, "ERROR: ", 7, format, ##__VA_ARGS__ ); exit( exit_code )
+#define CONTRL_WARN( format, ... )              LOGGER_WARN( stdout, "WARNING: ", 9, format, ##__VA_ARGS__ )
+#define CONTRL_PRINT( format, ... )             LOGGER_INFO( stdout, NULL, 0, format, ##__VA_ARGS__ )
 
 
 // ESC [ s  -- Save Cursor
 #define CONSOLE_SC "\x1B[s"
-#define CONSOLE_SC_LEN 3
 // ESC [ u  -- Restore cursor
 #define CONSOLE_RC "\x1B[u"
-#define CONSOLE_RC_LEN 3
 
-// GUID's Vendor IDs
+// USB Vendor IDs
 #define VID_SONY      0x054C
 #define VID_LOGITECH  0x046D
 
-// GUID's Product IDs
+// USB Product IDs
 #define PID_SONY_DUALSHOCK4  0x09CC
 #define PID_LOGITECH_G923    0xC266
 
-#define GUID_PRODUCT_GET_PID( guidData1 )  ( guidData1 >> 16 )
-#define GUID_PRODUCT_GET_VID( guidData1 )  ( guidData1 & 0x0000FFFF )
-
 #ifndef CONTRL_CUSTOM_BOOL
 enum bool_e {
 	false = 0,
@@ -64,158 +85,127 @@ typedef uint8_t bool;
 #define C_BOOL( expr )  ( !!( expr ) )
 #endif
 
-typedef int ( * PFN_PrintDeviceState )( char *buffer, size_t buffer_size, DIJOYSTATE *j );
-
-static void contrl__fprintf( FILE *stream, const char *prefix, size_t prefix_size, const char *format, ... ) {
-	fwrite( prefix, sizeof( char ), prefix_size, stream );
-	va_list args;
-	va_start( args, format );
-	vfprintf( stream, format, args );
-	va_end( args );
-}
-
-static void contrl__fwprintf( FILE *stream, const wchar_t *prefix, size_t prefix_size, const wchar_t *format, ... ) {
-	fwrite( prefix, sizeof( char ), prefix_size, stream );
-	va_list args;
-	va_start( args, format );
-	vfwprintf( stream, format, args );
-	va_end( args );
-}
-
-
-typedef struct DeviceGetFirstContext {
-	LPDIRECTINPUT8        pDirectInput;        // In parameter.  Pointer to the instance of DirectInput8.
-	LPDIRECTINPUTDEVICE8 *ppControllerDevice;  // In-Out parameter.  Pointer to a pointer to where created device pointer (LPDIRECTINPUTDEVICE8) will be stored.
-	DIDEVICEINSTANCE     *pDeviceInstance;     // In-Out parameter, can be NULL.  Pointer to where DIDEVICEINSTANCE will be stored.
-} DeviceGetFirstContext;
-
-static BOOL CALLBACK contrl__device_get_first_callback( const DIDEVICEINSTANCE *pInstance, DeviceGetFirstContext *pContext ) {
-	HRESULT hResult = IDirectInput8_CreateDevice(
-		/*                  this */ pContext->pDirectInput,
-		/*                 rguid */ &pInstance->guidInstance,
-		/* lplpDirectInputDevice */ pContext->ppControllerDevice,
-		/*             pUnkOuter */ NULL );
-	if ( hResult != DI_OK )  return DIENUM_CONTINUE;
-	if ( pContext->pDeviceInstance != NULL )  *pContext->pDeviceInstance = *pInstance;
-	return DIENUM_STOP;
-}
-
-typedef struct DeviceEffectsSupportedContext {
-	int nEffects;  // Out parameter.  Set to 0 before call!  Number of effects supported by the force-feedback system.
-} DeviceEffectsSupportedContext;
-
-static BOOL CALLBACK contrl__device_effects_supported_callback( const DIEFFECTINFO *pDIEffectInfo, DeviceEffectsSupportedContext *pContext ) {
-	pContext->nEffects += 1;
-	return DIENUM_CONTINUE;
-}
-
-static void contrl__debug_print_device_info( const DIDEVICEINSTANCE *i ) {
-	const GUID *const gI = &i->guidInstance;
-	const GUID *const gP = &i->guidProduct;
-	const GUID *const gD = &i->guidFFDriver;
-
-	char data4Bytes[ 64 ] = { 0 };  // Only 51 bytes are used, but aligned to 64.
-	char *const gIData4 = data4Bytes;
-	char *const gPData4 = gIData4 + 17;  // 16 chars + 1 null-terminator
-	char *const gDData4 = gPData4 + 17;  // 16 chars + 1 null-terminator
-	for ( int i = 0; i < 8; i += 1 ) {
-		// Write 1 byte of each GUID simultaneously.
-		sprintf( &gIData4[ 2 * i ], "%02X", gI->Data4[ i ] );
-		sprintf( &gPData4[ 2 * i ], "%02X", gP->Data4[ i ] );
-		sprintf( &gDData4[ 2 * i ], "%02X", gD->Data4[ i ] );
-	}
-
-	CONTRL_TRACE2( "TRACE: ", 7,
-		"Device info:\n"
-		"  dwSize: %lu\n"
-		"  guidInstance: %08X-%04hX-%04hX-%s (\"%.*s\")\n"
-		"  guidProduct: %08X-%04hX-%04hX-%s (\"%.*s\")\n"
-		"  dwDevType: 0x%08X\n",
-		i->dwSize,
-		gI->Data1, gI->Data2, gI->Data3, gIData4, 6, &gI->Data4[ 2 ],
-		gP->Data1, gP->Data2, gP->Data3, gPData4, 6, &gP->Data4[ 2 ],
-		i->dwDevType );
-
-#if UNICODE
-	CONTRL_WPRINT( 
-		L"  tszInstanceName: \"%s\"\n"
-		L"  tszProductName: \"%s\"\n",
-		i->tszInstanceName, i->tszProductName );
-#else
-	CONTRL_PRINT( 
-		"  tszInstanceName: \"%s\"\n"
-		"  tszProductName: \"%s\"\n",
-		i->tszInstanceName, i->tszProductName );
-#endif
-
-	CONTRL_PRINT(
-		"  guidFFDriver: %08X-%04hX-%04hX-%s\n"
-		"  wUsagePage: 0x%08X\n"
-		"  wUsage: 0x%08X\n",
-		gD->Data1, gD->Data2, gD->Data3, gDData4,
-		i->wUsagePage,
-		i->wUsage );
+// Range of `contrl_joystate` axes, DirectInput's default:  0..32767..65535.
+#define CONTRL_AXIS_MAX     65535
+#define CONTRL_AXIS_CENTER  32767  // Where DirectInput reports a stick at rest.
+
+// Range of `contrl_play_force` magnitude, DirectInput's:  -10000..10000.
+#define CONTRL_FORCE_MAX 10000
+
+// `contrl_joystate.rgdwPOV` of a centered POV.
+#define CONTRL_POV_CENTERED 0xFFFFFFFF
+
+// Controller state, same layout, names and ranges as DirectInput's `DIJOYSTATE`:
+//   axes 0..65535, POVs in hundredths of degrees clockwise from north (or `CONTRL_POV_CENTERED`),
+//   buttons 0x80 when pressed.  Backends map their own events onto it.
+typedef struct contrl_joystate {
+	int32_t  lX;
+	int32_t  lY;
+	int32_t  lZ;
+	int32_t  lRx;
+	int32_t  lRy;
+	int32_t  lRz;
+	int32_t  rglSlider[ 2 ];
+	uint32_t rgdwPOV[ 4 ];
+	uint8_t  rgbButtons[ 32 ];
+} contrl_joystate;
+
+// Axes of `contrl_joystate`, in its order.
+typedef enum contrl_axis {
+	CONTRL_AXIS_X = 0,
+	CONTRL_AXIS_Y,
+	CONTRL_AXIS_Z,
+	CONTRL_AXIS_RX,
+	CONTRL_AXIS_RY,
+	CONTRL_AXIS_RZ,
+	CONTRL_AXIS_SLIDER0,
+	CONTRL_AXIS_SLIDER1,
+	CONTRL_AXES_COUNT
+} contrl_axis;
+
+static const size_t contrl_axis_offsets[ CONTRL_AXES_COUNT ] = {
+	offsetof( contrl_joystate, lX ),
+	offsetof( contrl_joystate, lY ),
+	offsetof( contrl_joystate, lZ ),
+	offsetof( contrl_joystate, lRx ),
+	offsetof( contrl_joystate, lRy ),
+	offsetof( contrl_joystate, lRz ),
+	offsetof( contrl_joystate, rglSlider[ 0 ] ),
+	offsetof( contrl_joystate, rglSlider[ 1 ] )
+};
 
-	CONTRL_TRACE( "Vendor ID (VID): 0x%04X, Product ID (PID): 0x%04X",
-		GUID_PRODUCT_GET_VID( gP->Data1 ), GUID_PRODUCT_GET_PID( gP->Data1 ) );
-}
+typedef struct contrl_caps {
+	uint32_t axes;
+	uint32_t buttons;
+	uint32_t povs;
+	bool     ff;                      // Supports force feedback.
+	uint32_t ff_effects;              // Effects supported (DirectInput) or uploadable at once (evdev).
+	uint32_t ff_sample_period;        // DirectInput only, 0 otherwise.
+	uint32_t ff_min_time_resolution;  // DirectInput only, 0 otherwise.
+} contrl_caps;
+
+typedef struct contrl_backend contrl_backend;
+
+typedef struct contrl_device {
+	const contrl_backend *backend;
+	char                  name[ 256 ];  // UTF-8.
+	uint16_t              vid;
+	uint16_t              pid;
+	void                 *data;         // Backend's own state of the device.
+} contrl_device;
+
+// Failures a program cannot go on after exit with `CONTRL_ERROR`, like everywhere else here.
+typedef void ( * PFN_BackendInit )( void );
+typedef bool ( * PFN_BackendOpenFirst )( contrl_device *device );  // False if no controller is attached.
+typedef void ( * PFN_BackendGetCapabilities )( contrl_device *device, contrl_caps *caps );
+typedef void ( * PFN_BackendAcquire )( contrl_device *device );
+typedef long ( * PFN_BackendReadState )( contrl_device *device, contrl_joystate *state );  // 0, or error code.
+typedef void ( * PFN_BackendPlayForce )( contrl_device *device, int32_t magnitude, uint32_t duration_us );
+typedef void ( * PFN_BackendClose )( contrl_device *device );
+
+struct contrl_backend {
+	const char                 *name;
+	PFN_BackendInit             init;
+	PFN_BackendOpenFirst        open_first;
+	PFN_BackendGetCapabilities  get_capabilities;
+	PFN_BackendAcquire          acquire;           // Starts state reads.
+	PFN_BackendReadState        read_state;        // Never blocks.
+	PFN_BackendPlayForce        play_force;
+	PFN_BackendClose            close;
+};
 
-static void contrl__debug_print_device_capabilities( const DIDEVCAPS *c ) {
-	CONTRL_TRACE( "Device capabilities:\n"
-		"  dwSize: %u\n"
-		"  dwFlags: 0x%08X\n"
-		"  dwDevType: 0x%08X (type=0x%02X, subtype=0x%02X)\n"
-		"  dwAxes: %u\n"
-		"  dwButtons: %u\n"
-		"  dwPOVs: %u\n"
-		"  dwFFSamplePeriod: %u\n"
-		"  dwFFMinTimeResolution: %u\n"
-		"  dwFirmwareRevision: 0x%08X\n"
-		"  dwHardwareRevision: 0x%08X\n"
-		"  dwFFDriverVersion: 0x%08X",
-		c->dwSize,
-		c->dwFlags,
-		c->dwDevType, GET_DIDEVICE_TYPE( c->dwDevType ), GET_DIDEVICE_SUBTYPE( c->dwDevType ),
-		c->dwAxes,
-		c->dwButtons,
-		c->dwPOVs,
-		c->dwFFSamplePeriod,
-		c->dwFFMinTimeResolution,
-		c->dwFirmwareRevision,
-		c->dwHardwareRevision,
-		c->dwFFDriverVersion );
-}
+typedef int ( * PFN_PrintDeviceState )( char *buffer, size_t buffer_size, const contrl_joystate *j );
 
-int contrl_print_device_state_generic( char *buffer, size_t buffer_size, DIJOYSTATE *j ) {
+int contrl_print_device_state_generic( char *buffer, size_t buffer_size, const contrl_joystate *j ) {
 	int cursor = 0;
 
 	// Position + Rotation
 	cursor += snprintf( buffer + cursor, buffer_size - cursor,
-		" lX: [%5ld]  lY: [%5ld]  lZ: [%5ld]\n"
-		"lRx: [%5ld] lRy: [%5ld] lRz: [%5ld]\n",
+		" lX: [%5d]  lY: [%5d]  lZ: [%5d]\n"
+		"lRx: [%5d] lRy: [%5d] lRz: [%5d]\n",
 		j->lX, j->lY, j->lZ,
 		j->lRx, j->lRy, j->lRz );
 
 	// Sliders
 	cursor += snprintf( buffer + cursor, buffer_size - cursor,
 		"rglSlider:\n"
-		"  [0]: [%5ld]\n"
-		"  [1]: [%5ld]\n",
+		"  [0]: [%5d]\n"
+		"  [1]: [%5d]\n",
 		j->rglSlider[ 0 ], j->rglSlider[ 1 ] );
 
 	// POVs
 	cursor += snprintf( buffer + cursor, buffer_size - cursor,
 		"rgdwPOV:\n"
-		"  [0]: [%10lu]\n"
-		"  [1]: [%10lu]\n"
-		"  [2]: [%10lu]\n"
-		"  [3]: [%10lu]\n",
+		"  [0]: [%10u]\n"
+		"  [1]: [%10u]\n"
+		"  [2]: [%10u]\n"
+		"  [3]: [%10u]\n",
 		j->rgdwPOV[ 0 ], j->rgdwPOV[ 1 ], j->rgdwPOV[ 2 ], j->rgdwPOV[ 3 ]
 	 );
 
 	// Buttons
 	cursor += snprintf( buffer + cursor, buffer_size - cursor, "rgbButtons:\n" );
-	BYTE *pbValue = ( BYTE * )&j->rgbButtons;
+	const uint8_t *pbValue = j->rgbButtons;
 	for ( int i = 0; i < 32 / 4; i += 1 ) {
 		// Print 4 columns row-by-row.
 		// Each column continues previous one.
@@ -230,70 +220,12 @@ int contrl_print_device_state_generic( char *buffer, size_t buffer_size, DIJOYST
 	return cursor;
 }
 
-static void contrl_test_haptics( const LPDIRECTINPUTDEVICE8 pControllerDevice ) {
-	DIEFFECT effect = { 0 };
-	effect.dwSize = sizeof( DIEFFECT );
-	effect.dwFlags = DIEFF_CARTESIAN | DIEFF_OBJECTIDS;
-	effect.dwDuration = 5 * 1000;  // In Us - microseconds
-	effect.dwSamplePeriod = 0;  // Default
-	// effect.dwGain = DI_FFNOMINALMAX;
-	effect.lpvTypeSpecificParams = DIEFT_CONSTANTFORCE;
-	
-
-	// In range of: [-10_000, 10_000]
-	DICONSTANTFORCE cForce = { .lMagnitude = 100000 };
-
-	effect.cbTypeSpecificParams = sizeof( DICONSTANTFORCE );
-	effect.lpvTypeSpecificParams = &cForce;
-
-	/* Create Force-feedback effect */
-
-	LPDIRECTINPUTEFFECT pDIEffect = NULL;
-	HRESULT hDIResult = IDirectInputDevice8_CreateEffect(
-		/*      this */ pControllerDevice,
-		/*      guid */ &GUID_ConstantForce,
-		/*     lpeff */ &effect,  // Passed effect setup parameters
-		/*    ppdeff */ &pDIEffect,  // Returned DirectInput effect object
-		/* pUnkOuter */ NULL );
-	if ( hDIResult != DI_OK ) {
-		const char *szError;
-		switch ( hDIResult ) {
-			case DIERR_DEVICEFULL:     szError = "DIERR_DEVICEFULL"; break;
-			case DIERR_DEVICENOTREG:   szError = "DIERR_DEVICENOTREG"; break;
-			case DIERR_INVALIDPARAM:   szError = "DIERR_INVALIDPARAM"; break;
-			case DIERR_NOTINITIALIZED: szError = "DIERR_NOTINITIALIZED"; break;
-			case E_NOTIMPL:            szError = "E_NOTIMPL"; break;
-			default: szError = "(Unknown)";
-		}
-		CONTRL_ERROR( -11, "Failed to create force-feedback effect. (0x%X=%s)\n", hDIResult, szError );
-	}
-
-	/* Download effect - place the effect on the device */
-
-	// What a dumb name... Upload, Place, Set - any would have made more sense.
-	hDIResult = IDirectInputEffect_Download( pDIEffect );
-	if ( hDIResult != DI_OK ) {
-		CONTRL_ERROR( -12, "Failed to upload effect to controller device. (0x%X)\n", hDIResult );
-	}
-
-	/* Start the effect */
-
-	DWORD dwIterations = 1;
-	// DIES_SOLO - Stop all other effects
-	// DIES_NODOWNLOAD - Do not download automatically
-	DWORD dwFlags = 0;
-	hDIResult = IDirectInputEffect_Start( pDIEffect, dwIterations, dwFlags );
-	if ( hDIResult != DI_OK ) {
-		CONTRL_ERROR( -13, "Failed to start effect on controller device. (0x%x)\n", hDIResult );
-	}
-}
-
-int contrl_print_device_state_sony_dualshock4( char *buffer, size_t buffer_size, DIJOYSTATE *j ) {
+int contrl_print_device_state_sony_dualshock4( char *buffer, size_t buffer_size, const contrl_joystate *j ) {
 	// Don't judge...
-	BYTE bRect = j->rgbButtons[ 0 ];
-	BYTE bCross = j->rgbButtons[ 1 ];
-	BYTE bCircle = j->rgbButtons[ 2 ];
-	BYTE bTri = j->rgbButtons[ 3 ];
+	uint8_t bRect = j->rgbButtons[ 0 ];
+	uint8_t bCross = j->rgbButtons[ 1 ];
+	uint8_t bCircle = j->rgbButtons[ 2 ];
+	uint8_t bTri = j->rgbButtons[ 3 ];
 	const char *pszShapes[ 4 ] = {
 		( bRect )   ? u8"□" : "-",
 		( bCross )  ? u8"x" : "-",
@@ -307,11 +239,11 @@ int contrl_print_device_state_sony_dualshock4( char *buffer, size_t buffer_size,
 		"-",  // ArrowDown
 		"-"   // ArrowLeft
 	};
-	DWORD dwArrows = j->rgdwPOV[ 0 ];
-	DWORD dwDegrees = 0;
+	uint32_t dwArrows = j->rgdwPOV[ 0 ];
+	uint32_t dwDegrees = 0;
 	if ( dwArrows != 0xFFFFFFFF ) {
 		dwDegrees = dwArrows / 100;
-		DWORD dwDirection = ( dwArrows + 2250 ) / 4500;  // Round to nearest 45 degrees
+		uint32_t dwDirection = ( dwArrows + 2250 ) / 4500;  // Round to nearest 45 degrees
 		switch ( dwDirection % 8 ) {
 			case 1: pszArrows[ 1 ] = u8"→";  // Fall-through
 			case 0: pszArrows[ 0 ] = u8"↑"; break;
@@ -327,7 +259,7 @@ int contrl_print_device_state_sony_dualshock4( char *buffer, size_t buffer_size,
 		}
 	}
 
-	LONG lL2R2[ 2 ] = {
+	int32_t lL2R2[ 2 ] = {
 		// L2:
 		j->lRx,
 		// R2:
@@ -341,7 +273,7 @@ int contrl_print_device_state_sony_dualshock4( char *buffer, size_t buffer_size,
 		// R2:
 		lL2R2[ 1 ] * ( 1.0f / 65535.0f )
 	};
-	LONG lSticks[ 4 ] = {
+	int32_t lSticks[ 4 ] = {
 		// Left:
 		j->lX, j->lY,
 		// Right:
@@ -359,16 +291,16 @@ int contrl_print_device_state_sony_dualshock4( char *buffer, size_t buffer_size,
 	};
 	if ( fSticks[ 1 ] != 0 )  fSticks[ 1 ] *= -1.0f;  // Invert L stick Y axis without turning 0.0 into -0.0
 	if ( fSticks[ 3 ] != 0 )  fSticks[ 3 ] *= -1.0f;  // Invert R stick Y axis without turning 0.0 into -0.0
-	BYTE bL1 = j->rgbButtons[ 4 ];
-	BYTE bR1 = j->rgbButtons[ 5 ];
-	BYTE bL2 = j->rgbButtons[ 6 ];
-	BYTE bR2 = j->rgbButtons[ 7 ];
-	BYTE bSHARE = j->rgbButtons[ 8 ];
-	BYTE bOPTIONS = j->rgbButtons[ 9 ];
-	BYTE bLstick = j->rgbButtons[ 10 ];
-	BYTE bRstick = j->rgbButtons[ 11 ];
-	BYTE bPS = j->rgbButtons[ 12 ];
-	BYTE bTOUCH = j->rgbButtons[ 13 ];
+	uint8_t bL1 = j->rgbButtons[ 4 ];
+	uint8_t bR1 = j->rgbButtons[ 5 ];
+	uint8_t bL2 = j->rgbButtons[ 6 ];
+	uint8_t bR2 = j->rgbButtons[ 7 ];
+	uint8_t bSHARE = j->rgbButtons[ 8 ];
+	uint8_t bOPTIONS = j->rgbButtons[ 9 ];
+	uint8_t bLstick = j->rgbButtons[ 10 ];
+	uint8_t bRstick = j->rgbButtons[ 11 ];
+	uint8_t bPS = j->rgbButtons[ 12 ];
+	uint8_t bTOUCH = j->rgbButtons[ 13 ];
 	const char *pszSpecials[ 4 ] = {
 		( bSHARE )   ? "SHARE"   : "-",
 		( bOPTIONS ) ? "OPTIONS" : "-",
@@ -378,14 +310,14 @@ int contrl_print_device_state_sony_dualshock4( char *buffer, size_t buffer_size,
 	
 	int cursor = 0;
 	cursor += snprintf( buffer + cursor, buffer_size - cursor,
-		"Arrows: [%s, %s, %s, %s] (%3lu)\n"
+		"Arrows: [%s, %s, %s, %s] (%3u)\n"
 		"Shapes: [%s, %s, %s, %s]\n"
 		"Special: [%5s, %7s, %2s, %5s]\n"
 		"L1: [%3hhu] R1: [%3hhu]\n"
-		"L2: [%3hhu, %5ld] (%9.6f)\n"
-		"R2: [%3hhu, %5ld] (%9.6f)\n"
-		"L Stick: [%3hhu, %5ld,%5ld] (%9.6f,%9.6f)\n"
-		"R Stick: [%3hhu, %5ld,%5ld] (%9.6f,%9.6f)\n",
+		"L2: [%3hhu, %5d] (%9.6f)\n"
+		"R2: [%3hhu, %5d] (%9.6f)\n"
+		"L Stick: [%3hhu, %5d,%5d] (%9.6f,%9.6f)\n"
+		"R Stick: [%3hhu, %5d,%5d] (%9.6f,%9.6f)\n",
 		pszArrows[ 0 ], pszArrows[ 1 ], pszArrows[ 2 ], pszArrows[ 3 ], dwDegrees,
 		pszShapes[ 0 ], pszShapes[ 1 ], pszShapes[ 2 ], pszShapes[ 3 ],
 		pszSpecials[ 0 ], pszSpecials[ 1 ], pszSpecials[ 2 ], pszSpecials[ 3 ],
@@ -398,11 +330,11 @@ int contrl_print_device_state_sony_dualshock4( char *buffer, size_t buffer_size,
 	return cursor;
 }
 
-int contrl_print_device_state_logitech_g923( char *buffer, size_t buffer_size, DIJOYSTATE *j ) {
-	BYTE bCross = j->rgbButtons[ 0 ];
-	BYTE bRect = j->rgbButtons[ 1 ];
-	BYTE bCircle = j->rgbButtons[ 2 ];
-	BYTE bTri = j->rgbButtons[ 3 ];
+int contrl_print_device_state_logitech_g923( char *buffer, size_t buffer_size, const contrl_joystate *j ) {
+	uint8_t bCross = j->rgbButtons[ 0 ];
+	uint8_t bRect = j->rgbButtons[ 1 ];
+	uint8_t bCircle = j->rgbButtons[ 2 ];
+	uint8_t bTri = j->rgbButtons[ 3 ];
 	const char *pszShapes[ 4 ] = {
 		( bCross )  ? u8"x" : "-",
 		( bRect )   ? u8"□" : "-",
@@ -416,11 +348,11 @@ int contrl_print_device_state_logitech_g923( char *buffer, size_t buffer_size, D
 		"-",  // ArrowDown
 		"-"   // ArrowLeft
 	};
-	DWORD dwArrows = j->rgdwPOV[ 0 ];
-	DWORD dwDegrees = 0;
+	uint32_t dwArrows = j->rgdwPOV[ 0 ];
+	uint32_t dwDegrees = 0;
 	if ( dwArrows != 0xFFFFFFFF ) {
 		dwDegrees = dwArrows / 100;
-		DWORD dwDirection = ( dwArrows + 2250 ) / 4500;  // Round to nearest 45 degrees
+		uint32_t dwDirection = ( dwArrows + 2250 ) / 4500;  // Round to nearest 45 degrees
 		switch ( dwDirection % 8 ) {
 			case 1: pszArrows[ 1 ] = u8"→";  // Fall-through
 			case 0: pszArrows[ 0 ] = u8"↑"; break;
@@ -436,7 +368,7 @@ int contrl_print_device_state_logitech_g923( char *buffer, size_t buffer_size, D
 		}
 	}
 
-	LONG lAxes[ 4 ] = {
+	int32_t lAxes[ 4 ] = {
 		j->rglSlider[ 0 ],  // Clutch
 		j->lRz,  // Brake
 		j->lY,  // Throttle
@@ -458,20 +390,20 @@ int contrl_print_device_state_logitech_g923( char *buffer, size_t buffer_size, D
 		( lAxes[ 3 ] == 32767 ) ? lAxes[ 3 ] * ( 1.0f / 32767.0f ) - 1.0f : lAxes[ 3 ] * ( 1.0f / 32767.5f ) - 1.0f
 	};
 
-	BYTE bPaddleR = j->rgbButtons[ 4 ];
-	BYTE bPaddleL = j->rgbButtons[ 5 ];
-	BYTE bR2 = j->rgbButtons[ 6 ];
-	BYTE bL2 = j->rgbButtons[ 7 ];
-	BYTE bSHARE = j->rgbButtons[ 8 ];
-	BYTE bOPTIONS = j->rgbButtons[ 9 ];
-	BYTE bR3 = j->rgbButtons[ 10 ];
-	BYTE bL3 = j->rgbButtons[ 11 ];
-	BYTE bPlus = j->rgbButtons[ 19 ];
-	BYTE bMinus = j->rgbButtons[ 20 ];
-	BYTE bDialR = j->rgbButtons[ 21 ];
-	BYTE bDialL = j->rgbButtons[ 22 ];
-	BYTE bENTER = j->rgbButtons[ 23 ];
-	BYTE bPS = j->rgbButtons[ 24 ];
+	uint8_t bPaddleR = j->rgbButtons[ 4 ];
+	uint8_t bPaddleL = j->rgbButtons[ 5 ];
+	uint8_t bR2 = j->rgbButtons[ 6 ];
+	uint8_t bL2 = j->rgbButtons[ 7 ];
+	uint8_t bSHARE = j->rgbButtons[ 8 ];
+	uint8_t bOPTIONS = j->rgbButtons[ 9 ];
+	uint8_t bR3 = j->rgbButtons[ 10 ];
+	uint8_t bL3 = j->rgbButtons[ 11 ];
+	uint8_t bPlus = j->rgbButtons[ 19 ];
+	uint8_t bMinus = j->rgbButtons[ 20 ];
+	uint8_t bDialR = j->rgbButtons[ 21 ];
+	uint8_t bDialL = j->rgbButtons[ 22 ];
+	uint8_t bENTER = j->rgbButtons[ 23 ];
+	uint8_t bPS = j->rgbButtons[ 24 ];
 
 	const char *pszSpecials[ 4 ] = {
 		( bSHARE )   ? "SHARE"   : "-",
@@ -488,7 +420,7 @@ int contrl_print_device_state_logitech_g923( char *buffer, size_t buffer_size, D
 		"Throttle: [%5d] (%9.6f)\n"
 		"   Wheel: [%5d] (%9.6f)\n"
 		"PaddleL: [%3hhu] PaddleR: [%3hhu]\n"
-		"Arrows: [%s, %s, %s, %s] (%3lu)\n"
+		"Arrows: [%s, %s, %s, %s] (%3u)\n"
 		"Shapes: [%s, %s, %s, %s]\n"
 		"Special: [%5s, %7s, %5s, %2s]\n"
 		"L2: [%3hhu] R2: [%3hhu]\n"
@@ -511,112 +443,228 @@ int contrl_print_device_state_logitech_g923( char *buffer, size_t buffer_size, D
 	return cursor;
 }
 
-int main( int arguments_count, char *arguments[] ) {
-	HINSTANCE hInstance = GetModuleHandleA( NULL ); // Current program's handle
-	if ( hInstance == NULL ) {
-		CONTRL_ERROR( -1, "Failed to get current program's module handle. (hInstance=0x%X)\n", hInstance );
-	}
-	CONTRL_TRACE( "Got current program's module handle. (hInstance=0x%X)", *hInstance );
-
-	// Enable control escape codes to save/reset cursor position.
-	{
-		DWORD dwMode;
-		GetConsoleMode( hInstance, &dwMode );
-		dwMode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
-		SetConsoleMode( hInstance, dwMode );
-	}
-
-	/* Initialize DirectInput */
+#if defined( _WIN32 )
 
-	HRESULT hDIResult;
-	LPDIRECTINPUT8 pDirectInput = NULL;
-	hDIResult = DirectInput8Create(
-		/*     hInst */ hInstance,
-		/* dwVersion */ DIRECTINPUT_VERSION,
-		/*   riidltf */ &IID_IDirectInput8,
-		/*    ppvOut */ &pDirectInput,
-		/* punkOuter */ NULL );
-	if ( hDIResult != DI_OK ) {
-		CONTRL_ERROR( -2, "Failed to initialize DirectInput8. (0x%X)\n", hDIResult );
-	}
-	CONTRL_TRACE( "Initialized DirectInput8.", NULL );
+/* DirectInput8 backend */
 
-	/* Enumerate attached gamepad devices */
+#define GUID_PRODUCT_GET_PID( guidData1 )  ( guidData1 >> 16 )
+#define GUID_PRODUCT_GET_VID( guidData1 )  ( guidData1 & 0x0000FFFF )
 
-	DIDEVICEINSTANCE diDeviceInstance;
-	LPDIRECTINPUTDEVICE8 pControllerDevice = NULL;
-	DeviceGetFirstContext ctxDeviceFirst = {
-		.pDirectInput       = pDirectInput,        // In
-		.ppControllerDevice = &pControllerDevice,  // In-Out
-		.pDeviceInstance    = &diDeviceInstance    // In-Out
-	};
-enumDevices:
-	hDIResult = IDirectInput8_EnumDevices(
-		/*       this */ pDirectInput,
-		/*  dwDevType */ DI8DEVCLASS_GAMECTRL,
-		/* lpCallback */ contrl__device_get_first_callback,
-		/*      pvRef */ &ctxDeviceFirst,
-		/*    dwFlags */ DIEDFL_ATTACHEDONLY );
-	if ( hDIResult != DI_OK ) {
-		CONTRL_ERROR( -3, "Failed to enumerate attached devices. (0x%X)\n", hDIResult );
-	} else if ( pControllerDevice == NULL ) {
-		CONTRL_WARN( "No attached controllers found. Connect one and try again.\n", NULL );
-		system("pause");
-		goto enumDevices;
-	}
+// `contrl_joystate` is read straight into by `IDirectInputDevice8_GetDeviceState`.
+typedef char contrl__joystate_matches_dijoystate[ ( sizeof( contrl_joystate ) == sizeof( DIJOYSTATE ) ) ? 1 : -1 ];
 
-	/* Print device info */
+typedef struct contrl_dinput_device {
+	LPDIRECTINPUTDEVICE8 pControllerDevice;
+	DIDEVICEINSTANCE     diDeviceInstance;
+} contrl_dinput_device;
 
-#if CONTRL_DEBUG
-	contrl__debug_print_device_info( &diDeviceInstance );
-#endif
+static LPDIRECTINPUT8 contrl__dinput = NULL;
+static contrl_dinput_device contrl__dinput_device;
 
-	uint16_t deviceVID = GUID_PRODUCT_GET_VID( diDeviceInstance.guidProduct.Data1 );  // Vendor ID
-	uint16_t devicePID = GUID_PRODUCT_GET_PID( diDeviceInstance.guidProduct.Data1 );  // Product ID
-	const char *deviceVendor = "?";
-	const char *deviceProduct = "?";
-	PFN_PrintDeviceState print_device_state = contrl_print_device_state_generic;
-	if ( deviceVID == VID_SONY && devicePID == PID_SONY_DUALSHOCK4 ) {
-		deviceVendor = "Sony";
-		deviceProduct = "DualShock 4";
-		print_device_state = contrl_print_device_state_sony_dualshock4;
-	} else if ( deviceVID == VID_LOGITECH && devicePID == PID_LOGITECH_G923 ) {
-		deviceVendor = "Logitech";
-		deviceProduct = "G923 Racing Wheel";
-		print_device_state = contrl_print_device_state_logitech_g923;
-	}
+typedef struct DeviceGetFirstContext {
+	LPDIRECTINPUT8        pDirectInput;        // In parameter.  Pointer to the instance of DirectInput8.
+	LPDIRECTINPUTDEVICE8 *ppControllerDevice;  // In-Out parameter.  Pointer to a pointer to where created device pointer (LPDIRECTINPUTDEVICE8) will be stored.
+	DIDEVICEINSTANCE     *pDeviceInstance;     // In-Out parameter, can be NULL.  Pointer to where DIDEVICEINSTANCE will be stored.
+} DeviceGetFirstContext;
 
-	CONTRL_PRINT( "Found attached controller device. (\"%s\", VendorID: 0x%04X (%s), ProductID: 0x%04X (%s))\n",
-		diDeviceInstance.tszProductName, deviceVID, deviceVendor, devicePID, deviceProduct );
+static BOOL CALLBACK contrl__device_get_first_callback( const DIDEVICEINSTANCE *pInstance, DeviceGetFirstContext *pContext ) {
+	HRESULT hResult = IDirectInput8_CreateDevice(
+		/*                  this */ pContext->pDirectInput,
+		/*                 rguid */ &pInstance->guidInstance,
+		/* lplpDirectInputDevice */ pContext->ppControllerDevice,
+		/*             pUnkOuter */ NULL );
+	if ( hResult != DI_OK )  return DIENUM_CONTINUE;
+	if ( pContext->pDeviceInstance != NULL )  *pContext->pDeviceInstance = *pInstance;
+	return DIENUM_STOP;
+}
 
-	/* Get device capabilities */
+typedef struct DeviceEffectsSupportedContext {
+	int nEffects;  // Out parameter.  Set to 0 before call!  Number of effects supported by the force-feedback system.
+} DeviceEffectsSupportedContext;
 
-	DIDEVCAPS diDeviceCapabilities = { 0 };
-	diDeviceCapabilities.dwSize = sizeof( DIDEVCAPS );
-	hDIResult = IDirectInputDevice8_GetCapabilities(
-		/*        this */ pControllerDevice,
-		/* lpDIDevCaps */ &diDeviceCapabilities );
-	if ( hDIResult != DI_OK ) {
-		CONTRL_ERROR( -8, "Failed to get controller device capabilities. (0x%X)\n", hDIResult );
-	}
+static BOOL CALLBACK contrl__device_effects_supported_callback( const DIEFFECTINFO *pDIEffectInfo, DeviceEffectsSupportedContext *pContext ) {
+	pContext->nEffects += 1;
+	return DIENUM_CONTINUE;
+}
 
 #if CONTRL_DEBUG
-	contrl__debug_print_device_capabilities( &diDeviceCapabilities );
-#endif
+static void contrl__debug_print_device_info( const DIDEVICEINSTANCE *i ) {
+	const GUID *const gI = &i->guidInstance;
+	const GUID *const gP = &i->guidProduct;
+	const GUID *const gD = &i->guidFFDriver;
 
-	const DIDEVCAPS *const caps = &diDeviceCapabilities;
-	CONTRL_PRINT( "Device uses: %u axes, %u buttons, %u POVs.\n",
-		caps->dwAxes, caps->dwButtons, caps->dwPOVs );
-	bool ffb_supported = C_BOOL( caps->dwFlags & DIDC_FORCEFEEDBACK );
-	if ( ffb_supported ) {
-		CONTRL_PRINT( "Device supports Force-FeedBack. (Sample Period: %u, Min Time Resolution: %u)\n",
-			caps->dwFFSamplePeriod, caps->dwFFMinTimeResolution );
+	char data4Bytes[ 64 ] = { 0 };  // Only 51 bytes are used, but aligned to 64.
+	char *const gIData4 = data4Bytes;
+	char *const gPData4 = gIData4 + 17;  // 16 chars + 1 null-terminator
+	char *const gDData4 = gPData4 + 17;  // 16 chars + 1 null-terminator
+	for ( int i = 0; i < 8; i += 1 ) {
+		// Write 1 byte of each GUID simultaneously.
+		sprintf( &gIData4[ 2 * i ], "%02X", gI->Data4[ i ] );
+		sprintf( &gPData4[ 2 * i ], "%02X", gP->Data4[ i ] );
+		sprintf( &gDData4[ 2 * i ], "%02X", gD->Data4[ i ] );
 	}
 
+	CONTRL_TRACE2( "TRACE: ", 7,
+		"Device info:\n"
+		"  dwSize: %lu\n"
+		"  guidInstance: %08X-%04hX-%04hX-%s (\"%.*s\")\n"
+		"  guidProduct: %08X-%04hX-%04hX-%s (\"%.*s\")\n"
+		"  dwDevType: 0x%08X\n",
+		i->dwSize,
+		gI->Data1, gI->Data2, gI->Data3, gIData4, 6, &gI->Data4[ 2 ],
+		gP->Data1, gP->Data2, gP->Data3, gPData4, 6, &gP->Data4[ 2 ],
+		i->dwDevType );
+
+#if UNICODE
+	CONTRL_PRINT( 
+		"  tszInstanceName: \"%ls\"\n"
+		"  tszProductName: \"%ls\"\n",
+		i->tszInstanceName, i->tszProductName );
+#else
+	CONTRL_PRINT( 
+		"  tszInstanceName: \"%s\"\n"
+		"  tszProductName: \"%s\"\n",
+		i->tszInstanceName, i->tszProductName );
+#endif
+
+	CONTRL_PRINT(
+		"  guidFFDriver: %08X-%04hX-%04hX-%s\n"
+		"  wUsagePage: 0x%08X\n"
+		"  wUsage: 0x%08X\n",
+		gD->Data1, gD->Data2, gD->Data3, gDData4,
+		i->wUsagePage,
+		i->wUsage );
+
+	CONTRL_TRACE( "Vendor ID (VID): 0x%04X, Product ID (PID): 0x%04X",
+		GUID_PRODUCT_GET_VID( gP->Data1 ), GUID_PRODUCT_GET_PID( gP->Data1 ) );
+}
+
+static void contrl__debug_print_device_capabilities( const DIDEVCAPS *c ) {
+	CONTRL_TRACE( "Device capabilities:\n"
+		"  dwSize: %u\n"
+		"  dwFlags: 0x%08X\n"
+		"  dwDevType: 0x%08X (type=0x%02X, subtype=0x%02X)\n"
+		"  dwAxes: %u\n"
+		"  dwButtons: %u\n"
+		"  dwPOVs: %u\n"
+		"  dwFFSamplePeriod: %u\n"
+		"  dwFFMinTimeResolution: %u\n"
+		"  dwFirmwareRevision: 0x%08X\n"
+		"  dwHardwareRevision: 0x%08X\n"
+		"  dwFFDriverVersion: 0x%08X",
+		c->dwSize,
+		c->dwFlags,
+		c->dwDevType, GET_DIDEVICE_TYPE( c->dwDevType ), GET_DIDEVICE_SUBTYPE( c->dwDevType ),
+		c->dwAxes,
+		c->dwButtons,
+		c->dwPOVs,
+		c->dwFFSamplePeriod,
+		c->dwFFMinTimeResolution,
+		c->dwFirmwareRevision,
+		c->dwHardwareRevision,
+		c->dwFFDriverVersion );
+}
+#endif
+
+static void contrl_dinput_init( void ) {
+	HINSTANCE hInstance = GetModuleHandleA( NULL ); // Current program's handle
+	if ( hInstance == NULL ) {
+		CONTRL_ERROR( -1, "Failed to get current program's module handle. (hInstance=0x%X)\n", hInstance );
+	}
+	CONTRL_TRACE( "Got current program's module handle. (hInstance=0x%X)", *hInstance );
+
+	HRESULT hDIResult = DirectInput8Create(
+		/*     hInst */ hInstance,
+		/* dwVersion */ DIRECTINPUT_VERSION,
+		/*   riidltf */ &IID_IDirectInput8,
+		/*    ppvOut */ &contrl__dinput,
+		/* punkOuter */ NULL );
+	if ( hDIResult != DI_OK ) {
+		CONTRL_ERROR( -2, "Failed to initialize DirectInput8. (0x%X)\n", hDIResult );
+	}
+	CONTRL_TRACE( "Initialized DirectInput8." );
+}
+
+static bool contrl_dinput_open_first( contrl_device *device ) {
+	contrl_dinput_device *d = &contrl__dinput_device;
+	d->pControllerDevice = NULL;
+	DeviceGetFirstContext ctxDeviceFirst = {
+		.pDirectInput       = contrl__dinput,           // In
+		.ppControllerDevice = &d->pControllerDevice,  // In-Out
+		.pDeviceInstance    = &d->diDeviceInstance    // In-Out
+	};
+	HRESULT hDIResult = IDirectInput8_EnumDevices(
+		/*       this */ contrl__dinput,
+		/*  dwDevType */ DI8DEVCLASS_GAMECTRL,
+		/* lpCallback */ contrl__device_get_first_callback,
+		/*      pvRef */ &ctxDeviceFirst,
+		/*    dwFlags */ DIEDFL_ATTACHEDONLY );
+	if ( hDIResult != DI_OK ) {
+		CONTRL_ERROR( -3, "Failed to enumerate attached devices. (0x%X)\n", hDIResult );
+	}
+	if ( d->pControllerDevice == NULL )  return false;
+
+#if CONTRL_DEBUG
+	contrl__debug_print_device_info( &d->diDeviceInstance );
+#endif
+
+	device->data = d;
+	device->vid = GUID_PRODUCT_GET_VID( d->diDeviceInstance.guidProduct.Data1 );
+	device->pid = GUID_PRODUCT_GET_PID( d->diDeviceInstance.guidProduct.Data1 );
+#if UNICODE
+	WideCharToMultiByte( CP_UTF8, 0, d->diDeviceInstance.tszProductName, -1, device->name, sizeof( device->name ), NULL, NULL );
+#else
+	snprintf( device->name, sizeof( device->name ), "%s", d->diDeviceInstance.tszProductName );
+#endif
+	return true;
+}
+
+static void contrl_dinput_get_capabilities( contrl_device *device, contrl_caps *caps ) {
+	contrl_dinput_device *d = device->data;
+	DIDEVCAPS diDeviceCapabilities = { 0 };
+	diDeviceCapabilities.dwSize = sizeof( DIDEVCAPS );
+	HRESULT hDIResult = IDirectInputDevice8_GetCapabilities(
+		/*        this */ d->pControllerDevice,
+		/* lpDIDevCaps */ &diDeviceCapabilities );
+	if ( hDIResult != DI_OK ) {
+		CONTRL_ERROR( -8, "Failed to get controller device capabilities. (0x%X)\n", hDIResult );
+	}
+
+#if CONTRL_DEBUG
+	contrl__debug_print_device_capabilities( &diDeviceCapabilities );
+#endif
+
+	/* Enumerate device effects */
+
+	DeviceEffectsSupportedContext ctxEffectsSupported = {
+		.nEffects = 0  // Out counter
+	};
+	hDIResult = IDirectInputDevice8_EnumEffects(
+		/*       this */ d->pControllerDevice,
+		/* lpCallback */ contrl__device_effects_supported_callback,
+		/*      pvRef */ &ctxEffectsSupported,
+		/*  dwEffType */ DIEFT_ALL );
+	if ( hDIResult != DI_OK ) {
+		CONTRL_ERROR( -10, "Failed to enumerate controller device effects. (0x%X)\n", hDIResult );
+	}
+
+	const DIDEVCAPS *const c = &diDeviceCapabilities;
+	caps->axes = c->dwAxes;
+	caps->buttons = c->dwButtons;
+	caps->povs = c->dwPOVs;
+	caps->ff = C_BOOL( c->dwFlags & DIDC_FORCEFEEDBACK );
+	caps->ff_effects = ( uint32_t )ctxEffectsSupported.nEffects;
+	caps->ff_sample_period = c->dwFFSamplePeriod;
+	caps->ff_min_time_resolution = c->dwFFMinTimeResolution;
+}
+
+static void contrl_dinput_acquire( contrl_device *device ) {
+	contrl_dinput_device *d = device->data;
+
 	/* Set Joystick data format */
 
-	hDIResult = IDirectInputDevice8_SetDataFormat(
-		/* this */ pControllerDevice,
+	HRESULT hDIResult = IDirectInputDevice8_SetDataFormat(
+		/* this */ d->pControllerDevice,
 		/* lpdf */ &c_dfDIJoystick );
 	if ( hDIResult != DI_OK ) {
 		CONTRL_ERROR( -4, "Failed to set controller device data format to '%s' (0x%X).\n", "c_dfDIJoystick", hDIResult );
@@ -628,13 +676,13 @@ enumDevices:
 		CONTRL_ERROR( -5, "Failed to get console window. (hWindow=0x%X)\n", hWindow );
 	}
 	CONTRL_TRACE( "Got console window. (hWindow=0x%X)", hWindow );
-	
+
 	/* Set cooperative level */
 
 	// Use of `DISCL_EXCLUSIVE | DISCL_FOREGROUND` results in permission denial.
 	// It works with `DISCL_NONEXCLUSIVE | DISCL_BACKGROUND` just fine.
 	hDIResult = IDirectInputDevice8_SetCooperativeLevel(
-		/*    this */ pControllerDevice,
+		/*    this */ d->pControllerDevice,
 		/*    hwnd */ hWindow,
 		/* dwFlags */ DISCL_NONEXCLUSIVE | DISCL_BACKGROUND );
 	if ( hDIResult != DI_OK ) {
@@ -645,20 +693,583 @@ enumDevices:
 	/* Acquire device */
 
 	hDIResult = IDirectInputDevice8_Acquire(
-		/* this */ pControllerDevice );
+		/* this */ d->pControllerDevice );
 	if ( hDIResult != DI_OK ) {
 		CONTRL_ERROR( -7, "Failed to acquire controller device. (0x%X)\n", hDIResult );
 	}
-	CONTRL_TRACE( "Acquired controller device.", NULL );
+	CONTRL_TRACE( "Acquired controller device." );
+}
 
-	int pollRate = 60;  // 60Hz = 60 times per second
-	float pollTimeIntervalMs = 1000.0f / pollRate;
-	DWORD dwPollTimeIntervalMs = ( DWORD )pollTimeIntervalMs;  // at 60Hz, 1000 / 60 = 16.666f = 16
+static long contrl_dinput_read_state( contrl_device *device, contrl_joystate *state ) {
+	contrl_dinput_device *d = device->data;
+	HRESULT hResult = IDirectInputDevice8_GetDeviceState(
+		/*    this */ d->pControllerDevice,
+		/*  cbData */ sizeof( DIJOYSTATE ),
+		/* lpvData */ state );
+	return ( hResult == DI_OK ) ? 0 : ( long )hResult;
+}
+
+static void contrl_dinput_play_force( contrl_device *device, int32_t magnitude, uint32_t duration_us ) {
+	contrl_dinput_device *d = device->data;
+
+	// Force along X axis, to the right for positive `magnitude`.
+	DWORD rgdwAxes[ 1 ] = { DIJOFS_X };
+	LONG rglDirection[ 1 ] = { 0 };
+
+	DIEFFECT effect = { 0 };
+	effect.dwSize = sizeof( DIEFFECT );
+	effect.dwFlags = DIEFF_CARTESIAN | DIEFF_OBJECTOFFSETS;
+	effect.dwDuration = duration_us;  // In Us - microseconds
+	effect.dwSamplePeriod = 0;  // Default
+	effect.dwGain = DI_FFNOMINALMAX;
+	effect.dwTriggerButton = DIEB_NOTRIGGER;
+	effect.cAxes = 1;
+	effect.rgdwAxes = rgdwAxes;
+	effect.rglDirection = rglDirection;
+
+	// In range of: [-10_000, 10_000]
+	DICONSTANTFORCE cForce = { .lMagnitude = magnitude };
+
+	effect.cbTypeSpecificParams = sizeof( DICONSTANTFORCE );
+	effect.lpvTypeSpecificParams = &cForce;
+
+	/* Create Force-feedback effect */
+
+	LPDIRECTINPUTEFFECT pDIEffect = NULL;
+	HRESULT hDIResult = IDirectInputDevice8_CreateEffect(
+		/*      this */ d->pControllerDevice,
+		/*      guid */ &GUID_ConstantForce,
+		/*     lpeff */ &effect,  // Passed effect setup parameters
+		/*    ppdeff */ &pDIEffect,  // Returned DirectInput effect object
+		/* pUnkOuter */ NULL );
+	if ( hDIResult != DI_OK ) {
+		const char *szError;
+		switch ( hDIResult ) {
+			case DIERR_DEVICEFULL:     szError = "DIERR_DEVICEFULL"; break;
+			case DIERR_DEVICENOTREG:   szError = "DIERR_DEVICENOTREG"; break;
+			case DIERR_INVALIDPARAM:   szError = "DIERR_INVALIDPARAM"; break;
+			case DIERR_NOTINITIALIZED: szError = "DIERR_NOTINITIALIZED"; break;
+			case E_NOTIMPL:            szError = "E_NOTIMPL"; break;
+			default: szError = "(Unknown)";
+		}
+		CONTRL_ERROR( -11, "Failed to create force-feedback effect. (0x%X=%s)\n", hDIResult, szError );
+	}
+
+	/* Download effect - place the effect on the device */
+
+	// What a dumb name... Upload, Place, Set - any would have made more sense.
+	hDIResult = IDirectInputEffect_Download( pDIEffect );
+	if ( hDIResult != DI_OK ) {
+		CONTRL_ERROR( -12, "Failed to upload effect to controller device. (0x%X)\n", hDIResult );
+	}
+
+	/* Start the effect */
+
+	DWORD dwIterations = 1;
+	// DIES_SOLO - Stop all other effects
+	// DIES_NODOWNLOAD - Do not download automatically
+	DWORD dwFlags = 0;
+	hDIResult = IDirectInputEffect_Start( pDIEffect, dwIterations, dwFlags );
+	if ( hDIResult != DI_OK ) {
+		CONTRL_ERROR( -13, "Failed to start effect on controller device. (0x%x)\n", hDIResult );
+	}
+}
+
+static void contrl_dinput_close( contrl_device *device ) {
+	contrl_dinput_device *d = device->data;
+	IDirectInputDevice8_Release(
+		/* this */ d->pControllerDevice );
+	IDirectInput8_Release(
+		/* this */ contrl__dinput );
+}
+
+static const contrl_backend contrl_backend_dinput = {
+	.name             = "DirectInput8",
+	.init             = contrl_dinput_init,
+	.open_first       = contrl_dinput_open_first,
+	.get_capabilities = contrl_dinput_get_capabilities,
+	.acquire          = contrl_dinput_acquire,
+	.read_state       = contrl_dinput_read_state,
+	.play_force       = contrl_dinput_play_force,
+	.close            = contrl_dinput_close
+};
 
+#define CONTRL_BACKEND_DEFAULT contrl_backend_dinput
+
+static void contrl_console_init( void ) {
+	// Enable control escape codes to save/reset cursor position.
 	HANDLE hConsoleOutput = GetStdHandle( STD_OUTPUT_HANDLE );
+	DWORD dwMode;
+	GetConsoleMode( hConsoleOutput, &dwMode );
+	dwMode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
+	SetConsoleMode( hConsoleOutput, dwMode );
+}
+
+static void contrl_sleep_ms( uint32_t milliseconds ) {
+	Sleep( milliseconds );
+}
+
+static void contrl_pause( void ) {
+	logger_flush();
+	system("pause");
+}
+
+#elif defined( __linux__ )
+
+/* evdev backend */
+
+// `/dev/input/event0` .. `event63` are tried, first controller among them is used.
+#define CONTRL_EVDEV_DEVICES_MAX 64
+
+// Input events read at once.
+#define CONTRL_EVDEV_EVENTS_MAX 64
+
+#define CONTRL_EVDEV_NONE -1
+
+#define CONTRL_BIT_TEST( bits, bit )  C_BOOL( ( bits )[ ( bit ) / 8 ] & ( 1 << ( ( bit ) % 8 ) ) )
+
+typedef struct contrl_evdev_code {
+	uint16_t code;
+	uint8_t  index;  // `contrl_axis`, or index into `rgbButtons`.
+} contrl_evdev_code;
+
+// Where a driver maps a device differently from its HID report order (which DirectInput follows),
+//   codes are placed where DirectInput would report them, so device-specific printers read the same fields.
+typedef struct contrl_evdev_layout {
+	uint16_t                 vid;
+	uint16_t                 pid;
+	const contrl_evdev_code *axes;
+	int                      axes_count;
+	const contrl_evdev_code *buttons;
+	int                      buttons_count;
+} contrl_evdev_layout;
+
+// `hid-playstation` (and `hid-sony` before it) report sticks as X/Y and RX/RY, triggers as Z/RZ, gamepad buttons.
+static const contrl_evdev_code contrl_evdev_dualshock4_axes[] = {
+	{ ABS_X,  CONTRL_AXIS_X },   // Left stick
+	{ ABS_Y,  CONTRL_AXIS_Y },
+	{ ABS_RX, CONTRL_AXIS_Z },   // Right stick
+	{ ABS_RY, CONTRL_AXIS_RZ },
+	{ ABS_Z,  CONTRL_AXIS_RX },  // L2
+	{ ABS_RZ, CONTRL_AXIS_RY }   // R2
+};
+static const contrl_evdev_code contrl_evdev_dualshock4_buttons[] = {
+	{ BTN_WEST,    0 },  // Square
+	{ BTN_SOUTH,   1 },  // Cross
+	{ BTN_EAST,    2 },  // Circle
+	{ BTN_NORTH,   3 },  // Triangle
+	{ BTN_TL,      4 },  // L1
+	{ BTN_TR,      5 },  // R1
+	{ BTN_TL2,     6 },  // L2
+	{ BTN_TR2,     7 },  // R2
+	{ BTN_SELECT,  8 },  // SHARE
+	{ BTN_START,   9 },  // OPTIONS
+	{ BTN_THUMBL, 10 },  // L3
+	{ BTN_THUMBR, 11 },  // R3
+	{ BTN_MODE,   12 }   // PS.  Touchpad click is on the separate touchpad device.
+};
+
+static const contrl_evdev_layout contrl_evdev_layouts[] = {
+	{ VID_SONY, PID_SONY_DUALSHOCK4,
+		contrl_evdev_dualshock4_axes, sizeof( contrl_evdev_dualshock4_axes ) / sizeof( contrl_evdev_code ),
+		contrl_evdev_dualshock4_buttons, sizeof( contrl_evdev_dualshock4_buttons ) / sizeof( contrl_evdev_code ) }
+};
+
+typedef struct contrl_evdev_device {
+	int                  fd;
+	bool                 writable;                // Opened for writing, needed to play effects.
+	bool                 dropped;                 // Kernel dropped events, state is read again on next `SYN_REPORT`.
+	int8_t               axes[ ABS_CNT ];         // `contrl_axis` of every absolute axis code, or `CONTRL_EVDEV_NONE`.
+	int8_t               buttons[ KEY_CNT ];      // Index into `rgbButtons` of every key code, or `CONTRL_EVDEV_NONE`.
+	struct input_absinfo ranges[ ABS_CNT ];       // Of mapped axes.
+	int8_t               hats[ 4 ][ 2 ];          // X and Y of `ABS_HAT0X` .. `ABS_HAT3Y`:  -1, 0 or 1.
+	uint8_t              abs_bits[ ( ABS_CNT + 7 ) / 8 ];
+	uint8_t              key_bits[ ( KEY_CNT + 7 ) / 8 ];
+	uint8_t              ff_bits[ ( FF_CNT + 7 ) / 8 ];
+	contrl_joystate      state;
+} contrl_evdev_device;
+
+static int contrl__evdev_epoll = -1;
+static contrl_evdev_device contrl__evdev_device;
+
+// Joystick and gamepad buttons, in code order:  the order generic HID devices report their buttons in.
+static bool contrl_evdev_is_button( int code ) {
+	return ( code >= BTN_MISC && code < BTN_MOUSE )
+		|| ( code >= BTN_JOYSTICK && code < BTN_DIGI )
+		|| ( code >= BTN_TRIGGER_HAPPY && code < KEY_CNT );
+}
+
+// Controllers have joystick or gamepad buttons, unlike keyboards, mice, touchpads and motion sensors.
+static bool contrl_evdev_is_controller( const uint8_t *key_bits ) {
+	for ( int code = BTN_JOYSTICK; code < KEY_CNT; code += 1 ) {
+		if ( code == BTN_DIGI )  code = BTN_TRIGGER_HAPPY;
+		if ( CONTRL_BIT_TEST( key_bits, code ) )  return true;
+	}
+	return false;
+}
+
+// Scales `value` of an axis with `range` to `CONTRL_AXIS_MAX` range, rounding to nearest.
+// Minimum, center and maximum land where DirectInput puts them:  0, `CONTRL_AXIS_CENTER` and `CONTRL_AXIS_MAX`,
+//   so a stick at rest reads the same on both backends.  Halves below and above center are scaled separately.
+static int32_t contrl_evdev_scale( const struct input_absinfo *range, int32_t value ) {
+	if ( range->maximum <= range->minimum )  return 0;
+	if ( value <= range->minimum )  return 0;
+	if ( value >= range->maximum )  return CONTRL_AXIS_MAX;  // Also of two-value axes, their center is the maximum.
+	// Value of a stick at rest:  0 of [-32768; 32767], 128 of [0; 255].
+	int64_t center = range->minimum + ( ( int64_t )range->maximum - range->minimum + 1 ) / 2;
+	if ( value <= center ) {
+		int64_t span = center - range->minimum;
+		return ( int32_t )( ( 2 * ( value - range->minimum ) * ( int64_t )CONTRL_AXIS_CENTER + span ) / ( 2 * span ) );
+	}
+	int64_t span = range->maximum - center;
+	return CONTRL_AXIS_CENTER
+		+ ( int32_t )( ( 2 * ( value - center ) * ( int64_t )( CONTRL_AXIS_MAX - CONTRL_AXIS_CENTER ) + span ) / ( 2 * span ) );
+}
+
+#if CONTRL_DEBUG
+// Checks `contrl_evdev_scale` at both ends and center of ranges sticks, triggers and wheels report.
+static void contrl_evdev_check_scale( void ) {
+	static const struct input_absinfo ranges[] = {
+		{ .minimum = -32768, .maximum = 32767 },
+		{ .minimum = -32767, .maximum = 32767 },
+		{ .minimum = 0,      .maximum = 255 },
+		{ .minimum = 0,      .maximum = 65535 },
+		{ .minimum = -1,     .maximum = 1 },
+		{ .minimum = 0,      .maximum = 1 }
+	};
+	for ( size_t i = 0; i < sizeof( ranges ) / sizeof( ranges[ 0 ] ); i += 1 ) {
+		const struct input_absinfo *range = &ranges[ i ];
+		int32_t center = range->minimum + ( range->maximum - range->minimum + 1 ) / 2;
+		int32_t scaled[ 3 ] = {
+			contrl_evdev_scale( range, range->minimum ),
+			contrl_evdev_scale( range, center ),
+			contrl_evdev_scale( range, range->maximum )
+		};
+		int32_t scaled_center = ( center == range->maximum ) ? CONTRL_AXIS_MAX : CONTRL_AXIS_CENTER;
+		if ( scaled[ 0 ] != 0 || scaled[ 1 ] != scaled_center || scaled[ 2 ] != CONTRL_AXIS_MAX ) {
+			CONTRL_ERROR( -15, "Axis range [%d; %d] scales to %d, %d, %d at minimum, center and maximum.\n",
+				range->minimum, range->maximum, scaled[ 0 ], scaled[ 1 ], scaled[ 2 ] );
+		}
+	}
+	CONTRL_TRACE( "Checked axis scaling." );
+}
+#endif
+
+// Hundredths of degrees clockwise from north of a hat, or `CONTRL_POV_CENTERED`.
+static uint32_t contrl_evdev_pov( int x, int y ) {
+	static const uint32_t degrees[ 3 ][ 3 ] = {
+		// x:  -1     0      1
+		{ 31500,     0,  4500 },                 // y: -1  (up)
+		{ 27000, CONTRL_POV_CENTERED,  9000 },   // y:  0
+		{ 22500, 18000, 13500 }                  // y:  1  (down)
+	};
+	return degrees[ y + 1 ][ x + 1 ];
+}
+
+static void contrl_evdev_apply( contrl_evdev_device *d, int type, int code, int32_t value ) {
+	if ( type == EV_ABS && code >= ABS_HAT0X && code <= ABS_HAT3Y ) {
+		int hat = ( code - ABS_HAT0X ) / 2;
+		d->hats[ hat ][ ( code - ABS_HAT0X ) % 2 ] = ( int8_t )( ( value > 0 ) - ( value < 0 ) );
+		d->state.rgdwPOV[ hat ] = contrl_evdev_pov( d->hats[ hat ][ 0 ], d->hats[ hat ][ 1 ] );
+	} else if ( type == EV_ABS && code < ABS_CNT && d->axes[ code ] != CONTRL_EVDEV_NONE ) {
+		int32_t *axis = ( int32_t * )( ( char * )&d->state + contrl_axis_offsets[ d->axes[ code ] ] );
+		*axis = contrl_evdev_scale( &d->ranges[ code ], value );
+	} else if ( type == EV_KEY && code < KEY_CNT && d->buttons[ code ] != CONTRL_EVDEV_NONE ) {
+		d->state.rgbButtons[ d->buttons[ code ] ] = ( value != 0 ) ? 0x80 : 0;  // 2 is auto-repeat, still pressed.
+	}
+}
+
+// Reads whole state from the device, after opening it and after the kernel dropped events.
+static void contrl_evdev_sync( contrl_evdev_device *d ) {
+	for ( int code = 0; code < ABS_CNT; code += 1 ) {
+		if ( !CONTRL_BIT_TEST( d->abs_bits, code ) )  continue;
+		struct input_absinfo info;
+		if ( ioctl( d->fd, EVIOCGABS( code ), &info ) == 0 )  contrl_evdev_apply( d, EV_ABS, code, info.value );
+	}
+	uint8_t pressed[ ( KEY_CNT + 7 ) / 8 ] = { 0 };
+	ioctl( d->fd, EVIOCGKEY( sizeof( pressed ) ), pressed );
+	for ( int code = 0; code < KEY_CNT; code += 1 ) {
+		if ( d->buttons[ code ] != CONTRL_EVDEV_NONE )  contrl_evdev_apply( d, EV_KEY, code, CONTRL_BIT_TEST( pressed, code ) );
+	}
+}
+
+// Maps axis and button codes the device has onto `contrl_joystate`.
+static void contrl_evdev_map( contrl_evdev_device *d, uint16_t vid, uint16_t pid ) {
+	memset( d->axes, CONTRL_EVDEV_NONE, sizeof( d->axes ) );
+	memset( d->buttons, CONTRL_EVDEV_NONE, sizeof( d->buttons ) );
+
+	const contrl_evdev_layout *layout = NULL;
+	for ( size_t i = 0; i < sizeof( contrl_evdev_layouts ) / sizeof( contrl_evdev_layout ); i += 1 ) {
+		if ( contrl_evdev_layouts[ i ].vid == vid && contrl_evdev_layouts[ i ].pid == pid )  layout = &contrl_evdev_layouts[ i ];
+	}
+
+	if ( layout != NULL ) {
+		for ( int i = 0; i < layout->axes_count; i += 1 ) {
+			if ( CONTRL_BIT_TEST( d->abs_bits, layout->axes[ i ].code ) )  d->axes[ layout->axes[ i ].code ] = layout->axes[ i ].index;
+		}
+		for ( int i = 0; i < layout->buttons_count; i += 1 ) {
+			if ( CONTRL_BIT_TEST( d->key_bits, layout->buttons[ i ].code ) )  d->buttons[ layout->buttons[ i ].code ] = layout->buttons[ i ].index;
+		}
+	} else {
+		// HID usages X, Y, Z, Rx, Ry, Rz, Slider and Dial become these codes, DirectInput puts them in the same fields.
+		static const int codes[ CONTRL_AXES_COUNT ] = { ABS_X, ABS_Y, ABS_Z, ABS_RX, ABS_RY, ABS_RZ, ABS_THROTTLE, ABS_RUDDER };
+		for ( int axis = 0; axis < CONTRL_AXES_COUNT; axis += 1 ) {
+			if ( CONTRL_BIT_TEST( d->abs_bits, codes[ axis ] ) )  d->axes[ codes[ axis ] ] = ( int8_t )axis;
+		}
+		int8_t button = 0;
+		for ( int code = 0; code < KEY_CNT && button < 32; code += 1 ) {
+			if ( contrl_evdev_is_button( code ) && CONTRL_BIT_TEST( d->key_bits, code ) )  d->buttons[ code ] = button++;
+		}
+	}
+
+	for ( int code = 0; code < ABS_CNT; code += 1 ) {
+		if ( d->axes[ code ] == CONTRL_EVDEV_NONE )  continue;
+		ioctl( d->fd, EVIOCGABS( code ), &d->ranges[ code ] );
+		CONTRL_TRACE( "Axis 0x%02X -> %d, range [%d; %d].", code, d->axes[ code ], d->ranges[ code ].minimum, d->ranges[ code ].maximum );
+	}
+}
+
+static void contrl_evdev_init( void ) {
+	contrl__evdev_epoll = epoll_create1( EPOLL_CLOEXEC );
+	if ( contrl__evdev_epoll < 0 ) {
+		CONTRL_ERROR( -2, "Failed to create epoll instance. (errno=%d)\n", errno );
+	}
+	CONTRL_TRACE( "Created epoll instance." );
+
+#if CONTRL_DEBUG
+	contrl_evdev_check_scale();
+#endif
+}
+
+static bool contrl_evdev_open_first( contrl_device *device ) {
+	contrl_evdev_device *d = &contrl__evdev_device;
+	int denied = 0;
+	for ( int i = 0; i < CONTRL_EVDEV_DEVICES_MAX; i += 1 ) {
+		char path[ 32 ];
+		snprintf( path, sizeof( path ), "/dev/input/event%d", i );
+		memset( d, 0, sizeof( *d ) );
+		d->writable = true;
+		d->fd = open( path, O_RDWR | O_NONBLOCK | O_CLOEXEC );
+		if ( d->fd < 0 && ( errno == EACCES || errno == EPERM ) ) {
+			d->writable = false;
+			d->fd = open( path, O_RDONLY | O_NONBLOCK | O_CLOEXEC );
+		}
+		if ( d->fd < 0 ) {
+			if ( errno == EACCES || errno == EPERM )  denied += 1;
+			continue;
+		}
+
+		ioctl( d->fd, EVIOCGBIT( EV_KEY, sizeof( d->key_bits ) ), d->key_bits );
+		if ( !contrl_evdev_is_controller( d->key_bits ) ) {
+			close( d->fd );
+			continue;
+		}
+		ioctl( d->fd, EVIOCGBIT( EV_ABS, sizeof( d->abs_bits ) ), d->abs_bits );
+		ioctl( d->fd, EVIOCGBIT( EV_FF, sizeof( d->ff_bits ) ), d->ff_bits );
+
+		struct input_id id = { 0 };
+		ioctl( d->fd, EVIOCGID, &id );
+		// Longer names are cut without a terminator.
+		if ( ioctl( d->fd, EVIOCGNAME( sizeof( device->name ) - 1 ), device->name ) < 0 ) {
+			snprintf( device->name, sizeof( device->name ), "?" );
+		}
+		device->name[ sizeof( device->name ) - 1 ] = '\0';
+		device->vid = id.vendor;
+		device->pid = id.product;
+		device->data = d;
+		CONTRL_TRACE( "Opened '%s'%s. (bus: 0x%04X, version: 0x%04X)", path, d->writable ? "" : " read-only", id.bustype, id.version );
+
+		contrl_evdev_map( d, id.vendor, id.product );
+		for ( int pov = 0; pov < 4; pov += 1 )  d->state.rgdwPOV[ pov ] = CONTRL_POV_CENTERED;
+		return true;
+	}
+
+	if ( denied > 0 ) {
+		CONTRL_WARN( "Not allowed to open %d input devices, is the user in the 'input' group?\n", denied );
+	}
+	return false;
+}
+
+static void contrl_evdev_get_capabilities( contrl_device *device, contrl_caps *caps ) {
+	contrl_evdev_device *d = device->data;
+	memset( caps, 0, sizeof( *caps ) );
+	for ( int code = 0; code < ABS_CNT; code += 1 )  caps->axes += ( d->axes[ code ] != CONTRL_EVDEV_NONE );
+	for ( int code = 0; code < KEY_CNT; code += 1 )  caps->buttons += ( d->buttons[ code ] != CONTRL_EVDEV_NONE );
+	for ( int hat = 0; hat < 4; hat += 1 )  caps->povs += CONTRL_BIT_TEST( d->abs_bits, ABS_HAT0X + 2 * hat );
+	caps->ff = d->writable && ( CONTRL_BIT_TEST( d->ff_bits, FF_RUMBLE ) || CONTRL_BIT_TEST( d->ff_bits, FF_CONSTANT ) );
+	int effects = 0;
+	if ( caps->ff && ioctl( d->fd, EVIOCGEFFECTS, &effects ) == 0 )  caps->ff_effects = ( uint32_t )effects;
+}
+
+static void contrl_evdev_acquire( contrl_device *device ) {
+	contrl_evdev_device *d = device->data;
+	struct epoll_event event = { .events = EPOLLIN, .data.ptr = d };
+	if ( epoll_ctl( contrl__evdev_epoll, EPOLL_CTL_ADD, d->fd, &event ) != 0 ) {
+		CONTRL_ERROR( -7, "Failed to acquire controller device. (errno=%d)\n", errno );
+	}
+	contrl_evdev_sync( d );
+	CONTRL_TRACE( "Acquired controller device." );
+}
+
+static long contrl_evdev_read_state( contrl_device *device, contrl_joystate *state ) {
+	contrl_evdev_device *d = device->data;
+	struct epoll_event ready;
+	int count = epoll_wait( contrl__evdev_epoll, &ready, 1, 0 );
+	if ( count < 0 && errno != EINTR )  return errno;
+
+	while ( count > 0 ) {
+		struct input_event events[ CONTRL_EVDEV_EVENTS_MAX ];
+		ssize_t bytes = read( d->fd, events, sizeof( events ) );
+		if ( bytes < 0 && errno == EINTR )  continue;
+		if ( bytes < 0 && errno == EAGAIN )  break;
+		if ( bytes < 0 )  return errno;  // ENODEV once unplugged.
+
+		for ( size_t i = 0; i < ( size_t )bytes / sizeof( struct input_event ); i += 1 ) {
+			const struct input_event *e = &events[ i ];
+			if ( e->type == EV_SYN && e->code == SYN_DROPPED ) {
+				d->dropped = true;
+			} else if ( e->type == EV_SYN && e->code == SYN_REPORT && d->dropped ) {
+				d->dropped = false;
+				contrl_evdev_sync( d );
+			} else if ( !d->dropped ) {
+				contrl_evdev_apply( d, e->type, e->code, e->value );
+			}
+		}
+		if ( ( size_t )bytes < sizeof( events ) )  break;
+	}
+
+	*state = d->state;
+	return 0;
+}
+
+static void contrl_evdev_play_force( contrl_device *device, int32_t magnitude, uint32_t duration_us ) {
+	contrl_evdev_device *d = device->data;
+	if ( magnitude > CONTRL_FORCE_MAX )   magnitude = CONTRL_FORCE_MAX;
+	if ( magnitude < -CONTRL_FORCE_MAX )  magnitude = -CONTRL_FORCE_MAX;
+
+	struct ff_effect effect = { .id = -1, .replay.length = ( uint16_t )( duration_us / 1000 ) };
+	if ( CONTRL_BIT_TEST( d->ff_bits, FF_RUMBLE ) ) {
+		// Gamepads only rumble:  no direction, both motors at `magnitude`.
+		uint16_t strength = ( uint16_t )( ( magnitude < 0 ? -magnitude : magnitude ) * 0xFFFF / CONTRL_FORCE_MAX );
+		effect.type = FF_RUMBLE;
+		effect.u.rumble.strong_magnitude = strength;
+		effect.u.rumble.weak_magnitude = strength;
+	} else {
+		effect.type = FF_CONSTANT;
+		effect.direction = 0xC000;  // Along X axis, to the right for positive `magnitude`.
+		effect.u.constant.level = ( int16_t )( magnitude * 0x7FFF / CONTRL_FORCE_MAX );
+	}
+	if ( ioctl( d->fd, EVIOCSFF, &effect ) < 0 ) {
+		CONTRL_ERROR( -11, "Failed to create force-feedback effect. (errno=%d)\n", errno );
+	}
+
+	struct input_event play = { .type = EV_FF, .code = ( uint16_t )effect.id, .value = 1 /* Times to play */ };
+	if ( write( d->fd, &play, sizeof( play ) ) != sizeof( play ) ) {
+		CONTRL_ERROR( -13, "Failed to start effect on controller device. (errno=%d)\n", errno );
+	}
+}
+
+static void contrl_evdev_close( contrl_device *device ) {
+	contrl_evdev_device *d = device->data;
+	close( d->fd );
+	close( contrl__evdev_epoll );
+}
+
+static const contrl_backend contrl_backend_evdev = {
+	.name             = "evdev",
+	.init             = contrl_evdev_init,
+	.open_first       = contrl_evdev_open_first,
+	.get_capabilities = contrl_evdev_get_capabilities,
+	.acquire          = contrl_evdev_acquire,
+	.read_state       = contrl_evdev_read_state,
+	.play_force       = contrl_evdev_play_force,
+	.close            = contrl_evdev_close
+};
+
+#define CONTRL_BACKEND_DEFAULT contrl_backend_evdev
+
+static void contrl_console_init( void ) {
+	// Terminals take escape codes as they are.
+}
+
+static void contrl_sleep_ms( uint32_t milliseconds ) {
+	struct timespec duration = { .tv_sec = milliseconds / 1000, .tv_nsec = ( long )( milliseconds % 1000 ) * 1000000 };
+	while ( nanosleep( &duration, &duration ) != 0 && errno == EINTR ) {}
+}
+
+static void contrl_pause( void ) {
+	CONTRL_PRINT( "Press Enter to continue . . .\n" );
+	logger_flush();
+	if ( getchar() == EOF ) {
+		CONTRL_ERROR( -14, "No controller attached and nothing to wait on, stdin is closed.\n" );
+	}
+}
+
+#endif /* _WIN32 */
+
+int main( int arguments_count, char *arguments[] ) {
+	bool test_haptics = false;
+	for ( int i = 1; i < arguments_count; i += 1 ) {
+		if ( strcmp( arguments[ i ], "--haptics" ) == 0 )  test_haptics = true;
+		else  CONTRL_WARN( "Unknown option '%s', ignoring it.\n", arguments[ i ] );
+	}
+
+	contrl_console_init();
+
+	const contrl_backend *backend = &CONTRL_BACKEND_DEFAULT;
+	CONTRL_TRACE( "Using %s backend.", backend->name );
+	backend->init();
+
+	/* Enumerate attached gamepad devices */
+
+	contrl_device device = { .backend = backend };
+	while ( !backend->open_first( &device ) ) {
+		CONTRL_WARN( "No attached controllers found. Connect one and try again.\n" );
+		contrl_pause();
+	}
+
+	/* Print device info */
+
+	const char *deviceVendor = "?";
+	const char *deviceProduct = "?";
+	PFN_PrintDeviceState print_device_state = contrl_print_device_state_generic;
+	if ( device.vid == VID_SONY && device.pid == PID_SONY_DUALSHOCK4 ) {
+		deviceVendor = "Sony";
+		deviceProduct = "DualShock 4";
+		print_device_state = contrl_print_device_state_sony_dualshock4;
+	} else if ( device.vid == VID_LOGITECH && device.pid == PID_LOGITECH_G923 ) {
+		deviceVendor = "Logitech";
+		deviceProduct = "G923 Racing Wheel";
+		print_device_state = contrl_print_device_state_logitech_g923;
+	}
+
+	CONTRL_PRINT( "Found attached controller device. (\"%s\", VendorID: 0x%04X (%s), ProductID: 0x%04X (%s))\n",
+		device.name, device.vid, deviceVendor, device.pid, deviceProduct );
+
+	/* Get device capabilities */
+
+	contrl_caps caps;
+	backend->get_capabilities( &device, &caps );
+	CONTRL_PRINT( "Device uses: %u axes, %u buttons, %u POVs.\n",
+		caps.axes, caps.buttons, caps.povs );
+	if ( caps.ff ) {
+		CONTRL_PRINT( "Device supports Force-FeedBack. (Effects: %u, Sample Period: %u, Min Time Resolution: %u)\n",
+			caps.ff_effects, caps.ff_sample_period, caps.ff_min_time_resolution );
+	}
+
+	backend->acquire( &device );
+
+	if ( test_haptics ) {
+		if ( caps.ff )  backend->play_force( &device, CONTRL_FORCE_MAX / 2, 500 * 1000 );
+		else            CONTRL_WARN( "Device does not support Force-FeedBack, ignoring '--haptics'.\n" );
+	}
+
+	int pollRate = 60;  // 60Hz = 60 times per second
+	float pollTimeIntervalMs = 1000.0f / pollRate;
+	uint32_t dwPollTimeIntervalMs = ( uint32_t )pollTimeIntervalMs;  // at 60Hz, 1000 / 60 = 16.666f = 16
 
 	// Save cursor position to then overwrite previous output.
-	WriteConsoleA( hConsoleOutput, CONSOLE_SC, CONSOLE_SC_LEN, NULL, NULL );
+	CONTRL_PRINT( CONSOLE_SC );
 
 	// Allocate string buffer on heap.
 #define BUFFER_SIZE 4096
@@ -667,57 +1278,37 @@ enumDevices:
 		CONTRL_ERROR( -9, "Failed to allocate %d bytes of memory for string buffer.\n", BUFFER_SIZE );
 	}
 
-	/* Enumerate device effects */
-
-	DeviceEffectsSupportedContext ctxEffectsSupported = {
-		.nEffects = 0  // Out counter
-	};
-	hDIResult = IDirectInputDevice8_EnumEffects(
-		/*       this */ pControllerDevice,
-		/* lpCallback */ contrl__device_effects_supported_callback,
-		/*      pvRef */ &ctxEffectsSupported,
-		/*  dwEffType */ DIEFT_ALL );
-	if ( hDIResult != DI_OK ) {
-		CONTRL_ERROR( -10, "Failed to enumerate controller device effects. (0x%X)\n", hDIResult );
-	}
-
-	/* Pick device state print function specific to the device, or generic otherwise */
-
-	DIJOYSTATE js;
-	HRESULT hResult;
+	contrl_joystate js;
+	long status;
 	// Infinite loop.
 	// To terminate process, press `CTRL+C` on focused command line window,
 	//   or close it with the window close button [X].
 	while ( 1 ) {
 		// Sleeping just poll time interval doesn't get us to exact poll rate
-		//   because of Sleep() imprecision, context switches, and more importantly
-		//   the unaccounted time of formatting and printing the recorded data output.
+		//   because of Sleep() imprecision, context switches, and the unaccounted time
+		//   of formatting the recorded data output (logger's thread prints it).
 		// But it is fine, this is just a toy terminal app!
-		Sleep( dwPollTimeIntervalMs );
+		contrl_sleep_ms( dwPollTimeIntervalMs );
 
 		// Restore cursor position before overwriting output.
-		WriteConsoleA( hConsoleOutput, CONSOLE_RC, CONSOLE_RC_LEN, NULL, NULL );
+		CONTRL_PRINT( CONSOLE_RC );
 
 		/* Read Joystick state */
 
-		hResult = IDirectInputDevice8_GetDeviceState(
-			/*    this */ pControllerDevice, 
-			/*  cbData */ sizeof( DIJOYSTATE ),
-			/* lpvData */ &js );
-		if ( hResult != DI_OK ) {
-			CONTRL_WARN( "Failed to get controller device state. (0x%X)\n", hResult );
+		status = backend->read_state( &device, &js );
+		if ( status != 0 ) {
+			CONTRL_WARN( "Failed to get controller device state. (0x%lX)\n", status );
 			continue;
 		}
 
 		// Overwrite output with new data.
 		int written = print_device_state( buffer, BUFFER_SIZE, &js );
-		WriteConsoleA( hConsoleOutput, buffer, written, NULL, NULL );
+		CONTRL_PRINT( "%.*s", written, buffer );
 	}
 
 	// The program actually never gets to this point.
 	// We are just being good guys.
-	IDirectInputDevice8_Release(
-		/* this */ pControllerDevice );
+	backend->close( &device );
 	CONTRL_FREE( buffer );
 
 	return 0;
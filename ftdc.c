@@ -1,117 +1,1097 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <stdint.h>
-#include <stdarg.h>
-
-// How many decimal digits a 64-bit (2 ^ 64) integer (`uint64_t`) can hold.
-#define INT64_MAX_DIGITS 20
-
-#ifndef FTDC_CUSTOM_BOOL
-enum bool_e {
-	false = 0,
-	true
-};
-typedef uint8_t bool;
-#endif
+#define FTDC_IMPLEMENTATION
+#include "ftdc.h"
 
-#define FTDC_ALLOC( count, type ) \
-	malloc( count * sizeof( type ) )
-#define FTDC_REALLOC( pointer, old_size, new_size, type ) \
-	realloc( pointer, new_size * sizeof( type ) )
-#define FTDC_FREE( pointer ) \
-	free( pointer )
+#include <errno.h>
+#include <stddef.h>
 
-#ifndef FTDC_DEBUG
-	#define FTDC_DEBUG 0
+#if defined( _WIN32 )
+	#include <io.h>
+#else
+	#include <fcntl.h>
+	#include <signal.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
 #endif
 
-#if FTDC_DEBUG
-	#define FTDC_TRACE( format, ... ) \
-		ftdc_fprintf( stdout, "TRACE: ", 7, format, __VA_ARGS__ ); \
-		putc( '\n', stdout )
-#else
-	#define FTDC_TRACE( format, ... )  
-#endif /* FTDC_DEBUG */
+#if defined( __linux__ )
+	#include <sys/epoll.h>
+#endif
 
 #define FTDC_ERROR( exit_code, format, ... ) \
-	ftdc_fprintf( stderr, "ERROR: ", 7, format, __VA_ARGS__ ); \
+	LOGGER_ERROR( stderr, "ERROR: ", 7, format, ##__VA_ARGS__ ); \
 	exit( exit_code )
 
 #define FTDC_WARN( format, ... ) \
-	ftdc_fprintf( stdout, "WARNING: ", 9, format, __VA_ARGS__ )
+	LOGGER_WARN( stdout, "WARNING: ", 9, format, ##__VA_ARGS__ )
 
 #define FTDC_PRINT( format, ... ) \
-	ftdc_fprintf( stdout, NULL, 0, format, __VA_ARGS__ )
+	LOGGER_INFO( stdout, NULL, 0, format, ##__VA_ARGS__ )
+
+// Size of streaming output buffer.  Memory use of `--stream` does not depend on precision.
+#define FTDC_STREAM_BUFFER_SIZE ( 1 << 20 )
 
-void ftdc_fprintf( FILE *stream, const char *prefix, size_t prefix_size, const char *format, ... ) {
-	fwrite( prefix, sizeof( char ), prefix_size, stream );
-	va_list args;
-	va_start( args, format );
-	vfprintf( stream, format, args );
-	va_end( args );
+// Fixed-size output buffer, flushed to a file descriptor with large `write` calls as it fills up.
+typedef struct ftdc_writer {
+	int          fd;
+	char        *buffer;
+	size_t       size;
+	size_t       used;
+	ftdc_stats  *stats;  // Output time and bytes written are added to it, if not NULL.
+} ftdc_writer;
+
+// Writes out everything buffered so far.
+void ftdc_writer_flush( ftdc_writer *writer ) {
+	uint64_t phase_start = ( writer->stats != NULL ) ? ftdc_ticks() : 0;
+	size_t flushed = 0;
+	while ( flushed < writer->used ) {
+#if defined( _WIN32 )
+		int written = _write( writer->fd, writer->buffer + flushed, ( unsigned int )( writer->used - flushed ) );
+#else
+		ssize_t written = write( writer->fd, writer->buffer + flushed, writer->used - flushed );
+#endif
+		if ( written < 0 ) {
+			FTDC_ERROR( -12, "Could not write %zu bytes of output.\n", writer->used - flushed );
+		}
+		flushed += written;
+	}
+	writer->used = 0;
+	if ( writer->stats != NULL )  writer->stats->bytes_written += flushed;
+	ftdc_stats_phase( writer->stats, FTDC_PHASE_OUTPUT, &phase_start );
 }
 
-// Appends any char.  Returns chars written.
-// Chainable:  `cursor = append( buffer, size, cursor, '.' );`
-int ftdc_append_char( char *buffer, size_t buffer_size, int cursor, char append ) {
-	buffer[ cursor ] = append;
-	return 1;
+// Returns pointer to at least `size` (<= buffer size) free bytes, flushing the buffer if needed.
+// Advance `writer->used` by the amount actually written there.
+char *ftdc_writer_reserve( ftdc_writer *writer, size_t size ) {
+	if ( writer->size - writer->used < size )  ftdc_writer_flush( writer );
+	return writer->buffer + writer->used;
 }
 
-// Appends digit in the range of [0; 9].  Returns chars written.
-// Chainable:  `cursor += append_digit( buffer, size, cursor, 1 );`
-int ftdc_append_digit( char *buffer, size_t buffer_size, int cursor, char digit ) {
-	if ( digit < 0 || digit > 9 ) {
-		FTDC_WARN( "`append_digit`: Trying to append digit (%d) outside of expected 0-9 range!"
-			" If you meant to append non-digit char, use `append_char`.\n", digit );
-		return 0;
+void ftdc_writer_put( ftdc_writer *writer, const char *data, size_t size ) {
+	while ( size > 0 ) {
+		if ( writer->used == writer->size )  ftdc_writer_flush( writer );
+		size_t space = writer->size - writer->used;
+		size_t part = ( size < space ) ? size : space;
+		memcpy( writer->buffer + writer->used, data, part );
+		writer->used += part;
+		data += part;
+		size -= part;
 	}
+}
+
+// Streams up to `count` fractional digits of `numerator / denominator` in `base`, starting from `position`,
+//   computing them straight into the writer's buffer, one buffer-full at a time.
+// Returns digits written.
+uint64_t ftdc_writer_put_fraction( ftdc_writer *writer, uint64_t count, uint64_t numerator, uint64_t denominator,
+	uint64_t position, int base, int threads_count )
+{
+	uint64_t written = 0;
+	while ( written < count ) {
+		char *out = ftdc_writer_reserve( writer, FTDC_CHUNK_DIGITS );
+		uint64_t space = writer->size - writer->used;
+		space -= space % FTDC_CHUNK_DIGITS;  // Whole chunks, so buffer boundaries don't split them.
+		uint64_t step = ( count - written < space ) ? count - written : space;
 
-	int written = ftdc_append_char( buffer, buffer_size, cursor, '0' + digit );  // Quick conversion to ASCII digit number char.
+		ftdc_stats *timed = ftdc_stats_timed( writer->stats );
+		uint64_t phase_start = ( timed != NULL ) ? ftdc_ticks() : 0;
+		uint64_t step_written = ftdc_compute_fraction_base( out, step, numerator, denominator,
+			position + written, base, threads_count, writer->stats );
+		ftdc_stats_phase( timed, FTDC_PHASE_FRACTION, &phase_start );
+		writer->used += step_written;
+		written += step_written;
+		if ( step_written < step )  break;  // Fraction has ended.
+	}
 	return written;
 }
 
-// Appends `uint64_t` value number.  Returns chars written.
-// Chainable:  `cursor += ftdc_append_uint64( buffer, size, cursor, number, 0 );`
-int ftdc_append_uint64( char *buffer, size_t buffer_size, int cursor, uint64_t number, uint64_t magnitude ) {
-	int old_cursor = cursor;
-	if ( magnitude <= 1 ) {
-		// Compute magnitude ourselves.
-		magnitude = 1;  // In case if 0 is passed
-		uint64_t num = number;
-		while ( num >= 10 ) {
-			num /= 10;
-			magnitude *= 10;
+// Writes decimal notation of `integer + numerator / denominator`:  3.14  or  0.08(3)  or  3.[1000]857...
+// Up to `digits_max` fractional digits from `offset`.  If `period` is not NULL, it must fit into `digits_max`,
+//   and repeating part is enclosed in parentheses.  Digits are in `base`, if it is not 10 (or 0).
+void ftdc_writer_put_decimal( ftdc_writer *writer, uint64_t integer, uint64_t numerator, uint64_t denominator,
+	uint64_t digits_max, uint64_t offset, const ftdc_period *period, int base, int threads_count )
+{
+	char *out = ftdc_writer_reserve( writer, 64 );
+	writer->used += ( base == 0 || base == 10 )
+		? ftdc_append_uint64( out, INT64_MAX_DIGITS, 0, integer, 0 )
+		: ftdc_append_uint64_base( out, 64, 0, integer, base );
+	if ( numerator == 0 ) {
+		if ( writer->stats != NULL )  writer->stats->conversions += 1;
+		return;
+	}
+
+	ftdc_writer_put( writer, ".", 1 );
+	if ( offset > 1 ) {
+		// '[', offset, ']' and the '\0' `snprintf` ends with.
+		out = ftdc_writer_reserve( writer, 2 + INT64_MAX_DIGITS + 1 );
+		writer->used += snprintf( out, 2 + INT64_MAX_DIGITS + 1, "[%llu]", ( unsigned long long )offset );
+	}
+	if ( period != NULL && period->period > 0 ) {
+		ftdc_writer_put_fraction( writer, period->pre_period, numerator, denominator, 1, base, threads_count );
+		ftdc_writer_put( writer, "(", 1 );
+		ftdc_writer_put_fraction( writer, period->period, numerator, denominator, 1 + period->pre_period, base, threads_count );
+		ftdc_writer_put( writer, ")", 1 );
+	} else {
+		ftdc_writer_put_fraction( writer, digits_max, numerator, denominator, offset, base, threads_count );
+	}
+	if ( writer->stats != NULL )  writer->stats->conversions += 1;
+}
+
+// Output file mapped into memory, digits are computed straight into the page cache.
+typedef struct ftdc_mapping {
+	char   *data;
+	size_t  size;
+#if defined( _WIN32 )
+	HANDLE  file;
+	HANDLE  mapping;
+#else
+	int     fd;
+#endif
+} ftdc_mapping;
+
+// Creates (or truncates) file at `path`, sizes it to exactly `size` bytes and maps it for writing.
+// With `existing`, maps file left by an earlier run instead, which must already be `size` bytes.
+void ftdc_mapping_create( ftdc_mapping *mapping, const char *path, size_t size, bool existing ) {
+	mapping->size = size;
+#if defined( _WIN32 )
+	mapping->file = CreateFileA( path, GENERIC_READ | GENERIC_WRITE, 0, NULL, existing ? OPEN_EXISTING : CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+	if ( mapping->file == INVALID_HANDLE_VALUE ) {
+		FTDC_ERROR( -14, "Could not %s output file '%s'.\n", existing ? "open" : "create", path );
+	}
+	LARGE_INTEGER existing_size;
+	if ( existing && ( !GetFileSizeEx( mapping->file, &existing_size ) || ( uint64_t )existing_size.QuadPart != size ) ) {
+		FTDC_ERROR( -18, "Output file '%s' is not %zu bytes, it is not the one the checkpoint was taken of.\n", path, size );
+	}
+	// Mapping a file of given size extends it, no separate `SetEndOfFile` needed.
+	mapping->mapping = CreateFileMappingA( mapping->file, NULL, PAGE_READWRITE,
+		( DWORD )( ( uint64_t )size >> 32 ), ( DWORD )size, NULL );
+	mapping->data = ( mapping->mapping == NULL ) ? NULL
+		: MapViewOfFile( mapping->mapping, FILE_MAP_WRITE, 0, 0, size );
+	if ( mapping->data == NULL ) {
+		FTDC_ERROR( -14, "Could not map %zu bytes of output file '%s'.\n", size, path );
+	}
+#else
+	mapping->fd = open( path, existing ? O_RDWR : ( O_RDWR | O_CREAT | O_TRUNC ), 0644 );
+	if ( mapping->fd < 0 ) {
+		FTDC_ERROR( -14, "Could not %s output file '%s'.\n", existing ? "open" : "create", path );
+	}
+	struct stat status;
+	if ( existing ) {
+		if ( fstat( mapping->fd, &status ) != 0 || ( uint64_t )status.st_size != size ) {
+			FTDC_ERROR( -18, "Output file '%s' is not %zu bytes, it is not the one the checkpoint was taken of.\n", path, size );
+		}
+	} else {
+		// Reserve blocks up front, so running out of disk space is an error here rather than SIGBUS
+		//   in the middle of writing.  Not every file system supports it, `ftruncate` still sets the size.
+		int error = posix_fallocate( mapping->fd, 0, ( off_t )size );
+		if ( error != 0 && error != EOPNOTSUPP && error != EINVAL ) {
+			FTDC_ERROR( -14, "Could not allocate %zu bytes for output file '%s'.\n", size, path );
+		}
+		if ( ftruncate( mapping->fd, ( off_t )size ) != 0 ) {
+			FTDC_ERROR( -14, "Could not resize output file '%s' to %zu bytes.\n", path, size );
+		}
+	}
+	mapping->data = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, mapping->fd, 0 );
+	if ( mapping->data == MAP_FAILED ) {
+		FTDC_ERROR( -14, "Could not map %zu bytes of output file '%s'.\n", size, path );
+	}
+	// Written front to back once:  read ahead and drop behind.
+	madvise( mapping->data, size, MADV_SEQUENTIAL );
+#endif
+}
+
+// Writes bytes `[from; to)` of the mapping back to the file, and waits until they are on disk.
+void ftdc_mapping_flush( ftdc_mapping *mapping, size_t from, size_t to ) {
+	if ( from >= to )  return;
+#if defined( _WIN32 )
+	if ( !FlushViewOfFile( mapping->data + from, to - from ) || !FlushFileBuffers( mapping->file ) ) {
+		FTDC_ERROR( -12, "Could not write %zu bytes of output.\n", to - from );
+	}
+#else
+	size_t page_size = ( size_t )sysconf( _SC_PAGESIZE );
+	size_t start = from - from % page_size;  // `msync` takes page-aligned address.
+	if ( msync( mapping->data + start, to - start, MS_SYNC ) != 0 ) {
+		FTDC_ERROR( -12, "Could not write %zu bytes of output.\n", to - from );
+	}
+#endif
+}
+
+// Unmaps and closes the file.  Its contents are written back by the OS.
+void ftdc_mapping_close( ftdc_mapping *mapping ) {
+#if defined( _WIN32 )
+	UnmapViewOfFile( mapping->data );
+	CloseHandle( mapping->mapping );
+	CloseHandle( mapping->file );
+#else
+	munmap( mapping->data, mapping->size );
+	close( mapping->fd );
+#endif
+	mapping->data = NULL;
+}
+
+// Checkpointed long runs:  `--output` digits are computed a segment at a time, and after every segment
+//   the output is flushed to disk and the whole state of long division is saved next to it.
+#define FTDC_CHECKPOINT_MAGIC "FTDCCKP1"
+
+// Default `--checkpoint-every`, in fractional digits:  a few seconds of work.
+#define FTDC_CHECKPOINT_EVERY_DEFAULT 1000000000llu
+
+// Everything needed to continue a run, and to check it is continued with the same fraction, options and output.
+typedef struct ftdc_checkpoint {
+	char     magic[ 8 ];        // `FTDC_CHECKPOINT_MAGIC`, also the format version.
+	uint64_t numerator;         // Simplified fraction.
+	uint64_t denominator;
+	uint64_t precision;
+	uint64_t offset;
+	uint64_t repeating;
+	uint64_t length;            // Output file size.
+	uint64_t digits_done;       // Fractional digits written to the output file and flushed.
+	uint64_t remainder;         // Long-division remainder to compute the next digit from.
+	uint64_t output_checksum;   // Of the output file up to the first digit not done.
+	uint64_t checksum;          // Of the fields above.
+} ftdc_checkpoint;
+
+// Checksum over 8-byte words, eight times faster than byte at a time, to keep up with digits on resume.
+static uint64_t ftdc_checksum_words( uint64_t hash, const char *data, uint64_t words ) {
+	for ( uint64_t i = 0; i < words; i += 1 ) {
+		uint64_t word;
+		memcpy( &word, data + i * 8, 8 );
+		hash = ( hash ^ word ) * 0x9E3779B97F4A7C15llu;
+		hash ^= hash >> 32;
+	}
+	return hash;
+}
+
+// Finishes checksum of words with the last `size` (< 8) bytes, and the total length.
+static uint64_t ftdc_checksum_finish( uint64_t hash, const char *tail, size_t size, uint64_t length ) {
+	char word[ 8 ] = { 0 };
+	memcpy( word, tail, size );
+	hash = ftdc_checksum_words( hash, word, 1 );
+	return ftdc_checksum_words( hash, ( const char * )&length, 1 );
+}
+
+static uint64_t ftdc_checkpoint_checksum( const ftdc_checkpoint *checkpoint ) {
+	return ftdc_checksum_words( 0, ( const char * )checkpoint, offsetof( ftdc_checkpoint, checksum ) / 8 );
+}
+
+// Saves `checkpoint` at `path` atomically:  into a temporary file, flushed to disk and renamed over the old one,
+//   so a run killed at any point leaves either the previous checkpoint or this one.
+static void ftdc_checkpoint_write( const char *path, ftdc_checkpoint *checkpoint ) {
+	checkpoint->checksum = ftdc_checkpoint_checksum( checkpoint );
+	char temporary_path[ 4096 ];
+	if ( snprintf( temporary_path, sizeof( temporary_path ), "%s.tmp", path ) >= ( int )sizeof( temporary_path ) ) {
+		FTDC_ERROR( -17, "Checkpoint path '%s' is too long.\n", path );
+	}
+
+	FILE *file = fopen( temporary_path, "wb" );
+	bool written = ( file != NULL ) && fwrite( checkpoint, sizeof( *checkpoint ), 1, file ) == 1 && fflush( file ) == 0;
+#if defined( _WIN32 )
+	written = written && _commit( _fileno( file ) ) == 0;
+	if ( file != NULL )  fclose( file );
+	written = written && MoveFileExA( temporary_path, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH );
+#else
+	written = written && fsync( fileno( file ) ) == 0;
+	if ( file != NULL )  fclose( file );
+	written = written && rename( temporary_path, path ) == 0;
+	if ( written ) {
+		// Rename itself is only durable once the directory is flushed.
+		char directory[ 4096 ];
+		const char *slash = strrchr( path, '/' );
+		snprintf( directory, sizeof( directory ), "%.*s", ( slash != NULL ) ? ( int )( slash - path + 1 ) : 1,
+			( slash != NULL ) ? path : "." );
+		int fd = open( directory, O_RDONLY );
+		if ( fd >= 0 ) {
+			fsync( fd );
+			close( fd );
+		}
+	}
+#endif
+	if ( !written ) {
+		FTDC_ERROR( -17, "Could not write checkpoint '%s'.\n", path );
+	}
+}
+
+// Loads checkpoint from `path`, checking it is one and is intact.
+static void ftdc_checkpoint_read( const char *path, ftdc_checkpoint *checkpoint ) {
+	FILE *file = fopen( path, "rb" );
+	if ( file == NULL ) {
+		FTDC_ERROR( -18, "Could not open checkpoint '%s'.\n", path );
+	}
+	bool read = fread( checkpoint, sizeof( *checkpoint ), 1, file ) == 1;
+	fclose( file );
+	if ( !read || memcmp( checkpoint->magic, FTDC_CHECKPOINT_MAGIC, 8 ) != 0
+		|| checkpoint->checksum != ftdc_checkpoint_checksum( checkpoint ) )
+	{
+		FTDC_ERROR( -18, "File '%s' is not a valid checkpoint.\n", path );
+	}
+}
+
+// Converts into `output_path` file, same as plain `--output`, but in segments of `every` digits,
+//   saving a checkpoint at `checkpoint_path` after each.  `result` is the measured conversion.
+// With `resume_path`, continues from the checkpoint there, after checking the output file is intact up to it.
+void ftdc_run_checkpointed( const ftdc_options *options, const ftdc_result *result, const char *output_path,
+	const char *checkpoint_path, uint64_t every, const char *resume_path )
+{
+	// Layout:  integer  '.'  [ '[' offset ']' ]  pre-period digits  [ '(' ]  digits  [ ')' ]  '\n'
+	uint64_t offset = ( options->offset > 1 ) ? options->offset : 1;
+	char prefix[ 2 * INT64_MAX_DIGITS + 4 ];
+	size_t prefix_length = ftdc_append_uint64( prefix, sizeof( prefix ), 0, result->integer, 0 );
+	if ( result->fraction_numerator != 0 )  prefix[ prefix_length++ ] = '.';
+	if ( result->fraction_numerator != 0 && offset > 1 ) {
+		prefix_length += snprintf( prefix + prefix_length, sizeof( prefix ) - prefix_length, "[%llu]",
+			( unsigned long long )offset );
+	}
+	bool parentheses = result->repeating && result->period.period > 0;
+	uint64_t digits = result->length - prefix_length - ( parentheses ? 2 : 0 );
+	uint64_t pre_period = parentheses ? result->period.pre_period : digits;
+	#define FTDC_DIGIT_AT( k )  ( prefix_length + ( k ) + ( ( parentheses && ( k ) >= pre_period ) ? 1 : 0 ) )
+
+	ftdc_checkpoint checkpoint = {
+		.numerator = result->numerator, .denominator = result->denominator,
+		.precision = options->precision, .offset = offset, .repeating = options->repeating,
+		.length = result->length + 1 /* '\n' */
+	};
+	memcpy( checkpoint.magic, FTDC_CHECKPOINT_MAGIC, 8 );
+
+	ftdc_mapping mapping;
+	uint64_t hash = 0;
+	uint64_t hashed = 0;  // Output bytes in `hash`, whole words only.
+	if ( resume_path != NULL ) {
+		ftdc_checkpoint saved;
+		ftdc_checkpoint_read( resume_path, &saved );
+		if ( saved.numerator != checkpoint.numerator || saved.denominator != checkpoint.denominator
+			|| saved.precision != checkpoint.precision || saved.offset != checkpoint.offset
+			|| saved.repeating != checkpoint.repeating || saved.length != checkpoint.length || saved.digits_done > digits )
+		{
+			FTDC_ERROR( -18, "Checkpoint '%s' was taken of %llu / %llu with other options, run the same command to resume.\n",
+				resume_path, ( unsigned long long )saved.numerator, ( unsigned long long )saved.denominator );
+		}
+		if ( saved.remainder != ftdc_seek_remainder( result->fraction_numerator, result->denominator, offset + saved.digits_done ) ) {
+			FTDC_ERROR( -18, "Checkpoint '%s' is inconsistent with its fraction.\n", resume_path );
+		}
+
+		ftdc_mapping_create( &mapping, output_path, checkpoint.length, true );
+		uint64_t done_bytes = FTDC_DIGIT_AT( saved.digits_done );
+		hashed = done_bytes - done_bytes % 8;
+		hash = ftdc_checksum_words( 0, mapping.data, hashed / 8 );
+		if ( ftdc_checksum_finish( hash, mapping.data + hashed, done_bytes - hashed, done_bytes ) != saved.output_checksum ) {
+			FTDC_ERROR( -18, "Output file '%s' does not match checkpoint '%s', it changed after the checkpoint was taken.\n",
+				output_path, resume_path );
+		}
+		checkpoint.digits_done = saved.digits_done;
+		FTDC_PRINT( "Resuming from fractional digit %llu of %llu.\n", ( unsigned long long )saved.digits_done,
+			( unsigned long long )digits );
+	} else {
+		ftdc_mapping_create( &mapping, output_path, checkpoint.length, false );
+	}
+
+	// Everything but digits is (re)written up front.
+	memcpy( mapping.data, prefix, prefix_length );
+	if ( parentheses ) {
+		mapping.data[ prefix_length + pre_period ] = '(';
+		mapping.data[ result->length - 1 ] = ')';
+	}
+	mapping.data[ result->length ] = '\n';
+
+	uint64_t done = checkpoint.digits_done;
+	uint64_t flushed = 0;  // Output bytes on disk, everything before the first segment is flushed with it.
+	while ( true ) {
+		uint64_t end = ( digits - done < every ) ? digits : done + every;
+		ftdc_stats *timed = options->stats;
+		uint64_t phase_start = ( timed != NULL ) ? ftdc_ticks() : 0;
+		while ( done < end ) {
+			uint64_t part_end = ( done < pre_period && end > pre_period ) ? pre_period : end;  // Not across '('.
+			ftdc_compute_fraction_counted( mapping.data + FTDC_DIGIT_AT( done ), part_end - done,
+				result->fraction_numerator, result->denominator, offset + done, options->threads_count, options->stats );
+			done = part_end;
+		}
+		ftdc_stats_phase( timed, FTDC_PHASE_FRACTION, &phase_start );
+
+		// Output first, then the checkpoint that vouches for it.
+		uint64_t done_bytes = FTDC_DIGIT_AT( done );
+		uint64_t flush_end = ( done == digits ) ? checkpoint.length : done_bytes;
+		ftdc_mapping_flush( &mapping, flushed, flush_end );
+		flushed = flush_end;
+		hash = ftdc_checksum_words( hash, mapping.data + hashed, ( done_bytes - hashed ) / 8 );
+		hashed = done_bytes - done_bytes % 8;
+		checkpoint.digits_done = done;
+		checkpoint.remainder = ftdc_seek_remainder( result->fraction_numerator, result->denominator, offset + done );
+		checkpoint.output_checksum = ftdc_checksum_finish( hash, mapping.data + hashed, done_bytes - hashed, done_bytes );
+		ftdc_checkpoint_write( checkpoint_path, &checkpoint );
+		ftdc_stats_phase( timed, FTDC_PHASE_OUTPUT, &phase_start );
+		if ( done == digits )  break;
+	}
+	#undef FTDC_DIGIT_AT
+
+	ftdc_mapping_close( &mapping );
+	if ( options->stats != NULL ) {
+		options->stats->conversions += 1;
+		options->stats->bytes_written += checkpoint.length;
+	}
+}
+
+// Prints where each of comma-separated `patterns` first appears in the fractional digits of the fraction.
+// Searches up to `options->precision` digits from `options->offset`, or until the answer is known.
+void ftdc_run_find( uint64_t numerator, uint64_t denominator, char *patterns, const ftdc_options *options ) {
+	const char *list[ FTDC_FIND_PATTERNS_MAX ];
+	int count = 0;
+	for ( char *pattern = strtok( patterns, "," ); pattern != NULL; pattern = strtok( NULL, "," ) ) {
+		if ( count == FTDC_FIND_PATTERNS_MAX ) {
+			FTDC_ERROR( -1, "Option '--find' takes at most %d patterns.\n", FTDC_FIND_PATTERNS_MAX );
+		}
+		list[ count++ ] = pattern;
+	}
+
+	ftdc_find_result result;
+	ftdc_status status = ftdc_find( numerator, denominator, list, count, options, &result );
+	if ( status == FTDC_ERR_OUT_OF_MEMORY ) {
+		FTDC_ERROR( -9, "Could not allocate memory to search for patterns.\n" );
+	} else if ( status != FTDC_OK ) {
+		FTDC_ERROR( -1, "Patterns of option '--find' must be 1 to %d decimal digits each, separated by ','.\n",
+			FTDC_FIND_PATTERN_DIGITS_MAX );
+	}
+
+	uint64_t offset = ( options->offset > 1 ) ? options->offset : 1;
+	char from[ 32 + INT64_MAX_DIGITS ] = "";
+	if ( offset > 1 )  snprintf( from, sizeof( from ), " from digit %llu on", ( unsigned long long )offset );
+	for ( int i = 0; i < count; i += 1 ) {
+		if ( result.positions[ i ] != 0 ) {
+			FTDC_PRINT( "Found:  '%s' at digit %llu.\n", list[ i ], ( unsigned long long )result.positions[ i ] );
+		} else if ( result.exhausted && result.period.period > 0 ) {
+			FTDC_PRINT( "Found:  '%s' never appears%s  (pre-period %llu, period %llu).\n",
+				list[ i ], from, ( unsigned long long )result.period.pre_period, ( unsigned long long )result.period.period );
+		} else if ( result.exhausted ) {
+			FTDC_PRINT( "Found:  '%s' never appears%s  (fraction terminates after %llu digits).\n",
+				list[ i ], from, ( unsigned long long )result.period.pre_period );
+		} else {
+			FTDC_PRINT( "Found:  '%s' not in digits %llu .. %llu.\n",
+				list[ i ], ( unsigned long long )offset, ( unsigned long long )( offset + result.searched - 1 ) );
+		}
+	}
+	FTDC_PRINT( "Result:  searched %llu digits.\n", ( unsigned long long )result.searched );
+}
+
+// Prints how often each digit (and each pair of adjacent digits, if `pairs`) occurs in the fractional part.
+void ftdc_run_histogram( uint64_t numerator, uint64_t denominator, bool pairs, const ftdc_options *options ) {
+	ftdc_histogram histogram;
+	ftdc_histogram_digits( numerator, denominator, options, pairs, &histogram );
+
+	uint64_t offset = ( options->offset > 1 ) ? options->offset : 1;
+	if ( histogram.count == 0 ) {
+		FTDC_PRINT( "Histogram:  no fractional digits from digit %llu on.\n", ( unsigned long long )offset );
+		return;
+	}
+	FTDC_PRINT( "Histogram:  digits %llu .. %llu  (%llu computed, pre-period %llu, period %llu)\n",
+		( unsigned long long )offset, ( unsigned long long )( offset + histogram.count - 1 ),
+		( unsigned long long )histogram.computed, ( unsigned long long )histogram.period.pre_period,
+		( unsigned long long )histogram.period.period );
+	for ( int digit = 0; digit < 10; digit += 1 ) {
+		FTDC_PRINT( "  %d:  %llu  (%.6f%%)\n", digit, ( unsigned long long )histogram.digits[ digit ],
+			100.0 * ( double )histogram.digits[ digit ] / ( double )histogram.count );
+	}
+	if ( !pairs )  return;
+
+	// Rows are the first digit of a pair, columns the second.
+	FTDC_PRINT( "Pairs:  %llu\n", ( unsigned long long )( histogram.count - 1 ) );
+	for ( int first = 0; first < 10; first += 1 ) {
+		FTDC_PRINT( "  %dx:", first );
+		for ( int second = 0; second < 10; second += 1 ) {
+			FTDC_PRINT( "  %llu", ( unsigned long long )histogram.pairs[ first * 10 + second ] );
+		}
+		FTDC_PRINT( "\n" );
+	}
+}
+
+// Default `--cache` size, and the longest repetend kept per denominator.
+#define FTDC_CACHE_CAPACITY_DEFAULT 4096
+#define FTDC_CACHE_REPETEND_DIGITS_MAX ( 1 << 16 )
+
+// Size of batch input buffer, also the longest accepted input line.
+#define FTDC_BATCH_LINE_MAX ( 1 << 16 )
+
+// Buffered line reader, reuses one buffer for the whole input.
+typedef struct ftdc_reader {
+	FILE   *file;
+	char   *buffer;
+	size_t  size;
+	size_t  start;  // Beginning of unread data.
+	size_t  end;    // End of unread data.
+	bool    eof;
+} ftdc_reader;
+
+// Returns next line, null-terminated in place and without '\n', or NULL at the end of input.
+// Lines longer than the buffer are cut into buffer-sized pieces.
+char *ftdc_reader_line( ftdc_reader *reader ) {
+	while ( true ) {
+		char *line = reader->buffer + reader->start;
+		char *newline = memchr( line, '\n', reader->end - reader->start );
+		if ( newline != NULL ) {
+			*newline = '\0';
+			reader->start = ( newline - reader->buffer ) + 1;
+			return line;
+		}
+
+		if ( reader->eof || reader->end - reader->start == reader->size - 1 ) {
+			if ( reader->start == reader->end )  return NULL;
+			reader->buffer[ reader->end ] = '\0';  // Last line without '\n', or too long one.
+			reader->start = reader->end;
+			return line;
+		}
+
+		// Move incomplete line to the beginning and read more after it.
+		memmove( reader->buffer, line, reader->end - reader->start );
+		reader->end -= reader->start;
+		reader->start = 0;
+		size_t read = fread( reader->buffer + reader->end, sizeof( char ), reader->size - 1 - reader->end, reader->file );
+		reader->end += read;
+		if ( read == 0 )  reader->eof = true;
+	}
+}
+
+// Parses decimal unsigned integer at `str`, skipping leading blanks.
+// Returns pointer past it, or NULL if there is no number or it overflows `uint64_t`.
+static char *ftdc_parse_uint64( char *str, uint64_t *value ) {
+	while ( *str == ' ' || *str == '\t' )  str += 1;
+	if ( *str < '0' || *str > '9' )  return NULL;
+	uint64_t result = 0;
+	while ( *str >= '0' && *str <= '9' ) {
+		uint64_t digit = *str - '0';
+		if ( result > ( UINT64_MAX - digit ) / 10 )  return NULL;
+		result = result * 10 + digit;
+		str += 1;
+	}
+	*value = result;
+	return str;
+}
+
+// Parses `3 7`, `3,7` or `3/7` at `line`.  Returns pointer past it, or NULL if there are no two numbers.
+static char *ftdc_parse_fraction( char *line, uint64_t *numerator, uint64_t *denominator ) {
+	char *cursor = ftdc_parse_uint64( line, numerator );
+	if ( cursor == NULL )  return NULL;
+	while ( *cursor == ' ' || *cursor == '\t' || *cursor == ',' || *cursor == '/' )  cursor += 1;
+	return ftdc_parse_uint64( cursor, denominator );
+}
+
+// Results up to this long are converted straight into the output buffer, longer ones are streamed through it.
+#define FTDC_BATCH_RESULT_MAX ( FTDC_STREAM_BUFFER_SIZE / 2 )
+
+// With `--stats`, batch conversions are timed one in 2^N.
+#define FTDC_BATCH_STATS_SAMPLE_SHIFT 6
+
+// Prints hit, miss and eviction counts of `cache` to stderr, for sizing it with `-C`.
+static void ftdc_print_cache_stats( const ftdc_cache *cache ) {
+	uint64_t lookups = cache->hits + cache->misses;
+	LOGGER_INFO( stderr, NULL, 0, "Cache:  %llu hits, %llu misses (%.1f%% hit rate), %llu evictions, %u of %u entries used.\n",
+		( unsigned long long )cache->hits, ( unsigned long long )cache->misses,
+		( lookups > 0 ) ? 100.0 * cache->hits / lookups : 0.0,
+		( unsigned long long )cache->evictions, cache->count, cache->capacity );
+}
+
+// Converts `numerator denominator` pairs, one per line, from `input` to stdout.
+// Both input buffer and output buffer are reused for every pair, so there is no allocation per fraction.
+// With `cache`, everything that depends only on the denominator is computed once per denominator.
+//   text:  `3 / 7 = 0.428571`
+//   csv:   `3,7,0.428571,`  (the last column is an error message, if any)
+void ftdc_run_batch( FILE *input, bool csv, const ftdc_options *options, ftdc_cache *cache ) {
+	ftdc_reader reader = { .file = input, .size = FTDC_BATCH_LINE_MAX };
+	ftdc_writer writer = { .fd = 1 /* stdout */, .size = FTDC_STREAM_BUFFER_SIZE, .stats = options->stats };
+	reader.buffer = FTDC_ALLOC( reader.size, char );
+	writer.buffer = FTDC_ALLOC( writer.size, char );
+	if ( reader.buffer == NULL || writer.buffer == NULL ) {
+		FTDC_ERROR( -9, "Could not allocate %zu bytes of memory for batch buffers.", reader.size + writer.size );
+	}
+	logger_flush();  // Keep order with unbuffered writes below.
+
+	if ( csv )  ftdc_writer_put( &writer, "numerator,denominator,result,error\n", 35 );
+
+	char *line;
+	uint64_t lines = 0;
+	ftdc_stats *timed = ftdc_stats_timed( options->stats );
+	uint64_t phase_start = ( timed != NULL ) ? ftdc_ticks() : 0;
+	while ( ( line = ftdc_reader_line( &reader ) ) != NULL ) {
+		lines += 1;
+		size_t length = strlen( line );
+		if ( length > 0 && line[ length - 1 ] == '\r' )  line[ --length ] = '\0';
+		if ( length == 0 || line[ 0 ] == '#' )  continue;
+
+		uint64_t numerator = 0, denominator = 0;
+		const char *error = NULL;
+		char *cursor = ftdc_parse_fraction( line, &numerator, &denominator );
+		if ( cursor == NULL )          error = "expected <numerator> <denominator> 64-bit unsigned integers";
+		else if ( denominator == 0 )  error = "denominator cannot be 0";
+		ftdc_stats_phase( timed, FTDC_PHASE_PARSE, &phase_start );
+
+		char *out = ftdc_writer_reserve( &writer, 2 * INT64_MAX_DIGITS + 8 );
+		if ( error != NULL ) {
+			FTDC_TRACE( "Line %llu:  '%s' -> %s", ( unsigned long long )lines, line, error );
+			if ( csv && cursor != NULL ) {
+				writer.used += snprintf( out, 2 * INT64_MAX_DIGITS + 8, "%llu,%llu,,",
+					( unsigned long long )numerator, ( unsigned long long )denominator );
+			} else if ( csv ) {
+				ftdc_writer_put( &writer, ",,,", 3 );
+			} else {
+				ftdc_writer_put( &writer, line, length );
+				ftdc_writer_put( &writer, " = ", 3 );
+			}
+			ftdc_writer_put( &writer, "error: ", 7 );
+			ftdc_writer_put( &writer, error, strlen( error ) );
+			ftdc_writer_put( &writer, "\n", 1 );
+			continue;
+		}
+		writer.used += snprintf( out, 2 * INT64_MAX_DIGITS + 8, csv ? "%llu,%llu," : "%llu / %llu = ",
+			( unsigned long long )numerator, ( unsigned long long )denominator );
+
+		ftdc_result result;
+		out = ftdc_writer_reserve( &writer, FTDC_BATCH_RESULT_MAX );
+		if ( ftdc_convert_cached( cache, numerator, denominator, options, out, writer.size - writer.used, &result ) == FTDC_OK ) {
+			writer.used += result.length;
+		} else {
+			// Too long for the buffer:  stream it, with everything already found out about it.
+			ftdc_writer_put_decimal( &writer, result.integer, result.fraction_numerator, result.denominator,
+				options->precision, options->offset, result.repeating ? &result.period : NULL, options->base,
+				options->threads_count );
+		}
+		ftdc_writer_put( &writer, csv ? ",\n" : "\n", csv ? 2 : 1 );
+		// Conversion and output time themselves, parsing of the next line is timed if its conversion will be.
+		timed = ftdc_stats_timed( options->stats );
+		if ( timed != NULL )  phase_start = ftdc_ticks();
+	}
+
+	ftdc_writer_flush( &writer );
+	FTDC_FREE( writer.buffer );
+	FTDC_FREE( reader.buffer );
+
+	if ( cache != NULL )  ftdc_print_cache_stats( cache );
+}
+
+// Adds timings and counters of `part` to `total`.
+static void ftdc_stats_add( ftdc_stats *total, const ftdc_stats *part ) {
+	for ( int phase = 0; phase < FTDC_PHASE_COUNT; phase += 1 )  total->ticks[ phase ] += part->ticks[ phase ];
+	total->conversions += part->conversions;
+	total->digits += part->digits;
+	total->divisions += part->divisions;
+	total->seeks += part->seeks;
+	total->bytes_written += part->bytes_written;
+}
+
+#if defined( __linux__ )
+
+// Per-connection input and output buffers of `--serve`.  Requests are lines, same as batch input,
+//   a line longer than the input buffer closes the connection.
+#define FTDC_SERVE_BUFFER_SIZE ( 1 << 16 )
+
+// Longest reply, the rest of output buffer holds earlier replies not yet taken by the client.
+#define FTDC_SERVE_RESULT_MAX ( FTDC_SERVE_BUFFER_SIZE / 2 )
+
+#define FTDC_SERVE_EVENTS_MAX 64
+
+// How often workers check whether to stop, in milliseconds.
+#define FTDC_SERVE_STOP_CHECK_MS 200
+
+// One client of `--serve`.  Buffers are allocated along with it once per connection, never per request.
+typedef struct ftdc_connection {
+	int                     fd;
+	size_t                  input_used;
+	size_t                  output_start;  // Replies before it are taken by the client.
+	size_t                  output_used;
+	bool                    writing;       // Waiting for the client to take replies, not reading requests.
+	char                   *input;
+	char                   *output;
+	struct ftdc_connection *prev;          // All connections of a worker, to close them on stop.
+	struct ftdc_connection *next;
+} ftdc_connection;
+
+// Worker thread of `--serve`, running its own event loop over connections it accepted.
+typedef struct ftdc_serve_worker {
+	pthread_t        thread;
+	int              listener;
+	int              epoll;
+	ftdc_options     options;      // Same as given, but with own stats.
+	ftdc_stats       stats;
+	ftdc_cache      *cache;
+	ftdc_connection *connections;
+	uint64_t         requests;
+	uint64_t         connections_count;
+} ftdc_serve_worker;
+
+static volatile sig_atomic_t ftdc_serve_stopping = 0;
+
+static void ftdc_serve_stop( int signal_number ) {
+	( void )signal_number;
+	ftdc_serve_stopping = 1;
+}
+
+// Writes reply to request `line` into `out` (at least `FTDC_SERVE_RESULT_MAX` bytes):  decimal or error, and '\n'.
+// Returns its length.
+static size_t ftdc_serve_reply( ftdc_serve_worker *worker, char *line, char *out ) {
+	ftdc_stats *timed = ftdc_stats_timed( worker->options.stats );
+	uint64_t phase_start = ( timed != NULL ) ? ftdc_ticks() : 0;
+	uint64_t numerator = 0, denominator = 0;
+	const char *error = NULL;
+	char *cursor = ftdc_parse_fraction( line, &numerator, &denominator );
+	if ( cursor == NULL )          error = "expected <numerator> <denominator> 64-bit unsigned integers";
+	else if ( denominator == 0 )  error = "denominator cannot be 0";
+	ftdc_stats_phase( timed, FTDC_PHASE_PARSE, &phase_start );
+
+	ftdc_result result;
+	if ( error == NULL && ftdc_convert_cached( worker->cache, numerator, denominator, &worker->options,
+		out, FTDC_SERVE_RESULT_MAX - 1, &result ) == FTDC_OK )
+	{
+		out[ result.length ] = '\n';
+		return result.length + 1;
+	}
+	if ( error == NULL )  error = "result does not fit into reply, lower precision of the server";
+	return snprintf( out, FTDC_SERVE_RESULT_MAX, "error: %s\n", error );
+}
+
+// Replies to complete requests while there is room for replies.  Returns false if the connection is to be closed.
+static bool ftdc_serve_process( ftdc_serve_worker *worker, ftdc_connection *connection, bool *requests_left ) {
+	size_t start = 0;
+	*requests_left = false;
+	while ( true ) {
+		char *line = connection->input + start;
+		char *newline = memchr( line, '\n', connection->input_used - start );
+		if ( newline == NULL )  break;
+		if ( FTDC_SERVE_BUFFER_SIZE - connection->output_used < FTDC_SERVE_RESULT_MAX ) {
+			*requests_left = true;  // Rest wait until earlier replies are taken.
+			break;
 		}
+
+		*newline = '\0';
+		if ( newline > line && newline[ -1 ] == '\r' )  newline[ -1 ] = '\0';
+		connection->output_used += ftdc_serve_reply( worker, line, connection->output + connection->output_used );
+		worker->requests += 1;
+		start = ( newline - connection->input ) + 1;
+	}
+
+	memmove( connection->input, connection->input + start, connection->input_used - start );
+	connection->input_used -= start;
+	return connection->input_used < FTDC_SERVE_BUFFER_SIZE || *requests_left;  // Else a line is too long.
+}
+
+// Writes out as many replies as the client takes.  Returns false if the connection is to be closed.
+static bool ftdc_serve_write( ftdc_serve_worker *worker, ftdc_connection *connection ) {
+	uint64_t phase_start = ( worker->options.stats != NULL ) ? ftdc_ticks() : 0;
+	while ( connection->output_start < connection->output_used ) {
+		ssize_t written = send( connection->fd, connection->output + connection->output_start,
+			connection->output_used - connection->output_start, MSG_NOSIGNAL );
+		if ( written < 0 && errno == EINTR )  continue;
+		if ( written < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK ) )  break;
+		if ( written < 0 )  return false;
+		connection->output_start += written;
+		worker->stats.bytes_written += written;
+	}
+	ftdc_stats_phase( worker->options.stats, FTDC_PHASE_OUTPUT, &phase_start );
+	if ( connection->output_start == connection->output_used ) {
+		connection->output_start = 0;
+		connection->output_used = 0;
 	}
 
-	char digit;
-	while ( magnitude >= 10 ) {
-		digit = ( number / magnitude ) % 10;
-		cursor += ftdc_append_digit( buffer, buffer_size, cursor, digit );
-		magnitude /= 10;
+	// Level-triggered:  either waits for requests, or for the client to take pending replies, never both.
+	bool writing = ( connection->output_used > 0 );
+	if ( writing != connection->writing ) {
+		struct epoll_event event = { .events = writing ? EPOLLOUT : EPOLLIN, .data.ptr = connection };
+		if ( epoll_ctl( worker->epoll, EPOLL_CTL_MOD, connection->fd, &event ) != 0 )  return false;
+		connection->writing = writing;
 	}
-	digit = number % 10;
-	cursor += ftdc_append_digit( buffer, buffer_size, cursor, digit );
+	return true;
+}
 
-	return cursor - old_cursor;
+// Replies to buffered requests and writes replies out, for as long as the client takes them.
+static bool ftdc_serve_pump( ftdc_serve_worker *worker, ftdc_connection *connection ) {
+	bool requests_left;
+	do {
+		if ( !ftdc_serve_process( worker, connection, &requests_left ) )  return false;
+		if ( !ftdc_serve_write( worker, connection ) )  return false;
+	} while ( requests_left && !connection->writing );
+	return true;
+}
+
+static void ftdc_serve_close( ftdc_serve_worker *worker, ftdc_connection *connection ) {
+	epoll_ctl( worker->epoll, EPOLL_CTL_DEL, connection->fd, NULL );
+	close( connection->fd );
+	if ( connection->prev != NULL )  connection->prev->next = connection->next;
+	else                             worker->connections = connection->next;
+	if ( connection->next != NULL )  connection->next->prev = connection->prev;
+	FTDC_FREE( connection );
+}
+
+static void ftdc_serve_accept( ftdc_serve_worker *worker ) {
+	while ( true ) {
+		int fd = accept( worker->listener, NULL, NULL );
+		if ( fd < 0 )  return;  // No more pending, or taken by another worker.
+		fcntl( fd, F_SETFL, O_NONBLOCK );
+
+		ftdc_connection *connection = ( ftdc_connection * )FTDC_ALLOC( sizeof( ftdc_connection ) + 2 * FTDC_SERVE_BUFFER_SIZE, char );
+		if ( connection == NULL ) {
+			close( fd );
+			continue;
+		}
+		memset( connection, 0, sizeof( *connection ) );
+		connection->fd = fd;
+		connection->input = ( char * )( connection + 1 );
+		connection->output = connection->input + FTDC_SERVE_BUFFER_SIZE;
+		struct epoll_event event = { .events = EPOLLIN, .data.ptr = connection };
+		if ( epoll_ctl( worker->epoll, EPOLL_CTL_ADD, fd, &event ) != 0 ) {
+			close( fd );
+			FTDC_FREE( connection );
+			continue;
+		}
+		connection->next = worker->connections;
+		if ( worker->connections != NULL )  worker->connections->prev = connection;
+		worker->connections = connection;
+		worker->connections_count += 1;
+	}
 }
 
-// Returns (G)reatest (C)ommon (D)ivisor.
-uint64_t ftdc_GCD( uint64_t a, uint64_t b ) {
-	uint64_t r = 0; // Remainder
-	// Non-recursive iteration:
-	// Instead of recursively calling itself, bloating the call stack,
-	// just jump to the beginning of the loop.
-loop:
-	while ( b != 0 ) {
-		// Same as: `a = GCD( b, a % b );`
-		r = a % b;
-		a = b;
-		b = r;
-		goto loop;
+// Event loop of a worker:  accepts connections (the listener wakes one worker at a time) and serves them.
+static void *ftdc_serve_worker_run( void *argument ) {
+	ftdc_serve_worker *worker = argument;
+	struct epoll_event events[ FTDC_SERVE_EVENTS_MAX ];
+	while ( !ftdc_serve_stopping ) {
+		int count = epoll_wait( worker->epoll, events, FTDC_SERVE_EVENTS_MAX, FTDC_SERVE_STOP_CHECK_MS );
+		for ( int i = 0; i < count; i += 1 ) {
+			ftdc_connection *connection = events[ i ].data.ptr;
+			if ( connection == NULL ) {
+				ftdc_serve_accept( worker );
+				continue;
+			}
+
+			bool keep = true;
+			if ( events[ i ].events & EPOLLIN ) {
+				ssize_t read_count = read( connection->fd, connection->input + connection->input_used,
+					FTDC_SERVE_BUFFER_SIZE - connection->input_used );
+				if ( read_count > 0 ) {
+					connection->input_used += read_count;
+					keep = ftdc_serve_pump( worker, connection );
+				} else if ( read_count == 0 || ( errno != EAGAIN && errno != EINTR ) ) {
+					keep = false;  // Client is gone.
+				}
+			} else if ( events[ i ].events & EPOLLOUT ) {
+				keep = ftdc_serve_pump( worker, connection );
+			}
+			if ( !keep || ( events[ i ].events & ( EPOLLERR | EPOLLHUP ) ) )  ftdc_serve_close( worker, connection );
+		}
 	}
-	return a;
+
+	while ( worker->connections != NULL )  ftdc_serve_close( worker, worker->connections );
+	return NULL;
+}
+
+// Serves conversions on Unix domain socket at `path` until SIGINT or SIGTERM, on `workers_count` threads.
+// Every line a client sends is a `numerator denominator` pair, converted with `options`, and replied to with
+//   one line:  the decimal, or `error: ...`.  Clients may send many requests without waiting for replies,
+//   replies come in the same order.
+void ftdc_run_serve( const char *path, const ftdc_options *options, int workers_count, uint64_t cache_capacity ) {
+	struct sockaddr_un address = { .sun_family = AF_UNIX };
+	if ( strlen( path ) >= sizeof( address.sun_path ) ) {
+		FTDC_ERROR( -16, "Socket path '%s' is longer than %zu bytes.\n", path, sizeof( address.sun_path ) - 1 );
+	}
+	strcpy( address.sun_path, path );
+	if ( options->precision > FTDC_SERVE_RESULT_MAX - 2 * INT64_MAX_DIGITS - 8 ) {
+		FTDC_WARN( "Replies longer than %d bytes do not fit, requests for them get an error.\n", FTDC_SERVE_RESULT_MAX );
+	}
+
+	int listener = socket( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 );
+	if ( listener < 0 ) {
+		FTDC_ERROR( -16, "Could not create socket.\n" );
+	}
+	unlink( path );  // Left over from a previous run.
+	if ( bind( listener, ( struct sockaddr * )&address, sizeof( address ) ) != 0 || listen( listener, SOMAXCONN ) != 0 ) {
+		FTDC_ERROR( -16, "Could not listen on socket '%s'.\n", path );
+	}
+
+	struct sigaction action = { .sa_handler = ftdc_serve_stop };
+	sigaction( SIGINT, &action, NULL );
+	sigaction( SIGTERM, &action, NULL );
+
+	ftdc_serve_worker *workers = FTDC_ALLOC( workers_count, ftdc_serve_worker );
+	if ( workers == NULL ) {
+		FTDC_ERROR( -9, "Could not allocate memory for %d workers.", workers_count );
+	}
+	for ( int i = 0; i < workers_count; i += 1 ) {
+		ftdc_serve_worker *worker = &workers[ i ];
+		memset( worker, 0, sizeof( *worker ) );
+		worker->listener = listener;
+		worker->options = *options;
+		worker->options.threads_count = 1;  // Requests are spread across workers instead.
+		if ( options->stats != NULL ) {
+			ftdc_stats_start( &worker->stats );
+			worker->stats.sample_shift = options->stats->sample_shift;
+			worker->options.stats = &worker->stats;
+		}
+		if ( cache_capacity > 0 ) {
+			worker->cache = ftdc_cache_create( ( uint32_t )cache_capacity, FTDC_CACHE_REPETEND_DIGITS_MAX );
+			if ( worker->cache == NULL ) {
+				FTDC_ERROR( -9, "Could not allocate memory for cache of %llu denominators.",
+					( unsigned long long )cache_capacity );
+			}
+		}
+
+		// Every worker waits on the listener, but a connection wakes only one of them.
+		worker->epoll = epoll_create1( EPOLL_CLOEXEC );
+		struct epoll_event event = { .events = EPOLLIN | EPOLLEXCLUSIVE, .data.ptr = NULL };
+		if ( worker->epoll < 0 || epoll_ctl( worker->epoll, EPOLL_CTL_ADD, listener, &event ) != 0 ) {
+			FTDC_ERROR( -16, "Could not create event loop of worker %d.\n", i + 1 );
+		}
+	}
+
+	FTDC_PRINT( "Serving on '%s' with %d workers, stop with Ctrl+C.\n", path, workers_count );
+	logger_flush();
+	int started = 0;
+	for ( ; started < workers_count; started += 1 ) {
+		if ( pthread_create( &workers[ started ].thread, NULL, ftdc_serve_worker_run, &workers[ started ] ) != 0 )  break;
+	}
+	if ( started == 0 ) {
+		FTDC_ERROR( -16, "Could not start any worker thread.\n" );
+	}
+
+	uint64_t requests = 0, connections_count = 0;
+	ftdc_cache caches = { 0 };  // Counts of all workers' caches together.
+	for ( int i = 0; i < workers_count; i += 1 ) {
+		if ( i < started )  pthread_join( workers[ i ].thread, NULL );
+		requests += workers[ i ].requests;
+		connections_count += workers[ i ].connections_count;
+		if ( options->stats != NULL )  ftdc_stats_add( options->stats, &workers[ i ].stats );
+		if ( workers[ i ].cache != NULL ) {
+			caches.hits += workers[ i ].cache->hits;
+			caches.misses += workers[ i ].cache->misses;
+			caches.evictions += workers[ i ].cache->evictions;
+			caches.count += workers[ i ].cache->count;
+			caches.capacity += workers[ i ].cache->capacity;
+		}
+		ftdc_cache_destroy( workers[ i ].cache );
+		close( workers[ i ].epoll );
+	}
+	FTDC_FREE( workers );
+	close( listener );
+	unlink( path );
+	FTDC_PRINT( "Served %llu requests over %llu connections.\n", ( unsigned long long )requests,
+		( unsigned long long )connections_count );
+	if ( cache_capacity > 0 )  ftdc_print_cache_stats( &caches );
+}
+
+#endif /* __linux__ */
+
+// Adds output time since `*since` and `bytes` of decimal output to `stats`, if not NULL.
+// Flushes queued output first, so the time covers actually writing it out.
+static void ftdc_stats_output( ftdc_stats *stats, uint64_t bytes, uint64_t *since ) {
+	if ( stats == NULL )  return;
+	logger_flush();
+	stats->bytes_written += bytes;
+	ftdc_stats_phase( stats, FTDC_PHASE_OUTPUT, since );
+}
+
+// Prints `--stats` report to stderr.  Phases do not add up to the total:  argument handling,
+//   and batch separators between conversions, are not timed.  Sampled phases are estimates.
+static void ftdc_print_stats( const ftdc_stats *stats ) {
+	static const char *phase_names[ FTDC_PHASE_COUNT ] = { "parse", "simplify", "integer", "format", "fraction", "output" };
+	double ns_per_tick = ftdc_stats_ns_per_tick( stats );
+	double total_ns = ( double )( ftdc_clock_ns() - stats->start_ns );
+	LOGGER_INFO( stderr, NULL, 0, "Stats:  " );
+	for ( int phase = 0; phase < FTDC_PHASE_COUNT; phase += 1 ) {
+		LOGGER_INFO( stderr, NULL, 0, "%s %.3f ms, ", phase_names[ phase ],
+			ftdc_stats_phase_ns( stats, ( ftdc_phase )phase, ns_per_tick ) / 1e6 );
+	}
+	LOGGER_INFO( stderr, NULL, 0, "total %.3f ms", total_ns / 1e6 );
+	if ( stats->sample_shift > 0 ) {
+		LOGGER_INFO( stderr, NULL, 0, " (phases timed for 1 in %llu conversions)", 1llu << stats->sample_shift );
+	}
+	LOGGER_INFO( stderr, NULL, 0, ".\n" );
+	LOGGER_INFO( stderr, NULL, 0, "Stats:  %llu conversions, %llu digits (%.0f digits/s), %llu divisions, %llu seeks,"
+		" %llu bytes written.\n",
+		( unsigned long long )stats->conversions, ( unsigned long long )stats->digits,
+		( total_ns > 0 ) ? stats->digits * 1e9 / total_ns : 0.0,
+		( unsigned long long )stats->divisions, ( unsigned long long )stats->seeks, ( unsigned long long )stats->bytes_written );
+	ftdc_alloc_stats memory;
+	ftdc_alloc_stats_get( &memory );
+	LOGGER_INFO( stderr, NULL, 0, "Stats:  %llu allocations, %llu bytes reserved, %llu committed at peak, %llu faulted"
+		" (%llu prefaulted).\n",
+		( unsigned long long )memory.allocations, ( unsigned long long )memory.reserved,
+		( unsigned long long )memory.committed_peak, ( unsigned long long )memory.faulted,
+		( unsigned long long )memory.prefaulted );
+}
+
+// Converts fraction with operands above 64 bits by the arbitrary-precision engine.
+// Same output as for 64-bit ones, into stdout or `output_path` file if not NULL.
+void ftdc_run_big( const char *arg_numerator, const char *arg_denominator, const ftdc_options *options,
+	const char *output_path )
+{
+	uint64_t phase_start = ( options->stats != NULL ) ? ftdc_ticks() : 0;
+	ftdc_big numerator, denominator;
+	ftdc_status status = ftdc_big_parse( &numerator, arg_numerator );
+	if ( status == FTDC_ERR_TOO_LARGE ) {
+		FTDC_ERROR( -15, "Numerator '%s' does not fit into %d bits.\n", arg_numerator, FTDC_BIG_LIMBS_MAX * 64 );
+	} else if ( status != FTDC_OK ) {
+		FTDC_ERROR( -7, "Numerator '%s' is not a valid integer number.", arg_numerator );
+	}
+	status = ftdc_big_parse( &denominator, arg_denominator );
+	if ( status == FTDC_ERR_TOO_LARGE ) {
+		FTDC_ERROR( -15, "Denominator '%s' does not fit into %d bits.\n", arg_denominator, FTDC_BIG_LIMBS_MAX * 64 );
+	} else if ( status != FTDC_OK ) {
+		FTDC_ERROR( -8, "Denominator '%s' is not a valid integer number.\n", arg_denominator );
+	}
+	ftdc_stats_phase( options->stats, FTDC_PHASE_PARSE, &phase_start );
+
+	// Measure first, same as for 64-bit operands.
+	ftdc_big_result result;
+	ftdc_convert_big( &numerator, &denominator, options, NULL, 0, &result );
+	if ( options->repeating && !result.repeating && result.fraction_numerator.count != 0 ) {
+		if ( result.period_unknown ) {
+			FTDC_WARN( "Period is not searched for denominators above 64 bits (without factors of 2 and 5),"
+				" printing digits without period notation.\n" );
+		} else {
+			FTDC_WARN( "Period of %llu digits (after %llu non-repeating) does not fit into %llu digits of precision,"
+				" printing them without period notation.\n",
+				( unsigned long long )result.period.period, ( unsigned long long )result.period.pre_period,
+				( unsigned long long )options->precision );
+		}
+	}
+
+	char given_numerator_str[ FTDC_BIG_DIGITS_MAX + 1 ], given_denominator_str[ FTDC_BIG_DIGITS_MAX + 1 ];
+	char numerator_str[ FTDC_BIG_DIGITS_MAX + 1 ], denominator_str[ FTDC_BIG_DIGITS_MAX + 1 ];
+	char integer_str[ FTDC_BIG_DIGITS_MAX + 1 ], fraction_numerator_str[ FTDC_BIG_DIGITS_MAX + 1 ];
+	ftdc_big_to_string( given_numerator_str, sizeof( given_numerator_str ), &numerator );
+	ftdc_big_to_string( given_denominator_str, sizeof( given_denominator_str ), &denominator );
+	ftdc_big_to_string( numerator_str, sizeof( numerator_str ), &result.numerator );
+	ftdc_big_to_string( denominator_str, sizeof( denominator_str ), &result.denominator );
+	ftdc_big_to_string( integer_str, sizeof( integer_str ), &result.integer );
+	ftdc_big_to_string( fraction_numerator_str, sizeof( fraction_numerator_str ), &result.fraction_numerator );
+
+	FTDC_PRINT(
+		"Given:  %s / %s\n"
+		"Simplified:  %s / %s\n",
+		given_numerator_str, given_denominator_str,
+		numerator_str, denominator_str );
+
+	if ( output_path != NULL ) {
+		logger_flush();
+		ftdc_mapping mapping;
+		ftdc_mapping_create( &mapping, output_path, result.length + 1, false );
+		ftdc_convert_big( &numerator, &denominator, options, mapping.data, mapping.size, &result );
+		mapping.data[ result.length ] = '\n';
+		if ( options->stats != NULL )  phase_start = ftdc_ticks();
+		ftdc_mapping_close( &mapping );
+		ftdc_stats_output( options->stats, result.length + 1, &phase_start );
+		FTDC_PRINT( "Result:  written %zu bytes to '%s'  ( %s  +  %s / %s )\n",
+			result.length + 1, output_path,
+			integer_str, fraction_numerator_str, denominator_str );
+		return;
+	}
+
+	size_t decimal_str_size = result.length + 1 /* '\0' */;
+	char *decimal_str = FTDC_ALLOC( decimal_str_size, char );
+	if ( decimal_str == NULL ) {
+		FTDC_ERROR( -9, "Could not allocate %zu bytes of memory for decimal string of %llu fractional digits.",
+			decimal_str_size, ( unsigned long long )options->precision );
+	}
+	ftdc_convert_big( &numerator, &denominator, options, decimal_str, decimal_str_size, &result );
+	if ( options->stats != NULL )  phase_start = ftdc_ticks();
+	FTDC_PRINT( "Result:  %s  ( %s  +  %s / %s )\n",
+		decimal_str, integer_str, fraction_numerator_str, denominator_str );
+	ftdc_stats_output( options->stats, result.length, &phase_start );
+	FTDC_FREE( decimal_str );
 }
 
 // Returns pointer to the beginning of the value string,
@@ -123,24 +1103,96 @@ char *ftdc_skip_to_arg_value( char *arg ) {
 	return arg;
 }
 
+// Parses `--option=value` unsigned integer value into `*value`.
+// Returns false (and warns) if value is missing or not a valid number.
+bool ftdc_parse_option_uint64( char *arg, uint64_t *value ) {
+	char *value_str = ftdc_skip_to_arg_value( arg );
+	if ( value_str == NULL ) {
+		FTDC_WARN( "Option '%s' did not specify value, ignoring it.", arg );
+		FTDC_PRINT( " Correct usage: `--option=value`.\n" );
+		return false;
+	}
+
+	*value = strtoull( value_str, NULL, 10 );  // Parse argument value
+	if ( *value == 0 && strcmp( value_str, "0" ) != 0 ) {
+		FTDC_WARN( "Specified value '%s' in option '%s' is not valid, ignoring it.", value_str, arg );
+		FTDC_PRINT( " Correct usage: `--option=value`.\n" );
+		return false;
+	}
+	return true;
+}
+
 void ftdc_print_usage( void ) {
 	FTDC_PRINT( "Usage: `ftdc [--option=value] [-O=value...] -- <numerator> <denominator>`\n"
 		"Example: `ftdc --precision=50 -- 3 10`\n"
 		"     or: `ftdc -P=50 -- 3 10`\n"
+		"Numerator and denominator can have up to 4096 bits (1234 digits).\n"
 		"\n"
 		"Options:\n"
 		"  help, --help:       Prints help message.\n"
-		"  -P,   --precision:  Sets fractional part precision, e.g. the number of digits after dot.\n", NULL );
+		"  -P,   --precision:  Sets fractional part precision, e.g. the number of digits after dot.\n"
+		"  -O,   --offset:     Starts fractional part from this digit (1-based), skipping the ones before it.\n"
+		"  -T,   --threads:    Computes fractional part on this many threads, 0 for one per CPU core.\n"
+		"  -S,   --stream:     Streams digits out as they are computed, using constant memory regardless of precision.\n"
+		"  -B,   --batch:      Reads `<numerator> <denominator>` pairs, one per line, from stdin or given file (`--batch=FILE`).\n"
+		"        --format:     Batch output format: `text` (default) or `csv`.\n"
+		"  -C,   --cache:      Batch and serve only.  Caches period and repetend of this many denominators (`--cache=N`,\n"
+		"                      default 4096), for inputs repeating the same denominators.  Prints hit and miss counts to stderr.\n"
+		"        --serve:      Serves conversions on Unix domain socket (`--serve=/path/to.sock`) until Ctrl+C.\n"
+		"                      Clients send `<numerator> <denominator>` lines, and get one line back for each.\n"
+		"                      `-T` sets the number of worker threads, one per CPU by default.\n"
+		"  -R,   --repeating:  Detects repeating decimals and stops after one period, e.g. `0.(142857)`.\n"
+		"        --base:       Writes digits in this base, 2 to 36 (`--base=16`), letters for digits above 9.\n"
+		"                      Not supported with `--find`, `--histogram`, `--checkpoint` and numbers above 64 bits.\n"
+		"        --output:     Writes result into given file (`--output=PATH`) through memory mapping, for huge precisions.\n"
+		"        --checkpoint: With `--output`, saves progress into given file (`--checkpoint=PATH`) every `--checkpoint-every`\n"
+		"                      fractional digits (default 1000000000), after flushing them to disk.\n"
+		"        --resume:     Continues `--output` run from its checkpoint (`--resume=PATH`).  Run with the same options,\n"
+		"                      output file is checked against the checkpoint.  Keeps checkpointing there unless `--checkpoint` is given.\n"
+		"        --find:       Prints where digit patterns (`--find=314159,2718`) first appear in fractional part, instead of it.\n"
+		"                      Searches up to `-P` digits if given, else until found or proven never to appear.\n"
+		"        --histogram:  Prints how many times each digit occurs in fractional part, instead of it.\n"
+		"                      `--histogram=pairs` also counts pairs of adjacent digits.\n"
+		"        --alloc:      Memory allocator:  `malloc` (default), `arena` (one reservation for all allocations, for batch),\n"
+		"                      `mmap` (huge-page mappings for big buffers) or `mmap-prefault` (same, faulted in up front).\n"
+		"        --stats:      Prints time spent in every phase, digits per second and division count to stderr.\n" );
 }
 
 int main( int arguments_count, char *arguments[] ) {
+	ftdc_stats stats;
+	ftdc_stats_start( &stats );  // Parse phase starts here, even though `--stats` is not known yet.
+	ftdc_detect_cpu();
+
 	if ( arguments_count < 2 ) {
 		// If no arguments provided (excluding executable path), print help message.
 		ftdc_print_usage();
 		return 0;
 	}
 
-	uint64_t dec_frac_digits_max = 50; // Max number of digits to compute in fractional part.
+	ftdc_options options = {
+		.precision     = 50,     // Max number of digits to compute in fractional part.
+		.offset        = 1,      // Position of the first fractional digit to compute, 1-based.
+		.repeating     = false,  // Stop after one period of repeating digits.
+		.threads_count = 1
+	};
+	bool stream_output = false;  // Write digits through fixed-size buffer instead of holding them all in memory.
+	bool batch = false;  // Read fractions from input instead of user arguments.
+	char *batch_path = NULL;  // NULL for stdin.
+	bool batch_csv = false;
+	uint64_t cache_capacity = 0;  // Denominators cached in batch mode, 0 for no cache.
+	char *output_path = NULL;  // Result goes to this file instead of stdout, if set.
+	char *serve_path = NULL;  // Serve conversions on this Unix domain socket, if set.
+	bool threads_given = false;  // With `--serve`, workers default to one per CPU.
+	char *checkpoint_path = NULL;  // With `--output`, progress is saved into this file, if set.
+	uint64_t checkpoint_every = FTDC_CHECKPOINT_EVERY_DEFAULT;  // Fractional digits between checkpoints.
+	char *resume_path = NULL;  // With `--output`, continue from checkpoint in this file, if set.
+	char *find_patterns = NULL;  // Search fractional digits for these comma-separated patterns, if set.
+	ftdc_alloc_config alloc_config = {
+		.kind = FTDC_ALLOC_MALLOC, .arena_size = FTDC_ALLOC_ARENA_SIZE_DEFAULT, .mmap_threshold = FTDC_ALLOC_MMAP_THRESHOLD_DEFAULT
+	};
+	bool histogram = false;  // Count fractional digits instead of printing them.
+	bool histogram_pairs = false;
+	bool precision_given = false;  // With `--find`, search is not limited by default precision.
 
 	/* Parse optional arguments */
 
@@ -156,43 +1208,204 @@ int main( int arguments_count, char *arguments[] ) {
 			ftdc_print_usage();
 			return 0;
 		} else if ( strncmp( arg, "-P", 2 ) == 0 || strncmp( arg, "--precision", 11 ) == 0 ) {
+			uint64_t value;
+			last_option_value_valid = ftdc_parse_option_uint64( arg, &value );
+			if ( last_option_value_valid ) {
+				options.precision = value;
+				precision_given = true;
+				FTDC_PRINT( "Set fractional pricision digits to %llu.\n", ( unsigned long long )value );
+			}
+		} else if ( strncmp( arg, "-O", 2 ) == 0 || strncmp( arg, "--offset", 8 ) == 0 ) {
+			uint64_t value;
+			last_option_value_valid = ftdc_parse_option_uint64( arg, &value );
+			if ( last_option_value_valid && value == 0 ) {
+				FTDC_WARN( "Offset in option '%s' starts from 1, ignoring it.\n", arg );
+				last_option_value_valid = false;
+			} else if ( last_option_value_valid ) {
+				options.offset = value;
+				FTDC_PRINT( "Set fractional digits offset to %llu.\n", ( unsigned long long )value );
+			}
+		} else if ( strncmp( arg, "-T", 2 ) == 0 || strncmp( arg, "--threads", 9 ) == 0 ) {
+			uint64_t value;
+			last_option_value_valid = ftdc_parse_option_uint64( arg, &value );
+			if ( last_option_value_valid ) {
+				options.threads_count = ( value == 0 ) ? ftdc_cpu_count() : ( value > FTDC_THREADS_MAX ) ? FTDC_THREADS_MAX : ( int )value;
+				threads_given = true;
+				FTDC_PRINT( "Set threads to %d.\n", options.threads_count );
+			}
+		} else if ( strcmp( arg, "-S" ) == 0 || strcmp( arg, "--stream" ) == 0 ) {
+			stream_output = true;
+			last_option_value_valid = true;
+		} else if ( strncmp( arg, "-B", 2 ) == 0 || strncmp( arg, "--batch", 7 ) == 0 ) {
+			batch = true;
+			batch_path = ftdc_skip_to_arg_value( arg );  // Optional
+			last_option_value_valid = true;
+		} else if ( strncmp( arg, "-C", 2 ) == 0 || strncmp( arg, "--cache", 7 ) == 0 ) {
+			cache_capacity = FTDC_CACHE_CAPACITY_DEFAULT;
+			last_option_value_valid = true;
+			if ( ftdc_skip_to_arg_value( arg ) != NULL ) {
+				uint64_t value;
+				last_option_value_valid = ftdc_parse_option_uint64( arg, &value );
+				if ( last_option_value_valid )  cache_capacity = ( value > UINT32_MAX / 2 ) ? UINT32_MAX / 2 : value;
+			}
+		} else if ( strncmp( arg, "--format", 8 ) == 0 ) {
 			char *value_str = ftdc_skip_to_arg_value( arg );
-			if ( value_str == NULL ) {
-				FTDC_WARN( "Option '%s' did not specify value, ignoring it.", arg );
-				FTDC_PRINT( " Correct usage: `--option=value`.\n", NULL );
+			if ( value_str != NULL && ( strcmp( value_str, "csv" ) == 0 || strcmp( value_str, "text" ) == 0 ) ) {
+				batch_csv = ( strcmp( value_str, "csv" ) == 0 );
+				last_option_value_valid = true;
+			} else {
+				FTDC_WARN( "Option '%s' expects `text` or `csv`, ignoring it.\n", arg );
 				last_option_value_valid = false;
+			}
+		} else if ( strncmp( arg, "--output", 8 ) == 0 ) {
+			output_path = ftdc_skip_to_arg_value( arg );
+			last_option_value_valid = ( output_path != NULL && output_path[ 0 ] != '\0' );
+			if ( !last_option_value_valid ) {
+				FTDC_WARN( "Option '%s' did not specify file path, ignoring it.", arg );
+				FTDC_PRINT( " Correct usage: `--output=PATH`.\n" );
+				output_path = NULL;
+			}
+		} else if ( strncmp( arg, "--checkpoint-every", 18 ) == 0 ) {
+			uint64_t value;
+			last_option_value_valid = ftdc_parse_option_uint64( arg, &value );
+			if ( last_option_value_valid )  checkpoint_every = ( value == 0 ) ? 1 : value;
+		} else if ( strncmp( arg, "--checkpoint", 12 ) == 0 || strncmp( arg, "--resume", 8 ) == 0 ) {
+			char **path = ( arg[ 2 ] == 'c' ) ? &checkpoint_path : &resume_path;
+			*path = ftdc_skip_to_arg_value( arg );
+			last_option_value_valid = ( *path != NULL && ( *path )[ 0 ] != '\0' );
+			if ( !last_option_value_valid ) {
+				FTDC_WARN( "Option '%s' did not specify file path, ignoring it.", arg );
+				FTDC_PRINT( " Correct usage: `--checkpoint=PATH`, `--resume=PATH`.\n" );
+				*path = NULL;
+			}
+		} else if ( strncmp( arg, "--alloc", 7 ) == 0 ) {
+			static const char *alloc_names[] = { "malloc", "arena", "mmap", "mmap-prefault" };
+			char *value_str = ftdc_skip_to_arg_value( arg );
+			last_option_value_valid = false;
+			for ( int i = 0; i < 4 && value_str != NULL; i += 1 ) {
+				if ( strcmp( value_str, alloc_names[ i ] ) != 0 )  continue;
+				alloc_config.kind = ( i == 3 ) ? FTDC_ALLOC_MMAP : ( ftdc_alloc_kind )i;
+				alloc_config.prefault = ( i == 3 );
+				last_option_value_valid = true;
+			}
+			if ( !last_option_value_valid ) {
+				FTDC_WARN( "Option '%s' expects `malloc`, `arena`, `mmap` or `mmap-prefault`, ignoring it.\n", arg );
+			}
+		} else if ( strncmp( arg, "--histogram", 11 ) == 0 ) {
+			char *value_str = ftdc_skip_to_arg_value( arg );
+			last_option_value_valid = ( value_str == NULL || strcmp( value_str, "pairs" ) == 0 );
+			if ( last_option_value_valid ) {
+				histogram = true;
+				histogram_pairs = ( value_str != NULL );
 			} else {
-				uint64_t value = strtoull( value_str, NULL, 10 );  // Parse argument value
-				if ( value == 0 && strcmp( value_str, "0" ) != 0 ) {
-					FTDC_WARN( "Specified value '%s' in option '%s' is not valid, ignoring it.", value_str, arg );
-					FTDC_PRINT( " Correct usage: `--option=value`.\n", NULL );
-					last_option_value_valid = false;
-				} else {
-					dec_frac_digits_max = value;
-					last_option_value_valid = true;
-					FTDC_PRINT( "Set fractional pricision digits to %llu.\n", value );
-				}
+				FTDC_WARN( "Option '%s' expects no value or `pairs`, ignoring it.\n", arg );
+			}
+		} else if ( strncmp( arg, "--find", 6 ) == 0 ) {
+			find_patterns = ftdc_skip_to_arg_value( arg );
+			last_option_value_valid = ( find_patterns != NULL && find_patterns[ 0 ] != '\0' );
+			if ( !last_option_value_valid ) {
+				FTDC_WARN( "Option '%s' did not specify patterns, ignoring it.", arg );
+				FTDC_PRINT( " Correct usage: `--find=PATTERN[,PATTERN...]`.\n" );
+				find_patterns = NULL;
+			}
+		} else if ( strncmp( arg, "--serve", 7 ) == 0 ) {
+			serve_path = ftdc_skip_to_arg_value( arg );
+			last_option_value_valid = ( serve_path != NULL && serve_path[ 0 ] != '\0' );
+			if ( !last_option_value_valid ) {
+				FTDC_WARN( "Option '%s' did not specify socket path, ignoring it.", arg );
+				FTDC_PRINT( " Correct usage: `--serve=PATH`.\n" );
+				serve_path = NULL;
+			}
+		} else if ( strncmp( arg, "--base", 6 ) == 0 ) {
+			uint64_t value;
+			last_option_value_valid = ftdc_parse_option_uint64( arg, &value );
+			if ( last_option_value_valid && ( value < FTDC_BASE_MIN || value > FTDC_BASE_MAX ) ) {
+				FTDC_WARN( "Base in option '%s' is not from %d to %d, ignoring it.\n", arg, FTDC_BASE_MIN, FTDC_BASE_MAX );
+				last_option_value_valid = false;
+			} else if ( last_option_value_valid ) {
+				options.base = ( int )value;
+				FTDC_PRINT( "Set base of digits to %d.\n", options.base );
 			}
+		} else if ( strcmp( arg, "-R" ) == 0 || strcmp( arg, "--repeating" ) == 0 ) {
+			options.repeating = true;
+			last_option_value_valid = true;
+		} else if ( strcmp( arg, "--stats" ) == 0 ) {
+			options.stats = &stats;
+			last_option_value_valid = true;
 		} else if ( strcmp( arg, "--" ) == 0 ) {
 			break;
 		} else {
 			FTDC_WARN( "Unknown option '%s', ignoring it.", arg );
 			if ( arg[ 0 ] != '-' )  {
 				if ( !last_option_value_valid ) {
-					FTDC_PRINT( " Did you mean to provide it as previous option value?\n", NULL );
+					FTDC_PRINT( " Did you mean to provide it as previous option value?\n" );
 				} else {
-					FTDC_PRINT( " Did you forget to end option argument list with '--'?\n", NULL );
+					FTDC_PRINT( " Did you forget to end option argument list with '--'?\n" );
 				}
 				last_option_value_valid = true;
 			} else {
-				FTDC_PRINT( "\n", NULL );
+				FTDC_PRINT( "\n" );
 			}
 		}
 
 	} while ( arg_cursor < arguments_count - 1 );
 
+	ftdc_alloc_configure( &alloc_config );  // Nothing is allocated before here.
+
+	if ( ( checkpoint_path != NULL || resume_path != NULL ) && ( output_path == NULL || batch || serve_path != NULL ) ) {
+		// Checkpoint vouches for digits already on disk, there are none to check without an output file.
+		FTDC_WARN( "Options '--checkpoint' and '--resume' are only supported with '--output', ignoring them.\n" );
+		checkpoint_path = NULL;
+		resume_path = NULL;
+	}
+	if ( checkpoint_path == NULL )  checkpoint_path = resume_path;
+
+	if ( serve_path != NULL ) {
+#if defined( __linux__ )
+		if ( batch || stream_output || output_path != NULL ) {
+			FTDC_WARN( "Options '--batch', '--stream' and '--output' are not supported with '--serve', ignoring them.\n" );
+		}
+		// Same as batch:  short conversions cost about as much as reading the clock.
+		stats.sample_shift = FTDC_BATCH_STATS_SAMPLE_SHIFT;
+		ftdc_run_serve( serve_path, &options, threads_given ? options.threads_count : ftdc_cpu_count(), cache_capacity );
+		if ( options.stats != NULL )  ftdc_print_stats( options.stats );
+		return 0;
+#else
+		FTDC_ERROR( -16, "Option '--serve' is only supported on Linux.\n" );
+#endif
+	}
+
+	if ( batch ) {
+		if ( output_path != NULL ) {
+			FTDC_WARN( "Option '--output' is not supported in batch mode, ignoring it.\n" );
+		}
+		// Fractions come from input, user arguments are not needed.
+		FILE *input = stdin;
+		if ( batch_path != NULL ) {
+			input = fopen( batch_path, "rb" );
+			if ( input == NULL ) {
+				FTDC_ERROR( -13, "Could not open batch input file '%s'.\n", batch_path );
+			}
+		}
+		// Short conversions cost about as much as reading the clock:  time only some of them.
+		stats.sample_shift = FTDC_BATCH_STATS_SAMPLE_SHIFT;
+		ftdc_cache *cache = NULL;
+		if ( cache_capacity > 0 ) {
+			cache = ftdc_cache_create( ( uint32_t )cache_capacity, FTDC_CACHE_REPETEND_DIGITS_MAX );
+			if ( cache == NULL ) {
+				FTDC_ERROR( -9, "Could not allocate memory for cache of %llu denominators.",
+					( unsigned long long )cache_capacity );
+			}
+		}
+		ftdc_run_batch( input, batch_csv, &options, cache );
+		ftdc_cache_destroy( cache );
+		if ( input != stdin )  fclose( input );
+		if ( options.stats != NULL )  ftdc_print_stats( options.stats );
+		return 0;
+	}
+
 	if ( strcmp( arg, "--" ) != 0 ) {
-		FTDC_ERROR( -1, "Argument list is not closed with '--'.\n", NULL );
+		FTDC_ERROR( -1, "Argument list is not closed with '--'.\n" );
 	}
 
 	arg_cursor += 1;
@@ -202,11 +1415,11 @@ int main( int arguments_count, char *arguments[] ) {
 
 	int user_arguments_count = arguments_count - arg_cursor;
 	if ( user_arguments_count < 1 ) {
-		FTDC_ERROR( -2, "No user arguments provided. Expected: <numerator> <denominator>.", NULL );
+		FTDC_ERROR( -2, "No user arguments provided. Expected: <numerator> <denominator>." );
 	} else if ( user_arguments_count == 1 ) {
-		FTDC_ERROR( -3, "Only <numerator> user argument provided. Expected: <numerator> <denominator>.", NULL );
+		FTDC_ERROR( -3, "Only <numerator> user argument provided. Expected: <numerator> <denominator>." );
 	} else if ( user_arguments_count > 2 ) {
-		FTDC_ERROR( -4, "Too many user arguments provided. Expected: <numerator> <denominator>.", NULL );
+		FTDC_ERROR( -4, "Too many user arguments provided. Expected: <numerator> <denominator>." );
 	}
 
 	char *arg_numerator = arguments[ arg_cursor ];
@@ -215,144 +1428,178 @@ int main( int arguments_count, char *arguments[] ) {
 	arg_cursor += 1;
 	/* Numerator 0 is valid.  0 / 1 = 0.
 	if ( arg_numerator[ 0 ] == '0' ) {
-		FTDC_ERROR( -5, "Numerator cannot be 0.", NULL );ś
+		FTDC_ERROR( -5, "Numerator cannot be 0." );ś
 	}
 	*/
 	if ( arg_denominator[ 0 ] == '0' ) {
-		FTDC_ERROR( -6, "Denominator cannot be 0.", NULL );
+		FTDC_ERROR( -6, "Denominator cannot be 0." );
 	}
 	
 	// Fraction number from input
+	errno = 0;
 	uint64_t given_frac_num = strtoull( arg_numerator, NULL, 10 );
+	bool numerator_big = ( errno == ERANGE );  // Above 64 bits.
 	if ( given_frac_num == 0 && arg_numerator[ 0 ] != '0' ) {
 		FTDC_ERROR( -7, "Numerator '%s' is not a valid integer number.", arg_numerator );
 	}
 
 	// Fraction denominator from input
+	errno = 0;
 	uint64_t given_frac_denom = strtoull( arg_denominator, NULL, 10 );
+	bool denominator_big = ( errno == ERANGE );
 	if ( given_frac_denom == 0 ) {
 		FTDC_ERROR( -8, "Denominator '%s' is not a valid integer number.\n", arg_denominator );
 	}
 
-	// Copy values to keep given fraction for result print.
-	uint64_t frac_num = given_frac_num;
-	uint64_t frac_denom = given_frac_denom;
+	if ( options.repeating && options.offset > 1 ) {
+		FTDC_WARN( "Option '--repeating' cannot be combined with '--offset', ignoring it.\n" );
+		options.repeating = false;
+	}
+
+	if ( options.base == 10 )  options.base = 0;
+	if ( options.base != 0 && ( numerator_big || denominator_big || find_patterns != NULL || histogram || checkpoint_path != NULL ) ) {
+		// Those only know decimal digits.
+		FTDC_WARN( "Option '--base' is not supported with '--find', '--histogram', '--checkpoint' and numbers above 64 bits,"
+			" ignoring it.\n" );
+		options.base = 0;
+	}
+
+	if ( numerator_big || denominator_big ) {
+		if ( stream_output ) {
+			FTDC_WARN( "Option '--stream' is not supported for numbers above 64 bits, ignoring it.\n" );
+		}
+		if ( checkpoint_path != NULL ) {
+			FTDC_WARN( "Options '--checkpoint' and '--resume' are not supported for numbers above 64 bits, ignoring them.\n" );
+		}
+		if ( find_patterns != NULL || histogram ) {
+			FTDC_WARN( "Options '--find' and '--histogram' are not supported for numbers above 64 bits, ignoring them.\n" );
+		}
+		ftdc_run_big( arg_numerator, arg_denominator, &options, output_path );
+		if ( options.stats != NULL )  ftdc_print_stats( options.stats );
+		return 0;
+	}
 
-	uint64_t dec_int = 0; // Decimal integer part:  [123].456
+	uint64_t phase_start = stats.start_ticks;
+	ftdc_stats_phase( options.stats, FTDC_PHASE_PARSE, &phase_start );
 
-	/* 1. Simplify fraction */
+	if ( find_patterns != NULL ) {
+		// Digits are searched as they are computed, none of them are printed.
+		if ( stream_output || output_path != NULL || options.repeating ) {
+			FTDC_WARN( "Options '--stream', '--output' and '--repeating' are not used with '--find', ignoring them.\n" );
+		}
+		if ( !precision_given )  options.precision = UINT64_MAX;
+		FTDC_PRINT( "Given:  %llu / %llu\n", ( unsigned long long )given_frac_num, ( unsigned long long )given_frac_denom );
+		ftdc_run_find( given_frac_num, given_frac_denom, find_patterns, &options );
+		if ( options.stats != NULL )  ftdc_print_stats( options.stats );
+		return 0;
+	}
 
-	//  13 / 5  ->  13 / 5 
-	//  15 / 5  ->   3 / 1
-	//  5 / 15  ->   1 / 3
-	if ( frac_num % frac_denom == 0 ) {
-		// Greatest common divisor
-		uint64_t divisor = ftdc_GCD( frac_num, frac_denom );
-		frac_num /= divisor;
-		frac_denom /= divisor;
+	if ( histogram ) {
+		if ( stream_output || output_path != NULL || options.repeating ) {
+			FTDC_WARN( "Options '--stream', '--output' and '--repeating' are not used with '--histogram', ignoring them.\n" );
+		}
+		FTDC_PRINT( "Given:  %llu / %llu\n", ( unsigned long long )given_frac_num, ( unsigned long long )given_frac_denom );
+		ftdc_run_histogram( given_frac_num, given_frac_denom, histogram_pairs, &options );
+		if ( options.stats != NULL )  ftdc_print_stats( options.stats );
+		return 0;
 	}
 
-	FTDC_TRACE( "1. Simplify:  %llu / %llu  ->  %llu / %llu",
-		given_frac_num, given_frac_denom,
-		frac_num, frac_denom );
-	
-	/* 2. Extract integer part */
+	// Measure first:  fills everything but digits, and the exact output length.
+	ftdc_result result;
+	ftdc_convert_ex( given_frac_num, given_frac_denom, &options, NULL, 0, &result );
+	if ( options.repeating && !result.repeating && result.fraction_numerator != 0 ) {
+		FTDC_WARN( "Period of %llu digits (after %llu non-repeating) does not fit into %llu digits of precision,"
+			" printing them without period notation.\n",
+			( unsigned long long )result.period.period, ( unsigned long long )result.period.pre_period,
+			( unsigned long long )options.precision );
+	}
 
-	// 13 / 5  ->  2  +  3 / 5 
-	//  3 / 1  ->  3  +  0 / 1
-	//  1 / 3  ->  1 / 3
-	{
-		uint64_t div_fraction = frac_num % frac_denom;  // Division fraction (after simplification)
-		if ( div_fraction == 0 ) {
-			//  3 / 1  ->  3  +  0 / 1
-			dec_int = frac_num;
-			frac_num = 0;
-		} else if ( div_fraction > 0 ) {
-			// 13 / 5  ->  2  +  3 / 5 
-			dec_int = ( frac_num - div_fraction ) / frac_denom;
-			frac_num = div_fraction; 
+	if ( output_path != NULL ) {
+		// Decimal string goes into the file, followed by '\n' in place of '\0'.  The file is sized exactly
+		//   and mapped, so digits are computed straight into the page cache, without copies through stdio.
+		FTDC_PRINT(
+			"Given:  %llu / %llu\n"
+			"Simplified:  %llu / %llu\n",
+			( unsigned long long )given_frac_num, ( unsigned long long )given_frac_denom,
+			( unsigned long long )result.numerator, ( unsigned long long )result.denominator );
+		logger_flush();
+
+		if ( checkpoint_path != NULL ) {
+			ftdc_run_checkpointed( &options, &result, output_path, checkpoint_path, checkpoint_every, resume_path );
+		} else {
+			ftdc_mapping mapping;
+			ftdc_mapping_create( &mapping, output_path, result.length + 1, false );
+			ftdc_convert_ex( given_frac_num, given_frac_denom, &options, mapping.data, mapping.size, &result );
+			mapping.data[ result.length ] = '\n';
+			if ( options.stats != NULL )  phase_start = ftdc_ticks();
+			ftdc_mapping_close( &mapping );
+			ftdc_stats_output( options.stats, result.length + 1, &phase_start );
 		}
+
+		FTDC_PRINT( "Result:  written %zu bytes to '%s'  ( %llu  +  %llu / %llu )\n",
+			result.length + 1, output_path,
+			( unsigned long long )result.integer, ( unsigned long long )result.fraction_numerator,
+			( unsigned long long )result.denominator );
+		if ( options.stats != NULL )  ftdc_print_stats( options.stats );
+		return 0;
 	}
-	uint64_t simpled_num = frac_num; // Copy to keep for result print.
 
-	FTDC_TRACE( "2. Extract integer:  %llu / %llu  ->  %llu  +  %llu / %llu",
-		frac_num + ( dec_int * frac_denom ), frac_denom,
-		dec_int, frac_num, frac_denom );
+	if ( stream_output ) {
+		// Same output, but digits leave through a fixed-size buffer as soon as it fills up.
+		FTDC_PRINT(
+			"Given:  %llu / %llu\n"
+			"Simplified:  %llu / %llu\n"
+			"Result:  ",
+			( unsigned long long )given_frac_num, ( unsigned long long )given_frac_denom,
+			( unsigned long long )result.numerator, ( unsigned long long )result.denominator );
+		logger_flush();  // Keep order with unbuffered writes below.
+
+		ftdc_writer writer = { .fd = 1 /* stdout */, .size = FTDC_STREAM_BUFFER_SIZE, .used = 0, .stats = options.stats };
+		writer.buffer = FTDC_ALLOC( writer.size, char );
+		if ( writer.buffer == NULL ) {
+			FTDC_ERROR( -9, "Could not allocate %zu bytes of memory for output buffer.", writer.size );
+		}
+
+		ftdc_writer_put_decimal( &writer, result.integer, result.fraction_numerator, result.denominator,
+			options.precision, options.offset, result.repeating ? &result.period : NULL, options.base, options.threads_count );
+
+		char *out = ftdc_writer_reserve( &writer, 128 );
+		writer.used += snprintf( out, 128, "  ( %llu  +  %llu / %llu )\n", ( unsigned long long )result.integer,
+			( unsigned long long )result.fraction_numerator, ( unsigned long long )result.denominator );
+		ftdc_writer_flush( &writer );
+		FTDC_FREE( writer.buffer );
+		if ( options.stats != NULL )  ftdc_print_stats( options.stats );
+		return 0;
+	}
 
-	size_t decimal_str_size = ( INT64_MAX_DIGITS + 1 /* '.' */ + dec_frac_digits_max + 1 /* '\n' */ );
+	size_t decimal_str_size = result.length + 1 /* '\0' */;
 	if ( decimal_str_size > ( 1llu << 30 ) )
 		FTDC_WARN( "Trying to allocate more than 1GB (2^30) memory for decimal string of %llu fractional digits.\n",
-			dec_frac_digits_max );
+			( unsigned long long )options.precision );
 
 	// Allocate string buffer on heap for decimal notation number string representation.
 	char *decimal_str = FTDC_ALLOC( decimal_str_size, char );
 	if ( decimal_str == NULL ) {
 		FTDC_ERROR( -9, "Could not allocate %zu bytes of memory for decimal string of %llu fractional digits.",
-			decimal_str_size, dec_frac_digits_max );
+			decimal_str_size, ( unsigned long long )options.precision );
 	}
 
-	int cursor = 0;
-	cursor += ftdc_append_uint64( decimal_str, decimal_str_size, cursor, dec_int, 0 );  // Append integer part
+	ftdc_convert_ex( given_frac_num, given_frac_denom, &options, decimal_str, decimal_str_size, &result );
 
-	if ( frac_num == 0 ) {
-		// Given fraction turned out to be an integer decimal number,
-		//   no need to compute fractional part.  Jump to end.
-		FTDC_TRACE( "No fraction part, jump to end.", NULL );
-		goto end;
-	}
-	
-	/* 3. Compute fractional part */
-
-	FTDC_TRACE( "3. Compute fractional part of:  %llu / %llu", frac_num, frac_denom );
-
-	cursor += ftdc_append_char( decimal_str, decimal_str_size, cursor, '.' );  // Append fractional part separator
-
-	uint64_t remainder;
-	uint64_t dec_frac_digits = 0; // Number of digits in fractional part:  123.[456] -> 3
-	char digit;
-	while ( dec_frac_digits < dec_frac_digits_max ) {
-		dec_frac_digits += 1;
-
-		// In short: Advance to the next order of magnitude.
-		//   Try to imagine it like this:  1 / 10     ->  1 / 100
-		//                                  0.4[2]85  ->   0.42[8]5
-		// Arithmetically, on example of 3 / 7 (frac_num=3, frac_denom=7):
-		//
-		//  3 \ * 10     30     28    2     4 * 7 \ : 7    2      4     2            2
-		//  -         =  --  =  -- + --  =  -----       + --  =  -- +  --  =  0.4 + --
-		//  7            70     70   70       70          70     10    70           70
-		frac_num *= 10;
-		remainder = frac_num % frac_denom;
-		digit = ( frac_num - remainder ) / frac_denom;
-		FTDC_TRACE( "[%llu]  ( %llu + %llu ) / %llu  ->  %d",
-			dec_frac_digits,
-			frac_num - remainder, remainder, frac_denom, digit );
-
-		cursor += ftdc_append_digit( decimal_str, decimal_str_size, cursor, digit );  // Append fractional digit
-		
-		if ( remainder == 0 ) {
-			// Fraction numerator is evenly divisable by denominator,
-			//   no more fractions left.
-			FTDC_TRACE( "No more fractions left to compute, exit loop.", NULL );
-			break;
-		}
-		frac_num = remainder;
-	};
-
-end:
-	cursor += ftdc_append_char( decimal_str, decimal_str_size, cursor, '\0' );  // Null-terminate
-
-	uint64_t unified_num = ( dec_int * frac_denom ) + simpled_num;
+	if ( options.stats != NULL )  phase_start = ftdc_ticks();
 	FTDC_PRINT(
 		"Given:  %llu / %llu\n"
 		"Simplified:  %llu / %llu\n"
 		"Result:  %s  ( %llu  +  %llu / %llu )\n",
-		given_frac_num, given_frac_denom,
-		unified_num, frac_denom,
-		decimal_str, dec_int, simpled_num, frac_denom
+		( unsigned long long )given_frac_num, ( unsigned long long )given_frac_denom,
+		( unsigned long long )result.numerator, ( unsigned long long )result.denominator,
+		decimal_str, ( unsigned long long )result.integer, ( unsigned long long )result.fraction_numerator,
+		( unsigned long long )result.denominator
 	);
+	ftdc_stats_output( options.stats, result.length, &phase_start );
 
 	FTDC_FREE( decimal_str );
+	if ( options.stats != NULL )  ftdc_print_stats( options.stats );
 
 	return 0;
-}
\ No newline at end of file
+}
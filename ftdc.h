@@ -0,0 +1,3236 @@
+// ftdc.h  --  (F)raction (T)o (D)ecimal (C)onverter library.
+//
+// Single-header library behind the `ftdc` command line tool.  Conversion never allocates
+//   (except for `ftdc_cache` entries on misses) and never exits, errors are returned as `ftdc_status` codes.
+//
+// Include it anywhere for declarations, and in exactly one C file define implementation:
+//   #define FTDC_IMPLEMENTATION
+//   #include "ftdc.h"
+//
+// Needs `logger.h` next to it:  `FTDC_TRACE`, and output of the tools built on it, go through its asynchronous logger.
+//
+// Build:  `cc -O2 -pthread -o ftdc ftdc.c`
+// With the compiled-in table of small-denominator expansions, two steps (`ftdc_table.h` is generated, not committed):
+//   `cc -O2 -pthread -o ftdc_table_gen ftdc_table_gen.c && ./ftdc_table_gen > ftdc_table.h`
+//   `cc -O2 -pthread -DFTDC_TABLE -o ftdc ftdc.c`
+// Rerun the first step whenever `ftdc_table_gen` or the table layout changes, a table of another version does not compile.
+//
+// Usage:
+//   ftdc_detect_cpu();  // Once, picks SIMD digit conversion.
+//   char out[ 128 ];
+//   ftdc_result result;
+//   if ( ftdc_convert( 22, 7, 50, out, sizeof( out ), &result ) == FTDC_OK ) { ... }
+
+#ifndef FTDC_H
+#define FTDC_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+
+// How many decimal digits a 64-bit (2 ^ 64) integer (`uint64_t`) can hold.
+#define INT64_MAX_DIGITS 20
+
+// Number of fractional digits computed by a single long-division step.
+// 10^19 is the largest power of ten that fits into `uint64_t`, so both
+//   `remainder * 10^19` (128-bit) and its quotient by the denominator never overflow.
+#define FTDC_CHUNK_DIGITS 19
+
+// Most threads a single conversion is split across.
+#define FTDC_THREADS_MAX 256
+
+typedef unsigned __int128 ftdc_u128;
+
+#ifndef FTDC_CUSTOM_BOOL
+enum bool_e {
+	false = 0,
+	true
+};
+typedef uint8_t bool;
+#endif
+
+// Allocations go through `ftdc_alloc`, backed by malloc, an arena or huge-page mappings (see `ftdc_alloc_configure`).
+// Define all three to use your own allocator instead.
+#ifndef FTDC_ALLOC
+#define FTDC_ALLOC( count, type ) \
+	ftdc_alloc( ( count ) * sizeof( type ) )
+#define FTDC_REALLOC( pointer, old_size, new_size, type ) \
+	ftdc_realloc( pointer, ( old_size ) * sizeof( type ), ( new_size ) * sizeof( type ) )
+#define FTDC_FREE( pointer ) \
+	ftdc_free( pointer )
+#endif
+
+typedef enum ftdc_alloc_kind {
+	FTDC_ALLOC_MALLOC = 0,
+	FTDC_ALLOC_ARENA,  // Bump allocation from one reservation, for many allocations freed together at exit:  batch runs.
+	FTDC_ALLOC_MMAP    // Own mapping, with transparent huge pages, for each allocation above `mmap_threshold`:  big expansions.
+} ftdc_alloc_kind;
+
+// Defaults of `ftdc_alloc_config`.
+#define FTDC_ALLOC_ARENA_SIZE_DEFAULT     ( 1llu << 30 )
+#define FTDC_ALLOC_MMAP_THRESHOLD_DEFAULT ( 1llu << 21 )
+
+typedef struct ftdc_alloc_config {
+	ftdc_alloc_kind kind;
+	size_t          arena_size;      // Address space the arena reserves up front.  Allocations past it fall back to malloc.
+	size_t          mmap_threshold;  // Smaller allocations go to malloc.
+	bool            prefault;        // Fault mapped pages in on allocation, instead of on first write.
+} ftdc_alloc_config;
+
+typedef struct ftdc_alloc_stats {
+	uint64_t allocations;
+	uint64_t reserved;        // Address space taken so far:  arena reservation, mappings and malloc'ed blocks.
+	uint64_t committed;       // Bytes allocated and not freed yet.
+	uint64_t committed_peak;
+	uint64_t faulted;         // Bytes of arena and mappings (freed ones too) backed by memory.  Malloc'ed blocks are not known.
+	uint64_t prefaulted;      // Bytes faulted in by `prefault`.
+} ftdc_alloc_stats;
+
+#ifndef FTDC_DEBUG
+	#define FTDC_DEBUG 0
+#endif
+
+// Output goes through the asynchronous `logger.h`, traces are compiled in with `FTDC_DEBUG` only.
+#if FTDC_DEBUG && !defined( LOGGER_LEVEL_MIN )
+	#define LOGGER_LEVEL_MIN LOGGER_LEVEL_TRACE
+#endif
+#include "logger.h"
+
+#define FTDC_TRACE( format, ... ) \
+	LOGGER_TRACE( stdout, "TRACE: ", 7, format "\n", ##__VA_ARGS__ )
+
+typedef enum ftdc_status {
+	FTDC_OK = 0,
+	FTDC_ERR_INVALID_ARGUMENT,   // NULL `options` or `result`, base out of range, or not a decimal number.
+	FTDC_ERR_DENOMINATOR_ZERO,
+	FTDC_ERR_BUFFER_TOO_SMALL,   // `result->length + 1` bytes are needed.
+	FTDC_ERR_TOO_LARGE,          // Operand does not fit into `FTDC_BIG_LIMBS_MAX` limbs.
+	FTDC_ERR_OUT_OF_MEMORY
+} ftdc_status;
+
+typedef struct ftdc_period {
+	uint64_t pre_period;  // Non-repeating fractional digits:  1 / 6  =  0.1(6)  ->  1
+	uint64_t period;      // Repeating fractional digits, 0 if fraction terminates:  1 / 6  ->  1
+} ftdc_period;
+
+// Digit counts of a range of fractional digits, see `ftdc_histogram_digits`.
+typedef struct ftdc_histogram {
+	uint64_t    digits[ 10 ];
+	uint64_t    pairs[ 100 ];  // Adjacent digits:  `pairs[ 10 * a + b ]` counts `ab`.  Only if asked for.
+	uint64_t    count;         // Digits counted.
+	uint64_t    computed;      // Digits actually computed, the rest are counted from copies of the period.
+	ftdc_period period;        // Of the fraction after integer extraction.
+} ftdc_histogram;
+
+// Most patterns `ftdc_find` searches for at once, and their longest length.
+#define FTDC_FIND_PATTERNS_MAX 16
+#define FTDC_FIND_PATTERN_DIGITS_MAX 1024
+
+typedef struct ftdc_find_result {
+	uint64_t    positions[ FTDC_FIND_PATTERNS_MAX ];  // 1-based digit each pattern first starts at, 0 if not found.
+	uint64_t    searched;   // Fractional digits searched, from `options->offset` on.
+	ftdc_period period;     // Of the fraction after integer extraction.
+	bool        exhausted;  // Every digit a match could start at was searched:  patterns not found never appear.
+} ftdc_find_result;
+
+// Precomputed reciprocal of an invariant divisor, see `ftdc_divider_init`.
+typedef struct ftdc_divider {
+	uint64_t divisor;
+	uint64_t normalized;  // divisor << shift, top bit set.
+	uint64_t reciprocal;  // floor( ( 2^128 - 1 ) / normalized ) - 2^64
+	int      shift;
+} ftdc_divider;
+
+// Phases of a run timed by `ftdc_stats`.  Conversions time simplify, integer, format and fraction,
+//   parse and output are up to the caller.
+typedef enum ftdc_phase {
+	FTDC_PHASE_PARSE = 0,
+	FTDC_PHASE_SIMPLIFY,
+	FTDC_PHASE_INTEGER,
+	FTDC_PHASE_FORMAT,    // Sizing output (including period search), integer part and punctuation.
+	FTDC_PHASE_FRACTION,
+	FTDC_PHASE_OUTPUT,
+	FTDC_PHASE_COUNT
+} ftdc_phase;
+
+// Phase timings and hot-path counters, added to by conversions given it in `ftdc_options`.
+// Updated a few times per conversion, never per digit:  cheap enough to leave on.  Not thread-safe.
+// Counters count every conversion, but only one in `2^sample_shift` of them is timed (output is always timed),
+//   as reading the clock costs about as much as a short conversion.
+typedef struct ftdc_stats {
+	uint64_t ticks[ FTDC_PHASE_COUNT ];  // In `ftdc_ticks` units, see `ftdc_stats_ns_per_tick`.
+	uint32_t sample_shift;               // 0 to time every conversion.
+	uint64_t conversions;
+	uint64_t digits;          // Fractional digits computed.
+	uint64_t divisions;       // Long-division steps by the denominator, one per up to 19 digits.
+	uint64_t seeks;           // Jumps to a digit position by modular exponentiation.
+	uint64_t bytes_written;   // Counted by the caller.
+	uint64_t start_ticks;     // Set by `ftdc_stats_start`.
+	uint64_t start_ns;
+	uint64_t tick_cost;       // Ticks it takes to read ticks, taken out of every timed phase.
+} ftdc_stats;
+
+// Bases digits can be written in, see `ftdc_options`.
+#define FTDC_BASE_MIN 2
+#define FTDC_BASE_MAX 36
+
+typedef struct ftdc_options {
+	uint64_t    precision;      // Max number of fractional digits.
+	uint64_t    offset;         // 1-based position of the first fractional digit, 0 is the same as 1.
+	bool        repeating;      // Stop after one period, enclosed in parentheses, if it fits into precision.  Needs no offset.
+	int         threads_count;  // Threads to split fractional digits across, 0 or 1 to use only the calling one.
+	ftdc_stats *stats;          // Timings and counters to add to, NULL for none.
+	int         base;           // Of integer and fractional digits, `FTDC_BASE_MIN` to `FTDC_BASE_MAX`, 0 is the same as 10.
+	                            //   Digits above 9 are lowercase letters.  Find, histogram and big operands are decimal only.
+} ftdc_options;
+
+typedef struct ftdc_result {
+	uint64_t    integer;             // Integer part:  [3].142857
+	uint64_t    numerator;           // Simplified fraction:  22 / 7
+	uint64_t    denominator;
+	uint64_t    fraction_numerator;  // Numerator left after integer part:  3  +  [1] / 7
+	uint64_t    digits;              // Fractional digits written.
+	size_t      length;              // Chars written (or needed) excluding '\0'.
+	ftdc_period period;              // Filled when `options->repeating` is set.
+	bool        repeating;           // Period notation was used.
+} ftdc_result;
+
+// What a cache keeps per (reduced) denominator.  Everything but the numerator's contribution.
+typedef struct ftdc_cache_entry {
+	uint64_t     denominator;    // Reduced denominator, the key.
+	uint64_t     stripped;       // Denominator without factors of 2 and 5:  2^a * 5^b * m  ->  m
+	ftdc_divider divider;        // Reciprocal of the denominator.
+	ftdc_period  period;         // Of any fraction over this denominator.  Period is found on first use.
+	bool         period_found;
+	uint64_t    *repetend;       // Repetend of 1 / m in 10^19 base limbs, least significant first.  NULL if too long.
+	uint32_t     hash_next;      // Next entry in the same hash bucket.
+	uint32_t     lru_prev;       // Towards the most recently used entry.
+	uint32_t     lru_next;       // Towards the least recently used entry.
+} ftdc_cache_entry;
+
+// Bounded per-denominator cache with LRU eviction, for converting many fractions over repeated denominators.
+// Not thread-safe, use one per thread.
+typedef struct ftdc_cache {
+	ftdc_cache_entry *entries;
+	uint32_t         *buckets;               // Hash table of entry indices.
+	uint32_t          buckets_mask;
+	uint32_t          capacity;
+	uint32_t          count;
+	uint32_t          lru_head;              // Most recently used.
+	uint32_t          lru_tail;              // Least recently used, evicted first.
+	uint64_t          repetend_digits_max;   // Longer repetends are not kept.
+	char             *scratch;               // One repetend of digits, to build repetends in.
+	uint64_t          hits;
+	uint64_t          misses;
+	uint64_t          evictions;
+} ftdc_cache;
+
+// Most 64-bit limbs of an arbitrary-precision operand:  64 * 64  =  4096 bits.
+#define FTDC_BIG_LIMBS_MAX 64
+// Decimal digits of the largest operand:  2^4096 - 1  has 1234 of them.
+#define FTDC_BIG_DIGITS_MAX 1234
+// Limbs `ftdc_big` has room for:  product of two operands and a carry limb for normalization.
+#define FTDC_BIG_CAPACITY ( 2 * FTDC_BIG_LIMBS_MAX + 2 )
+
+// Arbitrary-precision unsigned integer, for operands above 64 bits.  Fixed-size, so it never allocates.
+typedef struct ftdc_big {
+	int      count;                        // Limbs in use, 0 for zero.  The top one is never 0.
+	uint64_t limbs[ FTDC_BIG_CAPACITY ];  // Least significant first.
+} ftdc_big;
+
+// Same as `ftdc_result`, but for `ftdc_convert_big`.
+typedef struct ftdc_big_result {
+	ftdc_big    integer;
+	ftdc_big    numerator;           // Simplified fraction.
+	ftdc_big    denominator;
+	ftdc_big    fraction_numerator;
+	uint64_t    digits;
+	size_t      length;
+	ftdc_period period;              // Period is 0 if it is not known, see `period_unknown`.
+	bool        repeating;
+	bool        period_unknown;      // Denominator is still above 64 bits without factors of 2 and 5, its period is not searched.
+} ftdc_big_result;
+
+void ftdc_alloc_configure( const ftdc_alloc_config *config );
+void *ftdc_alloc( size_t size );
+void *ftdc_realloc( void *pointer, size_t old_size, size_t new_size );
+void ftdc_free( void *pointer );
+void ftdc_alloc_stats_get( ftdc_alloc_stats *stats );
+void ftdc_detect_cpu( void );
+int ftdc_cpu_count( void );
+
+int ftdc_append_char( char *buffer, size_t buffer_size, size_t cursor, char append );
+int ftdc_append_uint64( char *buffer, size_t buffer_size, size_t cursor, uint64_t number, uint64_t magnitude );
+int ftdc_append_uint64_base( char *buffer, size_t buffer_size, size_t cursor, uint64_t number, int base );
+void ftdc_write_chunk( char *out, uint64_t chunk );
+
+uint64_t ftdc_ticks( void );
+uint64_t ftdc_clock_ns( void );
+void ftdc_stats_start( ftdc_stats *stats );
+ftdc_stats *ftdc_stats_timed( ftdc_stats *stats );
+void ftdc_stats_phase( ftdc_stats *stats, ftdc_phase phase, uint64_t *since );
+uint64_t ftdc_stats_phase_ns( const ftdc_stats *stats, ftdc_phase phase, double ns_per_tick );
+void ftdc_stats_count_fraction( ftdc_stats *stats, uint64_t digits, uint64_t seeks );
+double ftdc_stats_ns_per_tick( const ftdc_stats *stats );
+
+uint64_t ftdc_GCD( uint64_t a, uint64_t b );
+ftdc_u128 ftdc_GCD128( ftdc_u128 a, ftdc_u128 b );
+uint64_t ftdc_powmod( uint64_t base, uint64_t exponent, uint64_t m );
+uint64_t ftdc_order( uint64_t base, uint64_t m );
+uint64_t ftdc_order10( uint64_t m );
+void ftdc_simplify( uint64_t *numerator, uint64_t *denominator );
+uint64_t ftdc_extract_integer( uint64_t *numerator, uint64_t denominator );
+ftdc_period ftdc_find_period( uint64_t numerator, uint64_t denominator );
+ftdc_period ftdc_find_period_base( uint64_t numerator, uint64_t denominator, int base );
+bool ftdc_fit_period( uint64_t numerator, uint64_t denominator, uint64_t *digits_max, ftdc_period *period );
+
+uint64_t ftdc_seek_remainder( uint64_t numerator, uint64_t denominator, uint64_t position );
+void ftdc_divider_init( ftdc_divider *divider, uint64_t divisor );
+uint64_t ftdc_fraction_length( uint64_t numerator, uint64_t denominator, uint64_t position, uint64_t count );
+uint64_t ftdc_compute_fraction( char *out, uint64_t count, uint64_t *remainder, uint64_t denominator );
+uint64_t ftdc_compute_fraction_div( char *out, uint64_t count, uint64_t *remainder, const ftdc_divider *divider );
+uint64_t ftdc_compute_fraction_parallel( char *out, uint64_t count, uint64_t numerator, uint64_t denominator,
+	uint64_t position, int threads_count );
+uint64_t ftdc_compute_fraction_counted( char *out, uint64_t count, uint64_t numerator, uint64_t denominator,
+	uint64_t position, int threads_count, ftdc_stats *stats );
+uint64_t ftdc_compute_fraction_base( char *out, uint64_t count, uint64_t numerator, uint64_t denominator,
+	uint64_t position, int base, int threads_count, ftdc_stats *stats );
+
+ftdc_status ftdc_convert( uint64_t numerator, uint64_t denominator, uint64_t precision,
+	char *out, size_t out_size, ftdc_result *result );
+ftdc_status ftdc_convert_ex( uint64_t numerator, uint64_t denominator, const ftdc_options *options,
+	char *out, size_t out_size, ftdc_result *result );
+ftdc_status ftdc_find( uint64_t numerator, uint64_t denominator, const char *const *patterns, int patterns_count,
+	const ftdc_options *options, ftdc_find_result *result );
+ftdc_status ftdc_histogram_digits( uint64_t numerator, uint64_t denominator, const ftdc_options *options, bool pairs,
+	ftdc_histogram *histogram );
+
+ftdc_cache *ftdc_cache_create( uint32_t capacity, uint64_t repetend_digits_max );
+void ftdc_cache_destroy( ftdc_cache *cache );
+const ftdc_cache_entry *ftdc_cache_lookup( ftdc_cache *cache, uint64_t denominator );
+ftdc_status ftdc_convert_cached( ftdc_cache *cache, uint64_t numerator, uint64_t denominator, const ftdc_options *options,
+	char *out, size_t out_size, ftdc_result *result );
+
+ftdc_status ftdc_big_parse( ftdc_big *big, const char *str );
+bool ftdc_big_to_uint64( const ftdc_big *big, uint64_t *value );
+size_t ftdc_big_to_string( char *out, size_t out_size, const ftdc_big *big );
+int ftdc_big_compare( const ftdc_big *a, const ftdc_big *b );
+void ftdc_big_divmod( ftdc_big *quotient, ftdc_big *remainder, const ftdc_big *u, const ftdc_big *v );
+void ftdc_big_gcd( ftdc_big *gcd, const ftdc_big *a, const ftdc_big *b );
+uint64_t ftdc_big_compute_fraction( char *out, uint64_t count, ftdc_big *remainder, const ftdc_big *denominator );
+ftdc_status ftdc_convert_big( const ftdc_big *numerator, const ftdc_big *denominator, const ftdc_options *options,
+	char *out, size_t out_size, ftdc_big_result *result );
+
+#endif /* FTDC_H */
+
+#ifdef FTDC_IMPLEMENTATION
+
+// SIMD digit conversion kernels, picked at runtime by `ftdc_detect_cpu`.
+// Define `FTDC_NO_SIMD` to always use the scalar one.
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) ) && !defined( FTDC_NO_SIMD )
+	#define FTDC_X86_SIMD 1
+	#include <immintrin.h>
+#else
+	#define FTDC_X86_SIMD 0
+#endif
+
+#if defined( _WIN32 )
+	#include <Windows.h>
+#else
+	#include <pthread.h>  // Link with `-pthread`.
+	#include <unistd.h>
+	#include <time.h>
+	#include <sys/mman.h>
+#endif
+
+#define LOGGER_IMPLEMENTATION
+#include "logger.h"
+
+// Appends any char.  Returns chars written, 0 if it does not fit.
+// Chainable:  `cursor = append( buffer, size, cursor, '.' );`
+int ftdc_append_char( char *buffer, size_t buffer_size, size_t cursor, char append ) {
+	if ( cursor + 1 > buffer_size )  return 0;
+	buffer[ cursor ] = append;
+	return 1;
+}
+
+// Powers of ten that fit into `uint64_t`:  10^0 .. 10^19.
+static const uint64_t ftdc_pow10[ INT64_MAX_DIGITS ] = {
+	1llu,
+	10llu,
+	100llu,
+	1000llu,
+	10000llu,
+	100000llu,
+	1000000llu,
+	10000000llu,
+	100000000llu,
+	1000000000llu,
+	10000000000llu,
+	100000000000llu,
+	1000000000000llu,
+	10000000000000llu,
+	100000000000000llu,
+	1000000000000000llu,
+	10000000000000000llu,
+	100000000000000000llu,
+	1000000000000000000llu,
+	10000000000000000000llu
+};
+
+// "00", "01", ... "99" -- two ASCII digits per lookup.
+static const char ftdc_digit_pairs[ 200 + 1 ] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+// Writes exactly 8 digits of `value` (< 10^8), zero-padded.  Not null-terminated.
+static void ftdc_write_8_digits( char *out, uint32_t value ) {
+	uint32_t hi = value / 10000;
+	uint32_t lo = value % 10000;
+	memcpy( out + 0, &ftdc_digit_pairs[ ( hi / 100 ) * 2 ], 2 );
+	memcpy( out + 2, &ftdc_digit_pairs[ ( hi % 100 ) * 2 ], 2 );
+	memcpy( out + 4, &ftdc_digit_pairs[ ( lo / 100 ) * 2 ], 2 );
+	memcpy( out + 6, &ftdc_digit_pairs[ ( lo % 100 ) * 2 ], 2 );
+}
+
+// Writes exactly 16 digits of `value` (< 10^16), zero-padded.  Not null-terminated.
+typedef void ( * PFN_Write16Digits )( char *out, uint64_t value );
+
+static void ftdc_write_16_digits_scalar( char *out, uint64_t value ) {
+	ftdc_write_8_digits( out + 0, ( uint32_t )( value / ftdc_pow10[ 8 ] ) );
+	ftdc_write_8_digits( out + 8, ( uint32_t )( value % ftdc_pow10[ 8 ] ) );
+}
+
+#if FTDC_X86_SIMD
+// Division of every 16-bit lane of `abcd * 4` (4 digit group) by 1000, 100, 10 and 1 as two multiply-highs.
+//   mulhi( mulhi( abcd * 4, div ), shift )  ->  a, ab, abc, abcd
+// Then subtracting each lane's left neighbour times 10 leaves one digit per lane:  a, b, c, d
+#define FTDC_SIMD_DIV_POWERS    8389, 5243, 13108, ( short )0x8000
+#define FTDC_SIMD_SHIFT_POWERS  1 << 7, 1 << 11, 1 << 13, ( short )( 1 << 15 )
+
+// Returns 8 digits of `value` (< 10^8), one per 16-bit lane.
+__attribute__(( target( "sse2" ) ))
+static __m128i ftdc_8_digits_sse2( uint32_t value ) {
+	// abcdefgh  ->  abcd, efgh
+	const __m128i abcdefgh = _mm_cvtsi32_si128( ( int )value );
+	const __m128i abcd = _mm_srli_epi64( _mm_mul_epu32( abcdefgh, _mm_set1_epi32( ( int )0xD1B71759 ) ), 45 );  // / 10000
+	const __m128i efgh = _mm_sub_epi32( abcdefgh, _mm_mul_epu32( abcd, _mm_set1_epi32( 10000 ) ) );
+
+	// [ abcd * 4, abcd * 4, abcd * 4, abcd * 4, efgh * 4, efgh * 4, efgh * 4, efgh * 4 ]
+	const __m128i v1 = _mm_slli_epi64( _mm_unpacklo_epi16( abcd, efgh ), 2 );
+	const __m128i v2 = _mm_unpacklo_epi32( _mm_unpacklo_epi16( v1, v1 ), _mm_unpacklo_epi16( v1, v1 ) );
+
+	// [ a, ab, abc, abcd, e, ef, efg, efgh ]
+	const __m128i v3 = _mm_mulhi_epu16( v2, _mm_setr_epi16( FTDC_SIMD_DIV_POWERS, FTDC_SIMD_DIV_POWERS ) );
+	const __m128i v4 = _mm_mulhi_epu16( v3, _mm_setr_epi16( FTDC_SIMD_SHIFT_POWERS, FTDC_SIMD_SHIFT_POWERS ) );
+
+	// [ a, ab, abc, abcd ] - [ 0, a0, ab0, abc0 ]  ->  [ a, b, c, d ]
+	const __m128i v5 = _mm_slli_epi64( _mm_mullo_epi16( v4, _mm_set1_epi16( 10 ) ), 16 );
+	return _mm_sub_epi16( v4, v5 );
+}
+
+__attribute__(( target( "sse2" ) ))
+static void ftdc_write_16_digits_sse2( char *out, uint64_t value ) {
+	const __m128i hi = ftdc_8_digits_sse2( ( uint32_t )( value / ftdc_pow10[ 8 ] ) );
+	const __m128i lo = ftdc_8_digits_sse2( ( uint32_t )( value % ftdc_pow10[ 8 ] ) );
+	const __m128i digits = _mm_add_epi8( _mm_packus_epi16( hi, lo ), _mm_set1_epi8( '0' ) );
+	_mm_storeu_si128( ( __m128i * )out, digits );
+}
+
+// Same as SSE2 one, but all four 4 digit groups go through a single 256-bit register.
+__attribute__(( target( "avx2" ) ))
+static void ftdc_write_16_digits_avx2( char *out, uint64_t value ) {
+	uint32_t hi = ( uint32_t )( value / ftdc_pow10[ 8 ] );
+	uint32_t lo = ( uint32_t )( value % ftdc_pow10[ 8 ] );
+	short g0 = ( short )( ( hi / 10000 ) * 4 ), g1 = ( short )( ( hi % 10000 ) * 4 );
+	short g2 = ( short )( ( lo / 10000 ) * 4 ), g3 = ( short )( ( lo % 10000 ) * 4 );
+
+	const __m256i v2 = _mm256_setr_epi16( g0, g0, g0, g0, g1, g1, g1, g1, g2, g2, g2, g2, g3, g3, g3, g3 );
+	const __m256i v3 = _mm256_mulhi_epu16( v2, _mm256_setr_epi16(
+		FTDC_SIMD_DIV_POWERS, FTDC_SIMD_DIV_POWERS, FTDC_SIMD_DIV_POWERS, FTDC_SIMD_DIV_POWERS ) );
+	const __m256i v4 = _mm256_mulhi_epu16( v3, _mm256_setr_epi16(
+		FTDC_SIMD_SHIFT_POWERS, FTDC_SIMD_SHIFT_POWERS, FTDC_SIMD_SHIFT_POWERS, FTDC_SIMD_SHIFT_POWERS ) );
+	const __m256i v5 = _mm256_slli_epi64( _mm256_mullo_epi16( v4, _mm256_set1_epi16( 10 ) ), 16 );
+	const __m256i v6 = _mm256_sub_epi16( v4, v5 );
+
+	// Packing works within 128-bit lanes:  [ d0..d7, d0..d7 | d8..d15, d8..d15 ]  ->  [ d0..d7, d8..d15 | ... ]
+	const __m256i packed = _mm256_permute4x64_epi64( _mm256_packus_epi16( v6, v6 ), 0x08 );
+	const __m128i digits = _mm_add_epi8( _mm256_castsi256_si128( packed ), _mm_set1_epi8( '0' ) );
+	_mm_storeu_si128( ( __m128i * )out, digits );
+}
+#endif /* FTDC_X86_SIMD */
+
+static PFN_Write16Digits ftdc_write_16_digits = ftdc_write_16_digits_scalar;
+
+// Digits of bases up to `FTDC_BASE_MAX`.
+static const char ftdc_base_digits[ FTDC_BASE_MAX + 1 ] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+// Writes all 16 hexadecimal digits of `value`, most significant first.  Not null-terminated.
+typedef void ( * PFN_Write16Hex )( char *out, uint64_t value );
+
+static void ftdc_write_16_hex_scalar( char *out, uint64_t value ) {
+	for ( int i = 0; i < 16; i += 1 )  out[ i ] = ftdc_base_digits[ ( value >> ( 60 - 4 * i ) ) & 0xF ];
+}
+
+#if FTDC_X86_SIMD
+// Every nibble gets a byte of its own, then  '0' + n,  plus the gap between '9' and 'a' where  n > 9.
+__attribute__(( target( "sse2" ) ))
+static void ftdc_write_16_hex_sse2( char *out, uint64_t value ) {
+	const __m128i bytes = _mm_cvtsi64_si128( ( long long )__builtin_bswap64( value ) );  // Most significant first.
+	const __m128i low_nibbles = _mm_set1_epi8( 0x0F );
+	const __m128i hi = _mm_and_si128( _mm_srli_epi16( bytes, 4 ), low_nibbles );
+	const __m128i lo = _mm_and_si128( bytes, low_nibbles );
+	const __m128i nibbles = _mm_unpacklo_epi8( hi, lo );
+	const __m128i letters = _mm_and_si128( _mm_cmpgt_epi8( nibbles, _mm_set1_epi8( 9 ) ), _mm_set1_epi8( 'a' - '0' - 10 ) );
+	_mm_storeu_si128( ( __m128i * )out, _mm_add_epi8( _mm_add_epi8( nibbles, _mm_set1_epi8( '0' ) ), letters ) );
+}
+#endif /* FTDC_X86_SIMD */
+
+static PFN_Write16Hex ftdc_write_16_hex = ftdc_write_16_hex_scalar;
+
+// Writes all 64 binary digits of `value`, most significant first.  Not null-terminated.
+typedef void ( * PFN_Write64Bits )( char *out, uint64_t value );
+
+static void ftdc_write_64_bits_scalar( char *out, uint64_t value ) {
+	for ( int i = 0; i < 64; i += 1 )  out[ i ] = '0' + ( char )( ( value >> ( 63 - i ) ) & 1 );
+}
+
+#if FTDC_X86_SIMD
+// Every byte is broadcast over 8 lanes, and each lane keeps one of its bits, most significant first.
+__attribute__(( target( "sse2" ) ))
+static void ftdc_write_64_bits_sse2( char *out, uint64_t value ) {
+	const __m128i bit_masks = _mm_set1_epi64x( ( long long )0x0102040810204080llu );
+	for ( int i = 0; i < 4; i += 1 ) {
+		uint64_t hi = ( value >> ( 56 - 16 * i ) ) & 0xFF;
+		uint64_t lo = ( value >> ( 48 - 16 * i ) ) & 0xFF;
+		const __m128i bytes = _mm_set_epi64x( ( long long )( lo * 0x0101010101010101llu ), ( long long )( hi * 0x0101010101010101llu ) );
+		const __m128i bits = _mm_cmpeq_epi8( _mm_and_si128( bytes, bit_masks ), bit_masks );  // -1 where set.
+		_mm_storeu_si128( ( __m128i * )( out + 16 * i ), _mm_sub_epi8( _mm_set1_epi8( '0' ), bits ) );
+	}
+}
+#endif /* FTDC_X86_SIMD */
+
+static PFN_Write64Bits ftdc_write_64_bits = ftdc_write_64_bits_scalar;
+
+// Returns index of the first occurrence of `pattern` (`length` > 0 chars) in `haystack`, SIZE_MAX if there is none.
+typedef size_t ( * PFN_FindPattern )( const char *haystack, size_t size, const char *pattern, size_t length );
+
+static size_t ftdc_find_pattern_scalar( const char *haystack, size_t size, const char *pattern, size_t length ) {
+	if ( size < length )  return SIZE_MAX;
+	const char *end = haystack + size - length + 1;  // Past the last possible start.
+	for ( const char *at = haystack; at < end; at += 1 ) {
+		at = memchr( at, pattern[ 0 ], end - at );
+		if ( at == NULL )  break;
+		if ( memcmp( at, pattern, length ) == 0 )  return at - haystack;
+	}
+	return SIZE_MAX;
+}
+
+#if FTDC_X86_SIMD
+// With only ten different digits, one char in ten matches by chance.  Comparing a block of possible starts
+//   against pattern's first char and the block `length - 1` chars further against its last one at once
+//   leaves one start in a hundred to compare in full.
+#define FTDC_FIND_PATTERN_SIMD( name, isa, vector, width, set1, loadu, cmpeq, and, movemask ) \
+__attribute__(( target( isa ) )) \
+static size_t name( const char *haystack, size_t size, const char *pattern, size_t length ) { \
+	if ( size < length )  return SIZE_MAX; \
+	const size_t starts = size - length + 1; \
+	const vector first = set1( pattern[ 0 ] ); \
+	const vector last = set1( pattern[ length - 1 ] ); \
+	size_t i = 0; \
+	for ( ; i + width <= starts; i += width ) { \
+		const vector heads = loadu( ( const vector * )( haystack + i ) ); \
+		const vector tails = loadu( ( const vector * )( haystack + i + length - 1 ) ); \
+		uint32_t mask = ( uint32_t )movemask( and( cmpeq( heads, first ), cmpeq( tails, last ) ) ); \
+		while ( mask != 0 ) { \
+			size_t start = i + __builtin_ctz( mask ); \
+			if ( memcmp( haystack + start, pattern, length ) == 0 )  return start; \
+			mask &= mask - 1; \
+		} \
+	} \
+	size_t tail = ftdc_find_pattern_scalar( haystack + i, size - i, pattern, length ); \
+	return ( tail == SIZE_MAX ) ? SIZE_MAX : i + tail; \
+}
+
+FTDC_FIND_PATTERN_SIMD( ftdc_find_pattern_sse2, "sse2", __m128i, 16,
+	_mm_set1_epi8, _mm_loadu_si128, _mm_cmpeq_epi8, _mm_and_si128, _mm_movemask_epi8 )
+FTDC_FIND_PATTERN_SIMD( ftdc_find_pattern_avx2, "avx2", __m256i, 32,
+	_mm256_set1_epi8, _mm256_loadu_si256, _mm256_cmpeq_epi8, _mm256_and_si256, _mm256_movemask_epi8 )
+#endif /* FTDC_X86_SIMD */
+
+static PFN_FindPattern ftdc_find_pattern = ftdc_find_pattern_scalar;
+
+// Adds how many times each of digits '0' .. '9' occurs in `digits` to `counts`.
+typedef void ( * PFN_CountDigits )( const char *digits, size_t size, uint64_t counts[ 10 ] );
+
+static void ftdc_count_digits_scalar( const char *digits, size_t size, uint64_t counts[ 10 ] ) {
+	// Four sets of counters, so that runs of the same digit do not wait on one counter.
+	uint64_t sets[ 4 ][ 10 ] = { { 0 } };
+	size_t i = 0;
+	for ( ; i + 4 <= size; i += 4 ) {
+		sets[ 0 ][ digits[ i + 0 ] - '0' ] += 1;
+		sets[ 1 ][ digits[ i + 1 ] - '0' ] += 1;
+		sets[ 2 ][ digits[ i + 2 ] - '0' ] += 1;
+		sets[ 3 ][ digits[ i + 3 ] - '0' ] += 1;
+	}
+	for ( ; i < size; i += 1 )  sets[ 0 ][ digits[ i ] - '0' ] += 1;
+	for ( int digit = 0; digit < 10; digit += 1 ) {
+		counts[ digit ] += sets[ 0 ][ digit ] + sets[ 1 ][ digit ] + sets[ 2 ][ digit ] + sets[ 3 ][ digit ];
+	}
+}
+
+#if FTDC_X86_SIMD
+// Every byte lane compares equal (-1) to one digit, subtracting that counts it in an 8-bit lane counter.
+// Lane counters can take 255 vectors before they overflow, then they are summed into 64-bit ones.
+#define FTDC_COUNT_DIGITS_SIMD( name, isa, vector, width, setzero, set1, loadu, cmpeq, sub, sad, add64, storeu ) \
+__attribute__(( target( isa ) )) \
+static void name( const char *digits, size_t size, uint64_t counts[ 10 ] ) { \
+	vector totals[ 10 ]; \
+	for ( int digit = 0; digit < 10; digit += 1 )  totals[ digit ] = setzero(); \
+	size_t i = 0; \
+	while ( i + width <= size ) { \
+		vector lanes[ 10 ]; \
+		for ( int digit = 0; digit < 10; digit += 1 )  lanes[ digit ] = setzero(); \
+		size_t end = ( size - i ) / width; \
+		end = i + ( ( end < 255 ) ? end : 255 ) * width; \
+		for ( ; i < end; i += width ) { \
+			const vector chars = loadu( ( const vector * )( digits + i ) ); \
+			for ( int digit = 0; digit < 10; digit += 1 ) { \
+				lanes[ digit ] = sub( lanes[ digit ], cmpeq( chars, set1( ( char )( '0' + digit ) ) ) ); \
+			} \
+		} \
+		for ( int digit = 0; digit < 10; digit += 1 ) { \
+			totals[ digit ] = add64( totals[ digit ], sad( lanes[ digit ], setzero() ) ); \
+		} \
+	} \
+	for ( int digit = 0; digit < 10; digit += 1 ) { \
+		uint64_t sums[ width / 8 ]; \
+		storeu( ( vector * )sums, totals[ digit ] ); \
+		for ( int j = 0; j < width / 8; j += 1 )  counts[ digit ] += sums[ j ]; \
+	} \
+	ftdc_count_digits_scalar( digits + i, size - i, counts ); \
+}
+
+FTDC_COUNT_DIGITS_SIMD( ftdc_count_digits_sse2, "sse2", __m128i, 16, _mm_setzero_si128, _mm_set1_epi8,
+	_mm_loadu_si128, _mm_cmpeq_epi8, _mm_sub_epi8, _mm_sad_epu8, _mm_add_epi64, _mm_storeu_si128 )
+FTDC_COUNT_DIGITS_SIMD( ftdc_count_digits_avx2, "avx2", __m256i, 32, _mm256_setzero_si256, _mm256_set1_epi8,
+	_mm256_loadu_si256, _mm256_cmpeq_epi8, _mm256_sub_epi8, _mm256_sad_epu8, _mm256_add_epi64, _mm256_storeu_si256 )
+#endif /* FTDC_X86_SIMD */
+
+static PFN_CountDigits ftdc_count_digits = ftdc_count_digits_scalar;
+
+// Picks the fastest digit conversion, pattern search and digit counting kernels the CPU supports.  Call once before converting.
+void ftdc_detect_cpu( void ) {
+#if FTDC_X86_SIMD
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports( "avx2" ) ) {
+		ftdc_write_16_digits = ftdc_write_16_digits_avx2;
+		ftdc_write_16_hex = ftdc_write_16_hex_sse2;
+		ftdc_write_64_bits = ftdc_write_64_bits_sse2;
+		ftdc_find_pattern = ftdc_find_pattern_avx2;
+		ftdc_count_digits = ftdc_count_digits_avx2;
+		FTDC_TRACE( "CPU:  using AVX2 digit conversion." );
+	} else if ( __builtin_cpu_supports( "sse2" ) ) {
+		ftdc_write_16_digits = ftdc_write_16_digits_sse2;
+		ftdc_write_16_hex = ftdc_write_16_hex_sse2;
+		ftdc_write_64_bits = ftdc_write_64_bits_sse2;
+		ftdc_find_pattern = ftdc_find_pattern_sse2;
+		ftdc_count_digits = ftdc_count_digits_sse2;
+		FTDC_TRACE( "CPU:  using SSE2 digit conversion." );
+	}
+#endif
+}
+
+/* Allocator */
+
+// Every block starts with a header, so `ftdc_free` knows where it came from whichever backend is configured now.
+// 64 bytes keep blocks cache line aligned in the arena and in mappings.
+typedef struct ftdc_block {
+	uint64_t           size;     // Bytes asked for.
+	uint64_t           kind;     // `ftdc_alloc_kind` of the backend that allocated it.
+	uint64_t           mapped;   // Mappings:  size of the mapping starting at `mapping`.
+	char              *mapping;
+	struct ftdc_block *next;     // Mappings:  list of live ones, for `ftdc_alloc_stats_get`.
+	struct ftdc_block *prev;
+	uint64_t           padding[ 2 ];
+} ftdc_block;
+
+// Transparent huge pages are 2 MB on x86-64 and most ARM64 kernels.  Mappings are aligned to them.
+#define FTDC_HUGE_PAGE_SIZE ( 2llu << 20 )
+
+static struct {
+	ftdc_alloc_config config;
+	char             *arena;         // Reservation, NULL until first arena allocation.
+	uint64_t          arena_used;
+	ftdc_block       *mappings;      // Live mappings.
+	int               mappings_lock;
+	ftdc_alloc_stats  stats;
+} ftdc_allocator = { .config = {
+	.kind = FTDC_ALLOC_MALLOC, .arena_size = FTDC_ALLOC_ARENA_SIZE_DEFAULT, .mmap_threshold = FTDC_ALLOC_MMAP_THRESHOLD_DEFAULT
+} };
+
+// Picks allocator backend for allocations from now on.  Call before converting, blocks already allocated stay valid.
+void ftdc_alloc_configure( const ftdc_alloc_config *config ) {
+	ftdc_allocator.config = *config;
+}
+
+static void ftdc_alloc_count( int64_t committed, uint64_t reserved ) {
+	ftdc_alloc_stats *stats = &ftdc_allocator.stats;
+	uint64_t now = __atomic_add_fetch( &stats->committed, ( uint64_t )committed, __ATOMIC_RELAXED );
+	__atomic_add_fetch( &stats->reserved, reserved, __ATOMIC_RELAXED );
+	if ( committed <= 0 )  return;
+	__atomic_add_fetch( &stats->allocations, 1, __ATOMIC_RELAXED );
+	uint64_t peak = __atomic_load_n( &stats->committed_peak, __ATOMIC_RELAXED );
+	while ( now > peak && !__atomic_compare_exchange_n( &stats->committed_peak, &peak, now, true,
+		__ATOMIC_RELAXED, __ATOMIC_RELAXED ) );
+}
+
+// Writes to every page of `data`, so that the digit loop does not stop on page faults later.
+static void ftdc_alloc_prefault( char *data, size_t size ) {
+#if !defined( _WIN32 ) && defined( MADV_POPULATE_WRITE )
+	if ( madvise( data, size, MADV_POPULATE_WRITE ) == 0 ) {
+		__atomic_add_fetch( &ftdc_allocator.stats.prefaulted, size, __ATOMIC_RELAXED );
+		return;
+	}
+#endif
+	for ( size_t i = 0; i < size; i += 4096 )  data[ i ] = 0;
+	__atomic_add_fetch( &ftdc_allocator.stats.prefaulted, size, __ATOMIC_RELAXED );
+}
+
+// Reserves `size` bytes of address space, committed on first touch.  NULL on failure.
+static char *ftdc_alloc_map( size_t size ) {
+#if defined( _WIN32 )
+	return ( char * )VirtualAlloc( NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE );
+#else
+	void *data = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+	return ( data == MAP_FAILED ) ? NULL : ( char * )data;
+#endif
+}
+
+static void ftdc_alloc_unmap( char *data, size_t size ) {
+#if defined( _WIN32 )
+	VirtualFree( data, 0, MEM_RELEASE );
+#else
+	munmap( data, size );
+#endif
+}
+
+static ftdc_block *ftdc_alloc_malloc( size_t size ) {
+	ftdc_block *block = ( ftdc_block * )malloc( sizeof( ftdc_block ) + size );
+	if ( block == NULL )  return NULL;
+	block->kind = FTDC_ALLOC_MALLOC;
+	ftdc_alloc_count( ( int64_t )size, sizeof( ftdc_block ) + size );
+	return block;
+}
+
+// Bumps arena pointer.  Falls back to malloc once the reservation runs out.
+static ftdc_block *ftdc_alloc_arena( size_t size ) {
+	uint64_t arena_size = ftdc_allocator.config.arena_size;
+	if ( __atomic_load_n( &ftdc_allocator.arena, __ATOMIC_ACQUIRE ) == NULL ) {
+		char *arena = ftdc_alloc_map( arena_size );
+		char *expected = NULL;
+		if ( arena == NULL )  return ftdc_alloc_malloc( size );
+		if ( __atomic_compare_exchange_n( &ftdc_allocator.arena, &expected, arena, false,
+			__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) )
+		{
+			ftdc_alloc_count( 0, arena_size );
+		} else {
+			ftdc_alloc_unmap( arena, arena_size );  // Other thread reserved it first.
+		}
+	}
+
+	uint64_t total = ( sizeof( ftdc_block ) + size + 63 ) & ~63llu;
+	uint64_t start = __atomic_fetch_add( &ftdc_allocator.arena_used, total, __ATOMIC_RELAXED );
+	if ( start + total > arena_size )  return ftdc_alloc_malloc( size );
+	ftdc_block *block = ( ftdc_block * )( ftdc_allocator.arena + start );
+	block->kind = FTDC_ALLOC_ARENA;
+	block->mapped = total;
+	ftdc_alloc_count( ( int64_t )size, 0 );
+	return block;
+}
+
+// Own mapping, aligned to huge pages so that the kernel can back it with them.
+static ftdc_block *ftdc_alloc_mmap( size_t size ) {
+	uint64_t mapped = ( sizeof( ftdc_block ) + size + FTDC_HUGE_PAGE_SIZE - 1 ) & ~( FTDC_HUGE_PAGE_SIZE - 1 );
+	char *mapping = ftdc_alloc_map( mapped + FTDC_HUGE_PAGE_SIZE );
+	if ( mapping == NULL )  return ftdc_alloc_malloc( size );
+	char *aligned = ( char * )( ( ( uintptr_t )mapping + FTDC_HUGE_PAGE_SIZE - 1 ) & ~( FTDC_HUGE_PAGE_SIZE - 1 ) );
+#if defined( _WIN32 )
+	aligned = mapping;  // Mapping can not be trimmed, large pages need a privilege.  4K pages it is.
+#else
+	// Trim alignment slack from both ends.
+	if ( aligned > mapping )  munmap( mapping, aligned - mapping );
+	size_t after = ( mapping + mapped + FTDC_HUGE_PAGE_SIZE ) - ( aligned + mapped );
+	if ( after > 0 )  munmap( aligned + mapped, after );
+	#if defined( MADV_HUGEPAGE )
+	madvise( aligned, mapped, MADV_HUGEPAGE );
+	#endif
+#endif
+
+	ftdc_block *block = ( ftdc_block * )aligned;
+	block->kind = FTDC_ALLOC_MMAP;
+	block->mapping = aligned;
+	block->mapped = mapped;
+	if ( ftdc_allocator.config.prefault )  ftdc_alloc_prefault( aligned, mapped );
+	while ( __atomic_exchange_n( &ftdc_allocator.mappings_lock, 1, __ATOMIC_ACQUIRE ) ) {}
+	block->prev = NULL;
+	block->next = ftdc_allocator.mappings;
+	if ( block->next != NULL )  block->next->prev = block;
+	ftdc_allocator.mappings = block;
+	__atomic_store_n( &ftdc_allocator.mappings_lock, 0, __ATOMIC_RELEASE );
+	ftdc_alloc_count( ( int64_t )size, mapped );
+	return block;
+}
+
+// Allocates `size` bytes from the configured backend.  NULL if out of memory.
+void *ftdc_alloc( size_t size ) {
+	ftdc_block *block;
+	switch ( ftdc_allocator.config.kind ) {
+		case FTDC_ALLOC_ARENA:  block = ftdc_alloc_arena( size );  break;
+		case FTDC_ALLOC_MMAP:
+			block = ( size >= ftdc_allocator.config.mmap_threshold ) ? ftdc_alloc_mmap( size ) : ftdc_alloc_malloc( size );
+			break;
+		default:                block = ftdc_alloc_malloc( size );  break;
+	}
+	if ( block == NULL )  return NULL;
+	block->size = size;
+	return block + 1;
+}
+
+#if !defined( _WIN32 )
+// Bytes of `size` from `data` backed by memory, asked page by page from the kernel.
+static uint64_t ftdc_alloc_resident( char *data, size_t size ) {
+	size_t page_size = ( size_t )sysconf( _SC_PAGESIZE );
+	size_t pages = ( size + page_size - 1 ) / page_size;
+	uint64_t resident = 0;
+	unsigned char vector[ 4096 ];
+	for ( size_t page = 0; page < pages; page += sizeof( vector ) ) {
+		size_t count = ( pages - page < sizeof( vector ) ) ? pages - page : sizeof( vector );
+		if ( mincore( data + page * page_size, count * page_size, vector ) != 0 )  return resident;
+		for ( size_t i = 0; i < count; i += 1 )  resident += ( vector[ i ] & 1 ) * page_size;
+	}
+	return resident;
+}
+#endif
+
+void ftdc_free( void *pointer ) {
+	if ( pointer == NULL )  return;
+	ftdc_block *block = ( ftdc_block * )pointer - 1;
+	int64_t size = ( int64_t )block->size;
+	switch ( block->kind ) {
+		case FTDC_ALLOC_ARENA: {
+			// Only the last block can be given back, the rest is freed with the whole arena at exit.
+			uint64_t start = ( uint64_t )( ( char * )block - ftdc_allocator.arena );
+			uint64_t end = start + block->mapped;
+			__atomic_compare_exchange_n( &ftdc_allocator.arena_used, &end, start, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED );
+			ftdc_alloc_count( -size, 0 );
+		} break;
+		case FTDC_ALLOC_MMAP: {
+			while ( __atomic_exchange_n( &ftdc_allocator.mappings_lock, 1, __ATOMIC_ACQUIRE ) ) {}
+			if ( block->prev != NULL )  block->prev->next = block->next;
+			else                        ftdc_allocator.mappings = block->next;
+			if ( block->next != NULL )  block->next->prev = block->prev;
+			__atomic_store_n( &ftdc_allocator.mappings_lock, 0, __ATOMIC_RELEASE );
+			ftdc_alloc_count( -size, 0 );
+#if !defined( _WIN32 )
+			__atomic_add_fetch( &ftdc_allocator.stats.faulted, ftdc_alloc_resident( block->mapping, block->mapped ),
+				__ATOMIC_RELAXED );
+#endif
+			ftdc_alloc_unmap( block->mapping, block->mapped );
+		} break;
+		default:
+			ftdc_alloc_count( -size, 0 );
+			free( block );
+			break;
+	}
+}
+
+// Allocates `new_size` bytes, moving the first `old_size` of them from `pointer`, which is freed.
+void *ftdc_realloc( void *pointer, size_t old_size, size_t new_size ) {
+	void *moved = ftdc_alloc( new_size );
+	if ( moved == NULL )  return NULL;
+	if ( pointer != NULL )  memcpy( moved, pointer, ( old_size < new_size ) ? old_size : new_size );
+	ftdc_free( pointer );
+	return moved;
+}
+
+// Fills `stats` with allocator counters so far.  Faulted bytes are counted now, so this is not free.
+void ftdc_alloc_stats_get( ftdc_alloc_stats *stats ) {
+	*stats = ftdc_allocator.stats;
+#if !defined( _WIN32 )
+	if ( ftdc_allocator.arena != NULL ) {
+		stats->faulted += ftdc_alloc_resident( ftdc_allocator.arena, ftdc_allocator.config.arena_size );
+	}
+	while ( __atomic_exchange_n( &ftdc_allocator.mappings_lock, 1, __ATOMIC_ACQUIRE ) ) {}
+	for ( ftdc_block *block = ftdc_allocator.mappings; block != NULL; block = block->next ) {
+		stats->faulted += ftdc_alloc_resident( block->mapping, block->mapped );
+	}
+	__atomic_store_n( &ftdc_allocator.mappings_lock, 0, __ATOMIC_RELEASE );
+#endif
+}
+
+/* Stats */
+
+// Monotonic nanoseconds.
+uint64_t ftdc_clock_ns( void ) {
+#if defined( _WIN32 )
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &counter );
+	return ( uint64_t )( ( double )counter.QuadPart * 1e9 / ( double )frequency.QuadPart );
+#else
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return ( uint64_t )now.tv_sec * 1000000000llu + ( uint64_t )now.tv_nsec;
+#endif
+}
+
+// Timestamp for phase timings:  time stamp counter on x86 (a few cycles to read, no system call),
+//   monotonic nanoseconds elsewhere.  Converted to nanoseconds by `ftdc_stats_ns_per_tick`.
+uint64_t ftdc_ticks( void ) {
+#if FTDC_X86_SIMD
+	return __rdtsc();
+#else
+	return ftdc_clock_ns();
+#endif
+}
+
+// Clears `stats` and starts its run clock.
+void ftdc_stats_start( ftdc_stats *stats ) {
+	memset( stats, 0, sizeof( *stats ) );
+	stats->start_ns = ftdc_clock_ns();
+	stats->start_ticks = ftdc_ticks();
+	stats->tick_cost = UINT64_MAX;
+	for ( int i = 0; i < 16; i += 1 ) {
+		uint64_t before = ftdc_ticks();
+		uint64_t cost = ftdc_ticks() - before;
+		if ( cost < stats->tick_cost )  stats->tick_cost = cost;
+	}
+}
+
+// Returns `stats` if the next conversion is to be timed, NULL if not (or without `stats`).
+ftdc_stats *ftdc_stats_timed( ftdc_stats *stats ) {
+	if ( stats == NULL )  return NULL;
+	uint64_t sample_mask = ( 1llu << stats->sample_shift ) - 1;
+	return ( ( stats->conversions & sample_mask ) == 0 ) ? stats : NULL;
+}
+
+// Adds time since `*since` to `phase`, and moves `*since` to now.  Does nothing without `stats`.
+void ftdc_stats_phase( ftdc_stats *stats, ftdc_phase phase, uint64_t *since ) {
+	if ( stats == NULL )  return;
+	uint64_t now = ftdc_ticks();
+	uint64_t elapsed = now - *since;
+	stats->ticks[ phase ] += ( elapsed > stats->tick_cost ) ? elapsed - stats->tick_cost : 0;
+	*since = now;
+}
+
+// Counts `digits` computed by long division, after `seeks` jumps to their positions.
+void ftdc_stats_count_fraction( ftdc_stats *stats, uint64_t digits, uint64_t seeks ) {
+	if ( stats == NULL )  return;
+	stats->digits += digits;
+	stats->divisions += ( digits + FTDC_CHUNK_DIGITS - 1 ) / FTDC_CHUNK_DIGITS;
+	stats->seeks += seeks;
+}
+
+// Returns estimated nanoseconds spent in `phase`:  sampled ones scaled up to all conversions.
+uint64_t ftdc_stats_phase_ns( const ftdc_stats *stats, ftdc_phase phase, double ns_per_tick ) {
+	double ns = ( double )stats->ticks[ phase ] * ns_per_tick;
+	if ( phase != FTDC_PHASE_OUTPUT )  ns *= ( double )( 1llu << stats->sample_shift );
+	return ( uint64_t )ns;
+}
+
+// Ticks to nanoseconds, measured over the run so far:  TSC frequency is not known up front.
+double ftdc_stats_ns_per_tick( const ftdc_stats *stats ) {
+	uint64_t ticks = ftdc_ticks() - stats->start_ticks;
+	uint64_t ns = ftdc_clock_ns() - stats->start_ns;
+	return ( ticks > 0 ) ? ( double )ns / ( double )ticks : 1.0;
+}
+
+// Writes exactly 19 digits of `chunk` (< 10^19), zero-padded.  Not null-terminated.
+void ftdc_write_chunk( char *out, uint64_t chunk ) {
+	uint32_t top = ( uint32_t )( chunk / ftdc_pow10[ 16 ] );  // 3 digits
+	out[ 0 ] = '0' + top / 100;
+	memcpy( out + 1, &ftdc_digit_pairs[ ( top % 100 ) * 2 ], 2 );
+	ftdc_write_16_digits( out + 3, chunk % ftdc_pow10[ 16 ] );
+}
+
+// Writes exactly `count` (<= 19) least significant digits of `chunk`, zero-padded.
+// Used for the last, partial chunk.  Not null-terminated.
+static void ftdc_write_chunk_partial( char *out, uint64_t chunk, int count ) {
+	char full[ FTDC_CHUNK_DIGITS ];
+	ftdc_write_chunk( full, chunk );
+	memcpy( out, full + FTDC_CHUNK_DIGITS - count, count );
+}
+
+// Appends `uint64_t` value number.  Returns chars written, 0 (and writes nothing) if they do not fit.
+// If `magnitude` is greater than 1 (10, 100, ...), writes exactly as many digits, zero-padded or cut from the left.
+// Chainable:  `cursor += ftdc_append_uint64( buffer, size, cursor, number, 0 );`
+int ftdc_append_uint64( char *buffer, size_t buffer_size, size_t cursor, uint64_t number, uint64_t magnitude ) {
+	int count = 1;
+	if ( magnitude <= 1 )  magnitude = number;  // Compute magnitude ourselves.
+	while ( count < INT64_MAX_DIGITS && magnitude >= ftdc_pow10[ count ] )  count += 1;
+	if ( cursor + count > buffer_size )  return 0;
+
+	char *out = buffer + cursor;
+	if ( count <= 8 ) {
+		// Short ones, like most integer parts, are not worth a whole chunk.
+		char full[ 8 ];
+		ftdc_write_8_digits( full, ( uint32_t )( number % ftdc_pow10[ count ] ) );
+		memcpy( out, full + 8 - count, count );
+	} else if ( count == INT64_MAX_DIGITS ) {
+		// 20th digit does not fit into a chunk.
+		out[ 0 ] = '0' + ( number / ftdc_pow10[ FTDC_CHUNK_DIGITS ] );
+		ftdc_write_chunk( out + 1, number % ftdc_pow10[ FTDC_CHUNK_DIGITS ] );
+	} else {
+		ftdc_write_chunk_partial( out, number % ftdc_pow10[ count ], count );
+	}
+	return count;
+}
+
+// Appends `uint64_t` value number in `base` (`FTDC_BASE_MIN` to `FTDC_BASE_MAX`).
+// Returns chars written, 0 (and writes nothing) if they do not fit.
+// Runs once per conversion, for the integer part:  plain division will do.
+int ftdc_append_uint64_base( char *buffer, size_t buffer_size, size_t cursor, uint64_t number, int base ) {
+	char digits[ 64 ];  // Base 2 needs the most.
+	int count = 0;
+	do {
+		count += 1;
+		digits[ 64 - count ] = ftdc_base_digits[ number % base ];
+		number /= base;
+	} while ( number > 0 );
+	if ( cursor + count > buffer_size )  return 0;
+	memcpy( buffer + cursor, digits + 64 - count, count );
+	return count;
+}
+
+// Divides 128-bit `hi:lo` by `d`.  Quotient must fit into 64 bits (`hi < d`).
+// Generic `ftdc_u128` division calls into a full 128 by 128 bit routine,
+//   while x86-64 does exactly this in a single `div` instruction.
+static inline uint64_t ftdc_div_128by64( uint64_t hi, uint64_t lo, uint64_t d, uint64_t *remainder ) {
+#if defined( __GNUC__ ) && defined( __x86_64__ )
+	uint64_t q, r;
+	__asm__( "divq %4" : "=a"( q ), "=d"( r ) : "a"( lo ), "d"( hi ), "rm"( d ) );
+	*remainder = r;
+	return q;
+#else
+	ftdc_u128 n = ( ( ftdc_u128 )hi << 64 ) | lo;
+	uint64_t q = ( uint64_t )( n / d );
+	*remainder = ( uint64_t )( n - ( ftdc_u128 )q * d );
+	return q;
+#endif
+}
+
+// Division by an invariant 64-bit divisor with multiplications only (Moller & Granlund,
+//   "Improved division by invariant integers", 2011).  Divisor is normalized so its top bit is set,
+//   and its reciprocal is computed once with a real division, replacing every following one.
+
+void ftdc_divider_init( ftdc_divider *divider, uint64_t divisor ) {
+	int shift = 0;
+	while ( ( ( divisor << shift ) >> 63 ) == 0 )  shift += 1;
+	uint64_t normalized = divisor << shift;
+	uint64_t unused;
+	divider->divisor = divisor;
+	divider->normalized = normalized;
+	divider->reciprocal = ftdc_div_128by64( ~normalized, ~0llu, normalized, &unused );
+	divider->shift = shift;
+}
+
+// Divides `u1:u0` by normalized divisor (`u1 < normalized`).  Quotient is exact, no correction loop.
+static inline uint64_t ftdc_divider_div_normalized( const ftdc_divider *divider, uint64_t u1, uint64_t u0, uint64_t *remainder ) {
+	const uint64_t d = divider->normalized;
+	ftdc_u128 q = ( ftdc_u128 )divider->reciprocal * u1;
+	q += ( ( ftdc_u128 )( u1 + 1 ) << 64 ) | u0;
+	uint64_t q1 = ( uint64_t )( q >> 64 );
+	uint64_t q0 = ( uint64_t )q;
+	uint64_t r = u0 - q1 * d;
+	if ( r > q0 ) {
+		// Estimate was one too big.
+		q1 -= 1;
+		r += d;
+	}
+	if ( r >= d ) {
+		// Rarely, one too small.
+		q1 += 1;
+		r -= d;
+	}
+	*remainder = r;
+	return q1;
+}
+
+// Divides 128-bit `hi:lo` by divider's divisor.  Quotient must fit into 64 bits (`hi < divisor`).
+static inline uint64_t ftdc_divider_div( const ftdc_divider *divider, uint64_t hi, uint64_t lo, uint64_t *remainder ) {
+	const int s = divider->shift;
+	uint64_t u1 = ( s == 0 ) ? hi : ( hi << s ) | ( lo >> ( 64 - s ) );
+	uint64_t u0 = lo << s;
+	uint64_t q = ftdc_divider_div_normalized( divider, u1, u0, remainder );
+	*remainder >>= s;
+	return q;
+}
+
+// Computes up to `count` fractional digits of `*remainder / denominator` into `out`,
+//   `FTDC_CHUNK_DIGITS` digits per long-division step.
+// `*remainder` must be less than `denominator`.  It is advanced past the computed digits.
+// Like the digit-by-digit loop, stops after the last non-zero digit once the remainder becomes 0.
+// Returns digits written.  Not null-terminated.
+uint64_t ftdc_compute_fraction( char *out, uint64_t count, uint64_t *remainder, uint64_t denominator ) {
+	ftdc_divider divider;
+	ftdc_divider_init( &divider, denominator );
+	return ftdc_compute_fraction_div( out, count, remainder, &divider );
+}
+
+// Same as `ftdc_compute_fraction`, with denominator's reciprocal already computed.
+uint64_t ftdc_compute_fraction_div( char *out, uint64_t count, uint64_t *remainder, const ftdc_divider *divider ) {
+	// Remainder is kept pre-shifted by the divider's normalization:
+	//   ( r * 10^19 ) << s  ==  ( r << s ) * 10^19,  and the remainder comes out shifted the same way.
+	uint64_t r = *remainder << divider->shift;
+	uint64_t written = 0;
+	while ( written < count && r != 0 ) {
+		uint64_t digits_left = count - written;
+		int step = ( digits_left < FTDC_CHUNK_DIGITS ) ? ( int )digits_left : FTDC_CHUNK_DIGITS;
+
+		// Same as `step` iterations of `r *= 10; digit = r / d; r %= d;`, but at once:
+		//   3 / 7  ->  3 * 10^19 / 7  =  4285714285714285714  +  2 / 7
+		ftdc_u128 scaled = ( ftdc_u128 )r * ftdc_pow10[ step ];
+		uint64_t chunk = ftdc_divider_div_normalized( divider, ( uint64_t )( scaled >> 64 ), ( uint64_t )scaled, &r );
+		FTDC_TRACE( "[%llu]  %llu * 10^%d / %llu  ->  %0*llu", ( unsigned long long )( written + 1 ),
+			( unsigned long long )*remainder, step, ( unsigned long long )divider->divisor, step,
+			( unsigned long long )chunk );
+
+		if ( step == FTDC_CHUNK_DIGITS )  ftdc_write_chunk( out + written, chunk );
+		else                              ftdc_write_chunk_partial( out + written, chunk, step );
+		written += step;
+		*remainder = r >> divider->shift;
+	}
+
+	if ( r == 0 ) {
+		// Fraction has ended inside the last chunk.  Its tail is zero-padding,
+		//   the digit that zeroed the remainder is always non-zero.
+		while ( written > 0 && out[ written - 1 ] == '0' )  written -= 1;
+	}
+	return written;
+}
+
+/* Other bases */
+
+// Long division in a base other than 10, with as many digits per step as fit into 64 bits.
+typedef struct ftdc_radix {
+	int          base;
+	int          bits;              // log2 of a power-of-two base, 0 for any other.
+	int          chunk_digits;      // Digits per long-division step:  base^chunk_digits <= 2^64.
+	uint64_t     powers[ 64 + 1 ];  // base^0 .. base^chunk_digits, not used for power-of-two bases.
+	ftdc_divider divider;           // Of `base`, takes the first digit off a partial chunk.
+	ftdc_divider halves;            // Of base^(chunk_digits / 2), splits a whole chunk in two.
+	uint64_t     reciprocal;        // ceil( 2^64 / base ), takes digits off what is left.
+} ftdc_radix;
+
+static void ftdc_radix_init( ftdc_radix *radix, int base ) {
+	radix->base = base;
+	radix->bits = ( ( base & ( base - 1 ) ) == 0 ) ? __builtin_ctz( base ) : 0;
+	if ( radix->bits > 0 ) {
+		// Digits are bit fields of the quotient, a step can fill all of its 64 bits.  Nothing to divide by.
+		radix->chunk_digits = 64 / radix->bits;
+		return;
+	}
+
+	radix->chunk_digits = 0;
+	radix->powers[ 0 ] = 1;
+	while ( radix->powers[ radix->chunk_digits ] <= UINT64_MAX / base ) {
+		radix->powers[ radix->chunk_digits + 1 ] = radix->powers[ radix->chunk_digits ] * base;
+		radix->chunk_digits += 1;
+	}
+	ftdc_divider_init( &radix->divider, base );
+	ftdc_divider_init( &radix->halves, radix->powers[ radix->chunk_digits / 2 ] );
+	radix->reciprocal = UINT64_MAX / base + 1;
+}
+
+// Takes the least significant digit off `*x` (< 2^64 / base) and returns it, with a multiply-high by base's reciprocal:
+//   x * ceil( 2^64 / base )  =  ( x * 2^64  +  x * e ) / base  for some  e < base,  and  x * e < 2^64
+//   never carries the quotient past the next integer.
+static inline uint64_t ftdc_radix_next_digit( const ftdc_radix *radix, uint64_t *x ) {
+	uint64_t q = ( uint64_t )( ( ( ftdc_u128 )*x * radix->reciprocal ) >> 64 );
+	uint64_t digit = *x - q * radix->base;
+	*x = q;
+	return digit;
+}
+
+// Writes `count` digits of `bits` bits each, most significant first.  Inlined with constant `bits`,
+//   so the shifts are immediates and the loop unrolls.
+static inline __attribute__(( always_inline )) void ftdc_write_bit_digits( char *out, uint64_t chunk, int count, int bits ) {
+	const uint64_t mask = ( 1llu << bits ) - 1;
+	for ( int i = count - 1; i >= 0; i -= 1 ) {
+		out[ i ] = ftdc_base_digits[ chunk & mask ];
+		chunk >>= bits;
+	}
+}
+
+// Writes exactly `count` (<= `chunk_digits`) least significant digits of `chunk` in radix's base, zero-padded.
+// Not null-terminated.
+static void ftdc_write_radix_chunk( char *out, uint64_t chunk, int count, const ftdc_radix *radix ) {
+	// No division at all for power-of-two bases:  every digit is `bits` bits of the chunk.
+	switch ( radix->bits ) {
+	case 1:
+		if ( count == 64 )  ftdc_write_64_bits( out, chunk );
+		else                ftdc_write_bit_digits( out, chunk, count, 1 );
+		return;
+	case 2:  ftdc_write_bit_digits( out, chunk, count, 2 );  return;
+	case 3:  ftdc_write_bit_digits( out, chunk, count, 3 );  return;
+	case 4:
+		if ( count == 16 )  ftdc_write_16_hex( out, chunk );
+		else                ftdc_write_bit_digits( out, chunk, count, 4 );
+		return;
+	case 5:  ftdc_write_bit_digits( out, chunk, count, 5 );  return;
+	}
+
+	// Other bases need the chunk below 2^64 / base first.  A whole one is split into two halves that are,
+	//   and their digits come out as two independent chains of multiplications.
+	if ( count == radix->chunk_digits ) {
+		const int half = count / 2;
+		uint64_t lo;
+		uint64_t hi = ftdc_divider_div( &radix->halves, 0, chunk, &lo );
+		for ( int i = count - 1; i >= count - half; i -= 1 ) {
+			out[ i ] = ftdc_base_digits[ ftdc_radix_next_digit( radix, &lo ) ];
+			out[ i - half ] = ftdc_base_digits[ ftdc_radix_next_digit( radix, &hi ) ];
+		}
+		if ( count % 2 != 0 )  out[ 0 ] = ftdc_base_digits[ hi ];
+		return;
+	}
+	uint64_t digit;
+	chunk = ftdc_divider_div( &radix->divider, 0, chunk, &digit );
+	out[ count - 1 ] = ftdc_base_digits[ digit ];
+	for ( int i = count - 2; i >= 0; i -= 1 )  out[ i ] = ftdc_base_digits[ ftdc_radix_next_digit( radix, &chunk ) ];
+}
+
+// Same as `ftdc_compute_fraction`, but digits are in radix's base, `chunk_digits` per long-division step.
+// Power-of-two bases scale the remainder by a shift instead of a multiplication:  r * 16^16  =  r << 64
+static uint64_t ftdc_compute_fraction_radix( char *out, uint64_t count, uint64_t *remainder, uint64_t denominator,
+	const ftdc_radix *radix )
+{
+	ftdc_divider divider;
+	ftdc_divider_init( &divider, denominator );
+	uint64_t r = *remainder << divider.shift;
+	uint64_t written = 0;
+	while ( written < count && r != 0 ) {
+		uint64_t digits_left = count - written;
+		int step = ( digits_left < ( uint64_t )radix->chunk_digits ) ? ( int )digits_left : radix->chunk_digits;
+		ftdc_u128 scaled = ( radix->bits > 0 )
+			? ( ftdc_u128 )r << ( radix->bits * step )
+			: ( ftdc_u128 )r * radix->powers[ step ];
+		uint64_t chunk = ftdc_divider_div_normalized( &divider, ( uint64_t )( scaled >> 64 ), ( uint64_t )scaled, &r );
+		ftdc_write_radix_chunk( out + written, chunk, step, radix );
+		written += step;
+	}
+	*remainder = r >> divider.shift;
+
+	if ( r == 0 ) {
+		while ( written > 0 && out[ written - 1 ] == '0' )  written -= 1;
+	}
+	return written;
+}
+
+// Returns (G)reatest (C)ommon (D)ivisor by binary (Stein's) algorithm:  no divisions,
+//   only shifts by trailing zero counts and subtractions of odd numbers.
+//   GCD( 2^k a, 2^k b )  =  2^k GCD( a, b ),   GCD( odd a, odd b )  =  GCD( a, b - a )
+uint64_t ftdc_GCD( uint64_t a, uint64_t b ) {
+	if ( a == 0 )  return b;
+	if ( b == 0 )  return a;
+	// Each step takes a bit or so off the larger number:  when one is far larger, a single division
+	//   brings it down to the size of the smaller one faster.  Small numerators over large denominators are common.
+	if ( ( a >> 8 ) > b )  a %= b;
+	else if ( ( b >> 8 ) > a )  b %= a;
+	if ( a == 0 )  return b;
+	if ( b == 0 )  return a;
+	int shift = __builtin_ctzll( a | b );  // Common factors of 2.
+	// Branch-free:  which of the two is larger is a coin flip every step, so it is picked by masks.
+	// Zeros of the difference are counted before taking its absolute value (same count either sign),
+	//   so that the count does not wait on it.  Difference is never counted when 0, `| 2^63` keeps `ctz` defined.
+	int a_zeros = __builtin_ctzll( a );
+	b >>= __builtin_ctzll( b );
+	while ( a != 0 ) {
+		a >>= a_zeros;  // Both odd now.
+		uint64_t difference = b - a;
+		a_zeros = __builtin_ctzll( difference | ( 1llu << 63 ) );
+		uint64_t a_larger = -( uint64_t )( a > b );  // All ones or none, compilers branch on `?:` here.
+		b = a + ( difference & a_larger );            // Smaller one.
+		a = ( difference ^ a_larger ) - a_larger;     // | b - a |
+	}
+	return b << shift;
+}
+
+// Same as `ftdc_GCD`, for 128-bit operands.
+ftdc_u128 ftdc_GCD128( ftdc_u128 a, ftdc_u128 b ) {
+	#define FTDC_CTZ128( x ) \
+		( ( ( uint64_t )( x ) != 0 ) ? __builtin_ctzll( ( uint64_t )( x ) ) : 64 + __builtin_ctzll( ( uint64_t )( ( x ) >> 64 ) ) )
+	if ( a == 0 )  return b;
+	if ( b == 0 )  return a;
+	int shift = FTDC_CTZ128( a | b );
+	a >>= FTDC_CTZ128( a );
+	do {
+		b >>= FTDC_CTZ128( b );
+		if ( a > b ) {
+			ftdc_u128 t = a;
+			a = b;
+			b = t;
+		}
+		b -= a;
+	} while ( b != 0 );
+	return a << shift;
+	#undef FTDC_CTZ128
+}
+
+// Simplifies `*numerator / *denominator` in place, always down to the lowest terms,
+//   so the digit loop works with the smallest denominator possible.
+//  13 / 5  ->  13 / 5 
+//  15 / 5  ->   3 / 1
+//  5 / 15  ->   1 / 3
+//   6 / 4  ->   3 / 2
+void ftdc_simplify( uint64_t *numerator, uint64_t *denominator ) {
+	uint64_t divisor = ftdc_GCD( *numerator, *denominator );
+	if ( divisor == 1 )  return;  // Usually, and then it takes no divisions.
+	*numerator /= divisor;
+	*denominator /= divisor;
+}
+
+// Splits integer part off `*numerator / denominator`, leaving only fraction numerator.  Returns integer part.
+// 13 / 5  ->  2  +  3 / 5 
+//  3 / 1  ->  3  +  0 / 1
+//  1 / 3  ->  1 / 3
+uint64_t ftdc_extract_integer( uint64_t *numerator, uint64_t denominator ) {
+	if ( *numerator < denominator )  return 0;  // Proper fraction, no division needed.
+	// Quotient and remainder come out of a single division.
+	uint64_t integer = *numerator / denominator;
+	*numerator %= denominator;
+	return integer;
+}
+
+// Returns `a * b mod m`.  `a` and `b` must be less than `m`.
+static inline uint64_t ftdc_mulmod( uint64_t a, uint64_t b, uint64_t m ) {
+	ftdc_u128 product = ( ftdc_u128 )a * b;
+	uint64_t r;
+	ftdc_div_128by64( ( uint64_t )( product >> 64 ), ( uint64_t )product, m, &r );
+	return r;
+}
+
+// Same as `ftdc_mulmod`, for many multiplications by the same modulus.
+static inline uint64_t ftdc_mulmod_div( uint64_t a, uint64_t b, const ftdc_divider *m ) {
+	ftdc_u128 product = ( ftdc_u128 )a * b;
+	uint64_t r;
+	ftdc_divider_div( m, ( uint64_t )( product >> 64 ), ( uint64_t )product, &r );
+	return r;
+}
+
+// Returns `base ^ exponent mod m` by square-and-multiply.
+uint64_t ftdc_powmod( uint64_t base, uint64_t exponent, uint64_t m ) {
+	ftdc_divider divider;
+	ftdc_divider_init( &divider, m );
+	uint64_t result = 1 % m;
+	base %= m;
+	while ( exponent > 0 ) {
+		if ( exponent & 1 )  result = ftdc_mulmod_div( result, base, &divider );
+		base = ftdc_mulmod_div( base, base, &divider );
+		exponent >>= 1;
+	}
+	return result;
+}
+
+// Same as `ftdc_seek_remainder`, for digits in `base`:  numerator * base^(position - 1)  mod  denominator
+static uint64_t ftdc_seek_remainder_base( uint64_t numerator, uint64_t denominator, uint64_t position, int base ) {
+	if ( position <= 1 )  return numerator;
+	return ftdc_mulmod( numerator, ftdc_powmod( base, position - 1, denominator ), denominator );
+}
+
+// Returns remainder right before the `position`-th (1-based) fractional digit of `numerator / denominator`
+//   (`numerator < denominator`), without computing the digits before it:
+//   numerator * 10^(position - 1)  mod  denominator
+// Costs O(log position) instead of `position` long-division steps.
+uint64_t ftdc_seek_remainder( uint64_t numerator, uint64_t denominator, uint64_t position ) {
+	return ftdc_seek_remainder_base( numerator, denominator, position, 10 );
+}
+
+// Deterministic Miller-Rabin.  The first 12 primes as bases are enough for any 64-bit `n`.
+static bool ftdc_is_prime( uint64_t n ) {
+	static const uint64_t bases[ 12 ] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+	if ( n < 2 )  return false;
+	for ( int i = 0; i < 12; i += 1 ) {
+		if ( n % bases[ i ] == 0 )  return n == bases[ i ];
+	}
+
+	// n - 1  =  d * 2^s
+	uint64_t d = n - 1;
+	int s = 0;
+	while ( ( d & 1 ) == 0 ) {
+		d >>= 1;
+		s += 1;
+	}
+
+	ftdc_divider divider;
+	ftdc_divider_init( &divider, n );
+	for ( int i = 0; i < 12; i += 1 ) {
+		uint64_t x = ftdc_powmod( bases[ i ], d, n );
+		if ( x == 1 || x == n - 1 )  continue;
+		int r = 1;
+		for ( ; r < s; r += 1 ) {
+			x = ftdc_mulmod_div( x, x, &divider );
+			if ( x == n - 1 )  break;
+		}
+		if ( r == s )  return false;  // Witness of compositeness
+	}
+	return true;
+}
+
+// Returns a non-trivial divisor of composite `n` (Pollard's rho, Brent's variant).
+static uint64_t ftdc_pollard_rho( uint64_t n ) {
+	if ( ( n & 1 ) == 0 )  return 2;
+	ftdc_divider divider;
+	ftdc_divider_init( &divider, n );
+	for ( uint64_t c = 1; ; c += 1 ) {
+		// y  ->  y^2 + c  (mod n), without overflowing past `n`.
+		#define FTDC_RHO_STEP( y ) \
+			y = ftdc_mulmod_div( y, y, &divider ); \
+			y = ( y >= n - c ) ? y - ( n - c ) : y + c
+		#define FTDC_RHO_DIFF( a, b )  ( ( a > b ) ? a - b : b - a )
+
+		uint64_t x = 0, y = 2, ys = 2;
+		uint64_t g = 1, q = 1;
+		for ( uint64_t r = 1; g == 1; r *= 2 ) {
+			x = y;
+			for ( uint64_t i = 0; i < r; i += 1 ) { FTDC_RHO_STEP( y ); }
+			for ( uint64_t k = 0; k < r && g == 1; k += 128 ) {
+				ys = y;
+				for ( uint64_t i = 0; i < 128 && i < r - k; i += 1 ) {
+					FTDC_RHO_STEP( y );
+					q = ftdc_mulmod_div( q, FTDC_RHO_DIFF( x, y ), &divider );
+				}
+				g = ftdc_GCD( q, n );
+			}
+		}
+		if ( g == n ) {
+			// Batched product hit 0 (mod n), redo the last batch one step at a time.
+			do {
+				FTDC_RHO_STEP( ys );
+				g = ftdc_GCD( FTDC_RHO_DIFF( x, ys ), n );
+			} while ( g == 1 );
+		}
+		if ( g != n )  return g;
+		// Otherwise the cycle closed without splitting `n`, try another polynomial.
+
+		#undef FTDC_RHO_STEP
+		#undef FTDC_RHO_DIFF
+	}
+}
+
+// A 64-bit integer has at most 15 distinct prime factors.
+#define FTDC_FACTORS_MAX 16
+
+typedef struct ftdc_factors {
+	int count;
+	uint64_t primes[ FTDC_FACTORS_MAX ];
+	int exponents[ FTDC_FACTORS_MAX ];
+} ftdc_factors;
+
+static void ftdc_factors_add( ftdc_factors *factors, uint64_t prime, int exponent ) {
+	for ( int i = 0; i < factors->count; i += 1 ) {
+		if ( factors->primes[ i ] == prime ) {
+			factors->exponents[ i ] += exponent;
+			return;
+		}
+	}
+	factors->primes[ factors->count ] = prime;
+	factors->exponents[ factors->count ] = exponent;
+	factors->count += 1;
+}
+
+// Adds prime factorization of `n` to `factors`.
+static void ftdc_factorize( uint64_t n, ftdc_factors *factors ) {
+	// Peel off small primes first, rho is wasted on them.
+	for ( uint64_t p = 2; p < 64 && p * p <= n; p += ( p == 2 ) ? 1 : 2 ) {
+		int exponent = 0;
+		while ( n % p == 0 ) {
+			n /= p;
+			exponent += 1;
+		}
+		if ( exponent > 0 )  ftdc_factors_add( factors, p, exponent );
+	}
+	if ( n == 1 )  return;
+	if ( ftdc_is_prime( n ) ) {
+		ftdc_factors_add( factors, n, 1 );
+		return;
+	}
+	uint64_t divisor = ftdc_pollard_rho( n );
+	ftdc_factorize( divisor, factors );
+	ftdc_factorize( n / divisor, factors );
+}
+
+// Returns multiplicative order of `base` modulo `m`:  smallest `k > 0` such that `base^k = 1 (mod m)`.
+// `m` must be coprime to `base` and greater than 1.
+// The order divides Euler's totient, so start from it and strip its prime factors while base^k stays 1.
+uint64_t ftdc_order( uint64_t base, uint64_t m ) {
+	ftdc_factors m_factors = { 0 };
+	ftdc_factorize( m, &m_factors );
+
+	// phi( p1^e1 * p2^e2 ... )  =  p1^(e1 - 1) * (p1 - 1)  *  p2^(e2 - 1) * (p2 - 1)  ...
+	uint64_t phi = 1;
+	ftdc_factors phi_factors = { 0 };
+	for ( int i = 0; i < m_factors.count; i += 1 ) {
+		uint64_t p = m_factors.primes[ i ];
+		int e = m_factors.exponents[ i ];
+		phi *= p - 1;
+		for ( int j = 1; j < e; j += 1 )  phi *= p;
+		if ( e > 1 )  ftdc_factors_add( &phi_factors, p, e - 1 );
+		ftdc_factorize( p - 1, &phi_factors );
+	}
+
+	uint64_t order = phi;
+	for ( int i = 0; i < phi_factors.count; i += 1 ) {
+		uint64_t q = phi_factors.primes[ i ];
+		for ( int j = 0; j < phi_factors.exponents[ i ]; j += 1 ) {
+			if ( ftdc_powmod( base, order / q, m ) != 1 )  break;
+			order /= q;
+		}
+	}
+	return order;
+}
+
+// Returns multiplicative order of 10 modulo `m`, the period of decimals over `m`.  See `ftdc_order`.
+uint64_t ftdc_order10( uint64_t m ) {
+	return ftdc_order( 10, m );
+}
+
+// Strips factors of 2 and 5 from `*denominator`, returns how many fractional digits they delay repetition by.
+// Each factor of 2 or 5 delays the repetition by a digit:  d  =  2^a * 5^b * m  ->  max( a, b )
+// Leaves `m` in `*denominator`, fraction terminates if it is 1.
+static uint64_t ftdc_strip_2_5( uint64_t *denominator ) {
+	uint64_t twos = 0, fives = 0;
+	while ( *denominator % 2 == 0 ) {
+		*denominator /= 2;
+		twos += 1;
+	}
+	while ( *denominator % 5 == 0 ) {
+		*denominator /= 5;
+		fives += 1;
+	}
+	return ( twos > fives ) ? twos : fives;
+}
+
+// Same as `ftdc_strip_2_5`, for digits in `base`:  strips factors `*denominator` shares with it.
+// Every step takes one digit's worth of each shared prime out:  16 / GCD( 16, 10 ) = 8  ->  4  ->  2  ->  1
+static uint64_t ftdc_strip_base( uint64_t *denominator, int base ) {
+	if ( ( base & ( base - 1 ) ) == 0 ) {
+		// Only factors of 2 are shared, `bits` of them per digit.
+		int bits = __builtin_ctz( base );
+		int twos = __builtin_ctzll( *denominator );
+		*denominator >>= twos;
+		return ( twos + bits - 1 ) / bits;
+	}
+	uint64_t digits = 0;
+	for ( uint64_t g = ftdc_GCD( *denominator, base ); g > 1; g = ftdc_GCD( *denominator, base ) ) {
+		*denominator /= g;
+		digits += 1;
+	}
+	return digits;
+}
+
+// Finds where the decimal expansion of `numerator / denominator` starts repeating, and how often.
+//   1 / 7   =  0.(142857)  ->  pre-period 0, period 6
+//   1 / 12  =  0.08(3)     ->  pre-period 2, period 1
+//   3 / 8   =  0.375       ->  pre-period 3, period 0
+ftdc_period ftdc_find_period( uint64_t numerator, uint64_t denominator ) {
+	ftdc_period result = { 0, 0 };
+	denominator /= ftdc_GCD( numerator, denominator );  // Only reduced denominator matters.
+	result.pre_period = ftdc_strip_2_5( &denominator );
+
+	// What is left, repeats with period of `10^k = 1 (mod m)`.
+	if ( denominator > 1 )  result.period = ftdc_order10( denominator );
+	return result;
+}
+
+// Same as `ftdc_find_period`, for the expansion in `base`:  1 / 3  =  0.(5) in hexadecimal  ->  period 1
+ftdc_period ftdc_find_period_base( uint64_t numerator, uint64_t denominator, int base ) {
+	ftdc_period result = { 0, 0 };
+	denominator /= ftdc_GCD( numerator, denominator );
+	result.pre_period = ftdc_strip_base( &denominator, base );
+	if ( denominator > 1 )  result.period = ftdc_order( base, denominator );
+	return result;
+}
+
+// Finds period of `numerator / denominator` (after integer extraction) into `*period`.
+// Returns true if pre-period and one period fit into `*digits_max`, and lowers it to exactly that many digits.
+bool ftdc_fit_period( uint64_t numerator, uint64_t denominator, uint64_t *digits_max, ftdc_period *period ) {
+	*period = ftdc_find_period( numerator, denominator );
+	if ( period->pre_period + period->period > *digits_max )  return false;
+	*digits_max = period->pre_period + period->period;
+	return true;
+}
+
+// Threads only pay off when each gets at least this many digits to compute.
+#define FTDC_THREAD_DIGITS_MIN ( 1llu << 16 )
+
+typedef struct ftdc_fraction_job {
+	char    *out;          // Where the first digit of this slice goes.
+	uint64_t numerator;
+	uint64_t denominator;
+	uint64_t position;     // 1-based position of the first digit of this slice.
+	uint64_t count;        // Digits in this slice.
+	uint64_t written;      // Out.  Digits actually written.
+	const ftdc_radix *radix;  // Base of the digits, NULL for decimal.
+} ftdc_fraction_job;
+
+static void ftdc_fraction_job_run( ftdc_fraction_job *job ) {
+	if ( job->radix != NULL ) {
+		uint64_t remainder = ftdc_seek_remainder_base( job->numerator, job->denominator, job->position, job->radix->base );
+		job->written = ftdc_compute_fraction_radix( job->out, job->count, &remainder, job->denominator, job->radix );
+		return;
+	}
+	uint64_t remainder = ftdc_seek_remainder( job->numerator, job->denominator, job->position );
+	job->written = ftdc_compute_fraction( job->out, job->count, &remainder, job->denominator );
+}
+
+#if defined( _WIN32 )
+static DWORD WINAPI ftdc_fraction_job_thread( LPVOID job ) {
+	ftdc_fraction_job_run( ( ftdc_fraction_job * )job );
+	return 0;
+}
+#else
+static void *ftdc_fraction_job_thread( void *job ) {
+	ftdc_fraction_job_run( ( ftdc_fraction_job * )job );
+	return NULL;
+}
+#endif
+
+// Returns how many of `count` fractional digits from `position` (1-based) exist,
+//   e.g. how many are left before a terminating fraction ends:  1 / 8  =  0.125  ->  3 digits at most.
+uint64_t ftdc_fraction_length( uint64_t numerator, uint64_t denominator, uint64_t position, uint64_t count ) {
+	if ( numerator == 0 )  return 0;
+	uint64_t stripped = denominator / ftdc_GCD( numerator, denominator );
+	uint64_t length = ftdc_strip_2_5( &stripped );
+	if ( stripped == 1 ) {
+		if ( position > length )  return 0;
+		if ( count > length - position + 1 )  count = length - position + 1;
+	}
+	return count;
+}
+
+// Same as `ftdc_fraction_length`, for digits in `base`.
+static uint64_t ftdc_fraction_length_base( uint64_t numerator, uint64_t denominator, uint64_t position, uint64_t count,
+	int base )
+{
+	if ( numerator == 0 )  return 0;
+	uint64_t stripped = denominator / ftdc_GCD( numerator, denominator );
+	uint64_t length = ftdc_strip_base( &stripped, base );
+	if ( stripped == 1 ) {
+		if ( position > length )  return 0;
+		if ( count > length - position + 1 )  count = length - position + 1;
+	}
+	return count;
+}
+
+// Returns number of online CPU cores, at least 1.
+int ftdc_cpu_count( void ) {
+#if defined( _WIN32 )
+	SYSTEM_INFO info;
+	GetSystemInfo( &info );
+	return ( int )info.dwNumberOfProcessors;
+#else
+	long count = sysconf( _SC_NPROCESSORS_ONLN );
+	return ( count > 0 ) ? ( int )count : 1;
+#endif
+}
+
+// Returns how many threads `count` digits are split across:  none gets fewer than `FTDC_THREAD_DIGITS_MIN`.
+static int ftdc_fraction_threads( uint64_t count, int threads_count ) {
+	if ( threads_count > FTDC_THREADS_MAX )  threads_count = FTDC_THREADS_MAX;
+	uint64_t threads_useful = count / FTDC_THREAD_DIGITS_MIN;
+	if ( threads_useful < ( uint64_t )threads_count )  threads_count = ( threads_useful > 0 ) ? ( int )threads_useful : 1;
+	return threads_count;
+}
+
+// Splits `count` digits (none of them past the end of the fraction) into jobs, one per thread.
+static uint64_t ftdc_compute_fraction_jobs( char *out, uint64_t count, uint64_t numerator, uint64_t denominator,
+	uint64_t position, int threads_count, const ftdc_radix *radix )
+{
+	threads_count = ftdc_fraction_threads( count, threads_count );
+
+	ftdc_fraction_job job = {
+		.out = out, .numerator = numerator, .denominator = denominator, .position = position, .count = count, .radix = radix
+	};
+	if ( threads_count <= 1 ) {
+		ftdc_fraction_job_run( &job );
+		return job.written;
+	}
+
+	// Slices are whole chunks, so only the last one can end with a partial chunk.
+	uint64_t chunk_digits = ( radix != NULL ) ? ( uint64_t )radix->chunk_digits : FTDC_CHUNK_DIGITS;
+	uint64_t chunks = ( count + chunk_digits - 1 ) / chunk_digits;
+	uint64_t slice = ( ( chunks + threads_count - 1 ) / threads_count ) * chunk_digits;
+
+	ftdc_fraction_job jobs[ FTDC_THREADS_MAX ];
+#if defined( _WIN32 )
+	HANDLE threads[ FTDC_THREADS_MAX ];
+#else
+	pthread_t threads[ FTDC_THREADS_MAX ];
+#endif
+
+	bool started_threads[ FTDC_THREADS_MAX ];
+	int started = 0;
+	for ( uint64_t start = 0; start < count; start += slice ) {
+		ftdc_fraction_job *slice_job = &jobs[ started ];
+		*slice_job = job;
+		slice_job->out = out + start;
+		slice_job->position = position + start;
+		slice_job->count = ( count - start < slice ) ? count - start : slice;
+		FTDC_TRACE( "Thread %d:  digits [%llu; %llu)", started, ( unsigned long long )slice_job->position,
+			( unsigned long long )( slice_job->position + slice_job->count ) );
+#if defined( _WIN32 )
+		threads[ started ] = CreateThread( NULL, 0, ftdc_fraction_job_thread, slice_job, 0, NULL );
+		bool failed = ( threads[ started ] == NULL );
+#else
+		bool failed = ( pthread_create( &threads[ started ], NULL, ftdc_fraction_job_thread, slice_job ) != 0 );
+#endif
+		if ( failed ) {
+			// Out of threads, compute the rest of the slices on this one.
+			FTDC_TRACE( "Could not start thread %d of %d, computing slice on calling thread.", started + 1, threads_count );
+			ftdc_fraction_job_run( slice_job );
+		}
+		started_threads[ started ] = !failed;
+		started += 1;
+	}
+
+	// Slices are adjacent in `out`, joining them in order is just waiting for them.
+	uint64_t written = 0;
+	for ( int i = 0; i < started; i += 1 ) {
+		if ( started_threads[ i ] ) {
+#if defined( _WIN32 )
+			WaitForSingleObject( threads[ i ], INFINITE );
+			CloseHandle( threads[ i ] );
+#else
+			pthread_join( threads[ i ], NULL );
+#endif
+		}
+		written = ( jobs[ i ].out - out ) + jobs[ i ].written;
+	}
+
+	return written;
+}
+
+// Computes up to `count` fractional digits of `numerator / denominator` (`numerator < denominator`),
+//   starting from the `position`-th (1-based) digit, on up to `threads_count` threads.
+// Every position's remainder can be seeded independently, so the range is split into
+//   slices that each thread computes straight into its own part of `out`.
+// Digits past the end of a terminating fraction are not computed.  Returns digits written.
+uint64_t ftdc_compute_fraction_parallel( char *out, uint64_t count, uint64_t numerator, uint64_t denominator,
+	uint64_t position, int threads_count )
+{
+	count = ftdc_fraction_length( numerator, denominator, position, count );
+	return ftdc_compute_fraction_jobs( out, count, numerator, denominator, position, threads_count, NULL );
+}
+
+// `ftdc_compute_fraction_parallel`, counted in `stats` if not NULL.
+uint64_t ftdc_compute_fraction_counted( char *out, uint64_t count, uint64_t numerator, uint64_t denominator,
+	uint64_t position, int threads_count, ftdc_stats *stats )
+{
+	uint64_t written = ftdc_compute_fraction_parallel( out, count, numerator, denominator, position, threads_count );
+	ftdc_stats_count_fraction( stats, written, ftdc_fraction_threads( written, threads_count ) );
+	return written;
+}
+
+// `ftdc_compute_fraction_counted` for digits in `base` (`FTDC_BASE_MIN` to `FTDC_BASE_MAX`, 0 is the same as 10).
+uint64_t ftdc_compute_fraction_base( char *out, uint64_t count, uint64_t numerator, uint64_t denominator,
+	uint64_t position, int base, int threads_count, ftdc_stats *stats )
+{
+	if ( base == 0 || base == 10 ) {
+		return ftdc_compute_fraction_counted( out, count, numerator, denominator, position, threads_count, stats );
+	}
+	ftdc_radix radix;
+	ftdc_radix_init( &radix, base );
+	count = ftdc_fraction_length_base( numerator, denominator, position, count, base );
+	uint64_t written = ftdc_compute_fraction_jobs( out, count, numerator, denominator, position, threads_count, &radix );
+	if ( stats != NULL ) {
+		stats->digits += written;
+		stats->divisions += ( written + radix.chunk_digits - 1 ) / radix.chunk_digits;
+		stats->seeks += ftdc_fraction_threads( written, threads_count );
+	}
+	return written;
+}
+
+/* Pattern search */
+
+// Digits computed and searched at once, per thread:  fit into L2 cache along with the patterns.
+#define FTDC_FIND_BLOCK_DIGITS ( 1llu << 17 )
+
+// Searches fractional digits of `numerator / denominator` for the first occurrence of every pattern,
+//   from digit `options->offset` on, for at most `options->precision` digits.
+// Digits are computed block by block and never kept whole.  The tail of each block is carried into the next one,
+//   so matches across block boundaries are found too.
+// Search stops early once every pattern is found, or once it is proven that patterns left never appear:
+//   the expansion ends, or pre-period, a whole period and a pattern's length after it are searched.
+ftdc_status ftdc_find( uint64_t numerator, uint64_t denominator, const char *const *patterns, int patterns_count,
+	const ftdc_options *options, ftdc_find_result *result )
+{
+	if ( options == NULL || result == NULL || patterns == NULL )  return FTDC_ERR_INVALID_ARGUMENT;
+	if ( patterns_count < 1 || patterns_count > FTDC_FIND_PATTERNS_MAX )  return FTDC_ERR_INVALID_ARGUMENT;
+	if ( denominator == 0 )  return FTDC_ERR_DENOMINATOR_ZERO;
+	size_t lengths[ FTDC_FIND_PATTERNS_MAX ];
+	size_t length_max = 0;
+	for ( int i = 0; i < patterns_count; i += 1 ) {
+		lengths[ i ] = strlen( patterns[ i ] );
+		if ( lengths[ i ] == 0 || lengths[ i ] > FTDC_FIND_PATTERN_DIGITS_MAX )  return FTDC_ERR_INVALID_ARGUMENT;
+		if ( strspn( patterns[ i ], "0123456789" ) != lengths[ i ] )  return FTDC_ERR_INVALID_ARGUMENT;
+		if ( lengths[ i ] > length_max )  length_max = lengths[ i ];
+	}
+	memset( result, 0, sizeof( *result ) );
+	uint64_t offset = ( options->offset > 1 ) ? options->offset : 1;
+	ftdc_stats *stats = options->stats;
+	uint64_t phase_start = ( stats != NULL ) ? ftdc_ticks() : 0;
+
+	ftdc_simplify( &numerator, &denominator );
+	ftdc_extract_integer( &numerator, denominator );
+	if ( numerator == 0 ) {
+		result->exhausted = true;  // No fractional digits at all.
+		return FTDC_OK;
+	}
+
+	// From digit `pre_period + 1` on, digits repeat every `period`:  a match starting anywhere later
+	//   has a copy starting within the first period, so searching past it can not find anything new.
+	uint64_t limit = options->precision;
+	bool exhausted_at_limit = false;
+	result->period = ftdc_find_period( numerator, denominator );
+	if ( result->period.period > 0 ) {
+		uint64_t repeat_start = ( offset > result->period.pre_period ) ? offset : result->period.pre_period + 1;
+		uint64_t starts = repeat_start - offset + result->period.period;
+		uint64_t digits = ( starts > UINT64_MAX - length_max ) ? UINT64_MAX : starts + length_max - 1;
+		if ( digits <= limit ) {
+			limit = digits;
+			exhausted_at_limit = true;
+		}
+	}
+	ftdc_stats_phase( stats, FTDC_PHASE_FORMAT, &phase_start );
+
+	uint64_t block_digits = FTDC_FIND_BLOCK_DIGITS * ( ( options->threads_count > 1 ) ? options->threads_count : 1 );
+	char *buffer = FTDC_ALLOC( length_max - 1 + block_digits, char );
+	if ( buffer == NULL )  return FTDC_ERR_OUT_OF_MEMORY;
+
+	int found = 0;
+	size_t carry = 0;  // Last digits of the previous block, at the start of `buffer`.
+	while ( result->searched < limit ) {
+		uint64_t position = offset + result->searched;
+		uint64_t count = ( limit - result->searched < block_digits ) ? limit - result->searched : block_digits;
+		uint64_t written = ftdc_compute_fraction_counted( buffer + carry, count, numerator, denominator,
+			position, options->threads_count, stats );
+		ftdc_stats_phase( stats, FTDC_PHASE_FRACTION, &phase_start );
+
+		// Patterns not found yet have no match entirely within the carried digits, those are only searched again
+		//   as starts of matches ending in this block.
+		size_t size = carry + written;
+		for ( int i = 0; i < patterns_count; i += 1 ) {
+			if ( result->positions[ i ] != 0 )  continue;
+			size_t index = ftdc_find_pattern( buffer, size, patterns[ i ], lengths[ i ] );
+			if ( index == SIZE_MAX )  continue;
+			result->positions[ i ] = position - carry + index;
+			found += 1;
+		}
+		ftdc_stats_phase( stats, FTDC_PHASE_OUTPUT, &phase_start );  // Searching is what `--find` outputs.
+		result->searched += written;
+		if ( found == patterns_count )  break;
+		if ( written < count ) {
+			result->exhausted = true;  // Fraction has ended.
+			break;
+		}
+
+		carry = ( size < length_max - 1 ) ? size : length_max - 1;
+		memmove( buffer, buffer + size - carry, carry );
+	}
+	if ( result->searched == limit && exhausted_at_limit )  result->exhausted = true;
+	if ( stats != NULL )  stats->conversions += 1;
+
+	FTDC_FREE( buffer );
+	return FTDC_OK;
+}
+
+/* Digit histogram */
+
+// Digits counted on one thread:  computed block by block into a buffer that stays in cache.
+typedef struct ftdc_histogram_job {
+	uint64_t       numerator;
+	uint64_t       denominator;
+	uint64_t       position;   // 1-based position of the first digit of this slice.
+	uint64_t       count;      // Digits in this slice.
+	bool           pairs;
+	ftdc_histogram histogram;  // Out.
+	char           first;      // Out.  First and last digit, to count pairs across slices.
+	char           last;
+} ftdc_histogram_job;
+
+static void ftdc_histogram_job_run( ftdc_histogram_job *job ) {
+	memset( &job->histogram, 0, sizeof( job->histogram ) );
+	char buffer[ FTDC_FIND_BLOCK_DIGITS ];  // Never fewer than `FTDC_CHUNK_DIGITS`.
+	ftdc_divider divider;
+	ftdc_divider_init( &divider, job->denominator );
+	uint64_t remainder = ftdc_seek_remainder( job->numerator, job->denominator, job->position );
+	char previous = 0;
+	while ( job->histogram.count < job->count ) {
+		uint64_t left = job->count - job->histogram.count;
+		uint64_t written = ftdc_compute_fraction_div( buffer, ( left < sizeof( buffer ) ) ? left : sizeof( buffer ),
+			&remainder, &divider );
+		if ( written == 0 )  break;
+		ftdc_count_digits( buffer, written, job->histogram.digits );
+		if ( job->pairs ) {
+			if ( previous != 0 )  job->histogram.pairs[ ( previous - '0' ) * 10 + buffer[ 0 ] - '0' ] += 1;
+			for ( uint64_t i = 1; i < written; i += 1 ) {
+				job->histogram.pairs[ ( buffer[ i - 1 ] - '0' ) * 10 + buffer[ i ] - '0' ] += 1;
+			}
+		}
+		if ( job->histogram.count == 0 )  job->first = buffer[ 0 ];
+		previous = buffer[ written - 1 ];
+		job->histogram.count += written;
+	}
+	job->last = previous;
+	job->histogram.computed = job->histogram.count;
+}
+
+#if defined( _WIN32 )
+static DWORD WINAPI ftdc_histogram_job_thread( LPVOID job ) {
+	ftdc_histogram_job_run( ( ftdc_histogram_job * )job );
+	return 0;
+}
+#else
+static void *ftdc_histogram_job_thread( void *job ) {
+	ftdc_histogram_job_run( ( ftdc_histogram_job * )job );
+	return NULL;
+}
+#endif
+
+// Adds `times` copies of `part`'s counts to `histogram`.
+static void ftdc_histogram_add( ftdc_histogram *histogram, const ftdc_histogram *part, uint64_t times ) {
+	for ( int i = 0; i < 10; i += 1 )   histogram->digits[ i ] += part->digits[ i ] * times;
+	for ( int i = 0; i < 100; i += 1 )  histogram->pairs[ i ] += part->pairs[ i ] * times;
+	histogram->count += part->count * times;
+}
+
+// Counts `count` digits from `position` into `*histogram`, on up to `threads_count` threads.  Same split
+//   as `ftdc_compute_fraction_parallel`, but each thread counts its own slice, no digits are kept.
+// `*first` and `*last` get the first and last digit counted, 0 if none.
+static void ftdc_histogram_range( uint64_t numerator, uint64_t denominator, uint64_t position, uint64_t count,
+	bool pairs, int threads_count, ftdc_histogram *histogram, char *first, char *last, ftdc_stats *stats )
+{
+	memset( histogram, 0, sizeof( *histogram ) );
+	*first = 0;
+	*last = 0;
+	threads_count = ftdc_fraction_threads( count, threads_count );
+	uint64_t slice = ( count + threads_count - 1 ) / threads_count;
+
+	ftdc_histogram_job jobs[ FTDC_THREADS_MAX ];
+#if defined( _WIN32 )
+	HANDLE threads[ FTDC_THREADS_MAX ];
+#else
+	pthread_t threads[ FTDC_THREADS_MAX ];
+#endif
+	bool started_threads[ FTDC_THREADS_MAX ];
+	int started = 0;
+	for ( uint64_t start = 0; start < count; start += slice ) {
+		ftdc_histogram_job *job = &jobs[ started ];
+		*job = ( ftdc_histogram_job ){
+			.numerator = numerator, .denominator = denominator, .position = position + start,
+			.count = ( count - start < slice ) ? count - start : slice, .pairs = pairs
+		};
+		bool failed = true;
+		if ( threads_count > 1 ) {
+#if defined( _WIN32 )
+			threads[ started ] = CreateThread( NULL, 0, ftdc_histogram_job_thread, job, 0, NULL );
+			failed = ( threads[ started ] == NULL );
+#else
+			failed = ( pthread_create( &threads[ started ], NULL, ftdc_histogram_job_thread, job ) != 0 );
+#endif
+		}
+		if ( failed )  ftdc_histogram_job_run( job );  // Single slice, or out of threads.
+		started_threads[ started ] = !failed;
+		started += 1;
+	}
+
+	for ( int i = 0; i < started; i += 1 ) {
+		if ( started_threads[ i ] ) {
+#if defined( _WIN32 )
+			WaitForSingleObject( threads[ i ], INFINITE );
+			CloseHandle( threads[ i ] );
+#else
+			pthread_join( threads[ i ], NULL );
+#endif
+		}
+		if ( jobs[ i ].histogram.count == 0 )  continue;
+		ftdc_histogram_add( histogram, &jobs[ i ].histogram, 1 );
+		if ( pairs && *last != 0 )  histogram->pairs[ ( *last - '0' ) * 10 + jobs[ i ].first - '0' ] += 1;
+		if ( *first == 0 )  *first = jobs[ i ].first;
+		*last = jobs[ i ].last;
+	}
+	histogram->computed = histogram->count;
+	ftdc_stats_count_fraction( stats, histogram->computed, started );
+}
+
+// Counts how many times each digit (and each pair of adjacent digits, if `pairs`) occurs in fractional digits
+//   of `numerator / denominator`, from digit `options->offset` on, up to `options->precision` digits.
+// Digits past the end of a terminating fraction are not counted.
+// Once the expansion repeats, a whole period counts the same wherever it starts:  ranges of at least two periods
+//   only compute the digits before it, one period and the part of a period left over, whatever the precision.
+ftdc_status ftdc_histogram_digits( uint64_t numerator, uint64_t denominator, const ftdc_options *options, bool pairs,
+	ftdc_histogram *histogram )
+{
+	if ( options == NULL || histogram == NULL )  return FTDC_ERR_INVALID_ARGUMENT;
+	if ( denominator == 0 )  return FTDC_ERR_DENOMINATOR_ZERO;
+	memset( histogram, 0, sizeof( *histogram ) );
+	uint64_t offset = ( options->offset > 1 ) ? options->offset : 1;
+	ftdc_stats *stats = options->stats;
+	uint64_t phase_start = ( stats != NULL ) ? ftdc_ticks() : 0;
+
+	ftdc_simplify( &numerator, &denominator );
+	ftdc_extract_integer( &numerator, denominator );
+	uint64_t count = ftdc_fraction_length( numerator, denominator, offset, options->precision );
+	if ( count == 0 )  return FTDC_OK;
+	histogram->period = ftdc_find_period( numerator, denominator );
+	ftdc_stats_phase( stats, FTDC_PHASE_FORMAT, &phase_start );
+
+	// Digits from `repeat_start` on repeat every period.  Their pairs do too, including the one
+	//   wrapping from the end of a period to the start of the next.
+	const ftdc_period *period = &histogram->period;
+	uint64_t repeat_start = ( offset > period->pre_period ) ? offset : period->pre_period + 1;
+	uint64_t repeating = ( repeat_start - offset < count ) ? count - ( repeat_start - offset ) : 0;
+	char first, last;
+	if ( period->period == 0 || repeating / period->period < 2 ) {
+		ftdc_histogram all;
+		ftdc_histogram_range( numerator, denominator, offset, count, pairs, options->threads_count,
+			&all, &first, &last, stats );
+		ftdc_histogram_add( histogram, &all, 1 );
+		histogram->computed = all.computed;
+	} else {
+		ftdc_histogram before;
+		char before_last;
+		ftdc_histogram_range( numerator, denominator, offset, repeat_start - offset, pairs, options->threads_count,
+			&before, &first, &before_last, stats );
+		ftdc_histogram once;
+		char once_first, once_last;
+		ftdc_histogram_range( numerator, denominator, repeat_start, period->period, pairs, options->threads_count,
+			&once, &once_first, &once_last, stats );
+
+		// Digits:  whole periods, then the first `repeating % period` digits of one more.
+		// Pairs:  `repeating - 1` of them, whole periods of pairs including the wrapping one,
+		//   then the pairs within the first `( repeating - 1 ) % period + 1` digits.
+		uint64_t whole = repeating / period->period;
+		uint64_t tail = repeating % period->period;
+		ftdc_histogram tail_part = once;
+		if ( tail > 0 ) {
+			char tail_first, tail_last;
+			ftdc_histogram_range( numerator, denominator, repeat_start, tail, pairs, options->threads_count,
+				&tail_part, &tail_first, &tail_last, stats );
+		}
+		uint64_t pair_wholes = ( tail > 0 ) ? whole : whole - 1;
+		ftdc_histogram_add( histogram, &before, 1 );
+		for ( int i = 0; i < 10; i += 1 )  histogram->digits[ i ] += once.digits[ i ] * whole + ( ( tail > 0 ) ? tail_part.digits[ i ] : 0 );
+		histogram->count += repeating;
+		if ( pairs ) {
+			for ( int i = 0; i < 100; i += 1 )  histogram->pairs[ i ] += once.pairs[ i ] * pair_wholes + tail_part.pairs[ i ];
+			histogram->pairs[ ( once_last - '0' ) * 10 + once_first - '0' ] += pair_wholes;
+			if ( before.count > 0 )  histogram->pairs[ ( before_last - '0' ) * 10 + once_first - '0' ] += 1;
+		}
+		histogram->computed = before.computed + once.computed + ( ( tail > 0 ) ? tail_part.computed : 0 );
+	}
+	ftdc_stats_phase( stats, FTDC_PHASE_FRACTION, &phase_start );
+	if ( stats != NULL )  stats->conversions += 1;
+	return FTDC_OK;
+}
+
+/* Per-denominator cache */
+
+#define FTDC_CACHE_NONE UINT32_MAX
+
+// Fewer digits are computed directly, without finding out the period for them.
+#define FTDC_CACHE_PERIOD_DIGITS_MIN 64
+
+// Layout of `ftdc_table.h`, bumped with every change to it or to how `ftdc_table_gen` computes it.
+#define FTDC_TABLE_VERSION 1
+
+#ifdef FTDC_TABLE
+// Compiled-in expansion of a small denominator  d  =  2^twos * 5^fives * m,  generated by `ftdc_table_gen`.
+typedef struct ftdc_table_row {
+	uint64_t reciprocal;  // Of `d`, as in `ftdc_divider`.
+	uint32_t repetend;    // Index of the repetend of  1 / m  in `ftdc_table_repetends`, UINT32_MAX if too long.
+	uint16_t period;
+	uint8_t  twos;
+	uint8_t  fives;
+} ftdc_table_row;
+
+#if defined( __has_include )
+	#if !__has_include( "ftdc_table.h" )
+		#error "FTDC_TABLE needs `ftdc_table.h`:  generate it first with `./ftdc_table_gen > ftdc_table.h`."
+	#endif
+#endif
+#include "ftdc_table.h"
+#if !defined( FTDC_TABLE_GEN_VERSION ) || FTDC_TABLE_GEN_VERSION != FTDC_TABLE_VERSION
+	#error "`ftdc_table.h` is stale:  regenerate it with `./ftdc_table_gen > ftdc_table.h`."
+#endif
+
+// Fills `entry` for `denominator < FTDC_TABLE_SIZE` from the table:  lookups only, nothing is computed.
+static void ftdc_table_fill( ftdc_cache_entry *entry, uint64_t denominator ) {
+	const ftdc_table_row *row = &ftdc_table[ denominator ];
+	uint64_t fives = 1;
+	for ( int i = 0; i < row->fives; i += 1 )  fives *= 5;
+	int shift = __builtin_clzll( denominator );
+	entry->denominator = denominator;
+	entry->stripped = ( denominator >> row->twos ) / fives;
+	entry->divider.divisor = denominator;
+	entry->divider.normalized = denominator << shift;
+	entry->divider.reciprocal = row->reciprocal;
+	entry->divider.shift = shift;
+	entry->period.pre_period = ( row->twos > row->fives ) ? row->twos : row->fives;
+	entry->period.period = row->period;
+	entry->period_found = true;
+	// Read-only data, never written through:  only cache entries build their own repetends.
+	entry->repetend = ( row->repetend != UINT32_MAX ) ? ( uint64_t * )&ftdc_table_repetends[ row->repetend ] : NULL;
+}
+#endif
+
+// Creates cache of up to `capacity` denominators, keeping repetends of up to `repetend_digits_max` digits.
+// Returns NULL if out of memory.
+ftdc_cache *ftdc_cache_create( uint32_t capacity, uint64_t repetend_digits_max ) {
+	if ( capacity == 0 )  return NULL;
+	uint32_t buckets_count = 1;
+	while ( buckets_count < 2 * capacity )  buckets_count <<= 1;  // Load factor <= 0.5
+
+	ftdc_cache *cache = FTDC_ALLOC( 1, ftdc_cache );
+	if ( cache == NULL )  return NULL;
+	memset( cache, 0, sizeof( *cache ) );
+	cache->entries = FTDC_ALLOC( capacity, ftdc_cache_entry );
+	cache->buckets = FTDC_ALLOC( buckets_count, uint32_t );
+	cache->scratch = FTDC_ALLOC( repetend_digits_max + FTDC_CHUNK_DIGITS, char );
+	if ( cache->entries == NULL || cache->buckets == NULL || cache->scratch == NULL ) {
+		ftdc_cache_destroy( cache );
+		return NULL;
+	}
+	memset( cache->buckets, 0xFF, buckets_count * sizeof( uint32_t ) );  // FTDC_CACHE_NONE
+	cache->buckets_mask = buckets_count - 1;
+	cache->capacity = capacity;
+	cache->lru_head = cache->lru_tail = FTDC_CACHE_NONE;
+	cache->repetend_digits_max = repetend_digits_max;
+	return cache;
+}
+
+void ftdc_cache_destroy( ftdc_cache *cache ) {
+	if ( cache == NULL )  return;
+	if ( cache->entries != NULL ) {
+		for ( uint32_t i = 0; i < cache->count; i += 1 )  FTDC_FREE( cache->entries[ i ].repetend );
+	}
+	FTDC_FREE( cache->entries );
+	FTDC_FREE( cache->buckets );
+	FTDC_FREE( cache->scratch );
+	FTDC_FREE( cache );
+}
+
+static uint32_t ftdc_cache_bucket( const ftdc_cache *cache, uint64_t denominator ) {
+	return ( uint32_t )( ( denominator * 0x9E3779B97F4A7C15llu ) >> 32 ) & cache->buckets_mask;  // Fibonacci hashing
+}
+
+static void ftdc_cache_lru_unlink( ftdc_cache *cache, uint32_t index ) {
+	ftdc_cache_entry *entry = &cache->entries[ index ];
+	if ( entry->lru_prev != FTDC_CACHE_NONE )  cache->entries[ entry->lru_prev ].lru_next = entry->lru_next;
+	else                                       cache->lru_head = entry->lru_next;
+	if ( entry->lru_next != FTDC_CACHE_NONE )  cache->entries[ entry->lru_next ].lru_prev = entry->lru_prev;
+	else                                       cache->lru_tail = entry->lru_prev;
+}
+
+static void ftdc_cache_lru_push( ftdc_cache *cache, uint32_t index ) {
+	ftdc_cache_entry *entry = &cache->entries[ index ];
+	entry->lru_prev = FTDC_CACHE_NONE;
+	entry->lru_next = cache->lru_head;
+	if ( cache->lru_head != FTDC_CACHE_NONE )  cache->entries[ cache->lru_head ].lru_prev = index;
+	cache->lru_head = index;
+	if ( cache->lru_tail == FTDC_CACHE_NONE )  cache->lru_tail = index;
+}
+
+// Fills what `entry` keeps about `denominator`:  the expensive part of every conversion over it.
+// Period is found on first use, repetend is kept once a whole period of digits is asked for.
+static void ftdc_cache_fill( ftdc_cache_entry *entry, uint64_t denominator ) {
+	entry->denominator = denominator;
+	entry->stripped = denominator;
+	entry->period.pre_period = ftdc_strip_2_5( &entry->stripped );
+	entry->period.period = 0;
+	entry->period_found = ( entry->stripped == 1 );  // Terminates.
+	ftdc_divider_init( &entry->divider, denominator );
+	entry->repetend = NULL;
+}
+
+// Returns period of `entry`, finding it on first use.
+static const ftdc_period *ftdc_cache_period( const ftdc_cache_entry *entry ) {
+	if ( !entry->period_found ) {
+		ftdc_cache_entry *mutable_entry = ( ftdc_cache_entry * )entry;
+		mutable_entry->period.period = ftdc_order10( entry->stripped );
+		mutable_entry->period_found = true;
+	}
+	return &entry->period;
+}
+
+// Keeps repetend of `1 / m` in `entry`.  Returns false if it is too long or out of memory.
+// 1 / m  =  R / ( 10^L - 1 ):  kept as the integer R, so the repetend of any r / m is just  r * R.
+static bool ftdc_cache_keep_repetend( ftdc_cache *cache, ftdc_cache_entry *entry ) {
+	uint64_t length = entry->period.period;
+	if ( length == 0 || length > cache->repetend_digits_max )  return false;
+	uint64_t limbs = ( length + FTDC_CHUNK_DIGITS - 1 ) / FTDC_CHUNK_DIGITS;
+	entry->repetend = FTDC_ALLOC( limbs, uint64_t );
+	if ( entry->repetend == NULL )  return false;  // Works without it, only slower.
+
+	uint64_t remainder = 1;
+	ftdc_compute_fraction( cache->scratch, length, &remainder, entry->stripped );
+	for ( uint64_t i = 0; i < limbs; i += 1 ) {
+		// Limb `i` holds digits ( length - 19 * ( i + 1 ); length - 19 * i ].
+		uint64_t end = length - i * FTDC_CHUNK_DIGITS;
+		uint64_t start = ( end > FTDC_CHUNK_DIGITS ) ? end - FTDC_CHUNK_DIGITS : 0;
+		uint64_t limb = 0;
+		for ( uint64_t j = start; j < end; j += 1 )  limb = limb * 10 + ( cache->scratch[ j ] - '0' );
+		entry->repetend[ i ] = limb;
+	}
+	return true;
+}
+
+// Returns cache entry of (reduced) `denominator`, filling it on a miss, evicting the least recently used one if full.
+const ftdc_cache_entry *ftdc_cache_lookup( ftdc_cache *cache, uint64_t denominator ) {
+	uint32_t *bucket = &cache->buckets[ ftdc_cache_bucket( cache, denominator ) ];
+	for ( uint32_t index = *bucket; index != FTDC_CACHE_NONE; index = cache->entries[ index ].hash_next ) {
+		if ( cache->entries[ index ].denominator == denominator ) {
+			cache->hits += 1;
+			if ( cache->lru_head != index ) {
+				ftdc_cache_lru_unlink( cache, index );
+				ftdc_cache_lru_push( cache, index );
+			}
+			return &cache->entries[ index ];
+		}
+	}
+
+	cache->misses += 1;
+	uint32_t index;
+	if ( cache->count < cache->capacity ) {
+		index = cache->count;
+		cache->count += 1;
+	} else {
+		// Evict the least recently used entry:  unlink it from its bucket and the LRU list.
+		index = cache->lru_tail;
+		ftdc_cache_entry *victim = &cache->entries[ index ];
+		uint32_t *link = &cache->buckets[ ftdc_cache_bucket( cache, victim->denominator ) ];
+		while ( *link != index )  link = &cache->entries[ *link ].hash_next;
+		*link = victim->hash_next;
+		ftdc_cache_lru_unlink( cache, index );
+		FTDC_FREE( victim->repetend );
+		cache->evictions += 1;
+	}
+
+	ftdc_cache_entry *entry = &cache->entries[ index ];
+	ftdc_cache_fill( entry, denominator );
+	entry->hash_next = *bucket;
+	*bucket = index;
+	ftdc_cache_lru_push( cache, index );
+	return entry;
+}
+
+// Writes the repetend of `r / m` (`r < m`) into `out`:  `r * R`, zero-padded to period length.
+// One multiplication by the numerator per 19 digits, instead of a division by the denominator.
+static void ftdc_scale_repetend( char *out, const ftdc_cache_entry *entry, uint64_t r ) {
+	uint64_t length = entry->period.period;
+	uint64_t limbs = ( length + FTDC_CHUNK_DIGITS - 1 ) / FTDC_CHUNK_DIGITS;
+	int top_digits = ( int )( length - ( limbs - 1 ) * FTDC_CHUNK_DIGITS );
+	ftdc_divider chunk_divider;
+	ftdc_divider_init( &chunk_divider, ftdc_pow10[ FTDC_CHUNK_DIGITS ] );
+
+	// r * R  <  10^L - 1,  so the product has exactly as many 10^19 limbs, and the last carry is 0.
+	// Written from the least significant limb (the end of the repetend) backwards.
+	uint64_t carry = 0;
+	for ( uint64_t i = 0; i < limbs; i += 1 ) {
+		ftdc_u128 product = ( ftdc_u128 )entry->repetend[ i ] * r + carry;
+		uint64_t limb;
+		carry = ftdc_divider_div( &chunk_divider, ( uint64_t )( product >> 64 ), ( uint64_t )product, &limb );
+		if ( i + 1 < limbs )  ftdc_write_chunk( out + length - ( i + 1 ) * FTDC_CHUNK_DIGITS, limb );
+		else                  ftdc_write_chunk_partial( out, limb, top_digits );
+	}
+}
+
+// Same as `ftdc_compute_fraction_parallel`, with everything about the denominator taken from `entry`
+//   (of `cache`, or filled from the table when `cache` is NULL).
+// Pre-period digits are computed with the kept reciprocal.  Periodic digits, if at least a whole period of them
+//   is needed, come from the kept repetend scaled by the remainder at the first of them, and then repeat by copying.
+static uint64_t ftdc_cache_compute_fraction( ftdc_cache *cache, const ftdc_cache_entry *entry, char *out, uint64_t count,
+	uint64_t numerator, uint64_t position, int threads_count, ftdc_stats *stats )
+{
+	if ( entry->stripped != 1 && count < FTDC_CACHE_PERIOD_DIGITS_MIN ) {
+		// Not worth finding out period for.
+		uint64_t remainder = ftdc_seek_remainder( numerator, entry->denominator, position );
+		uint64_t written = ftdc_compute_fraction_div( out, count, &remainder, &entry->divider );
+		ftdc_stats_count_fraction( stats, written, 1 );
+		return written;
+	}
+	uint64_t pre_period = entry->period.pre_period;
+	uint64_t period = ftdc_cache_period( entry )->period;
+	bool repetend_kept = ( entry->repetend != NULL ) || ( cache != NULL && period <= cache->repetend_digits_max );
+	if ( period == 0 || !repetend_kept || ( threads_count > 1 && count < period ) ) {
+		// Terminating fractions and ones with too long repetend take the usual path,
+		//   as do parts shorter than a period, when threads can split them.
+		return ftdc_compute_fraction_counted( out, count, numerator, entry->denominator, position, threads_count, stats );
+	}
+
+	uint64_t written = 0;
+	if ( position <= pre_period ) {
+		uint64_t remainder = ftdc_seek_remainder( numerator, entry->denominator, position );
+		uint64_t pre_count = pre_period - position + 1;
+		written = ftdc_compute_fraction_div( out, ( count < pre_count ) ? count : pre_count, &remainder, &entry->divider );
+		ftdc_stats_count_fraction( stats, written, 1 );
+	}
+	uint64_t left = count - written;
+	if ( left == 0 )  return written;
+	uint64_t remainder = ftdc_seek_remainder( numerator, entry->denominator, position + written );
+	if ( left < period || ( entry->repetend == NULL && !ftdc_cache_keep_repetend( cache, ( ftdc_cache_entry * )entry ) ) ) {
+		// Scaling the whole repetend is not worth it for a part of it.
+		uint64_t left_written = ftdc_compute_fraction_div( out + written, left, &remainder, &entry->divider );
+		ftdc_stats_count_fraction( stats, left_written, 1 );
+		return written + left_written;
+	}
+
+	// Past pre-period the fraction is purely periodic:  r / d  =  r' / m,  and its next period of digits is r' * R.
+	char *periodic = out + written;
+	ftdc_scale_repetend( periodic, entry, remainder / ( entry->denominator / entry->stripped ) );
+
+	// The rest are copies of it, doubling each time.
+	uint64_t copied = period;
+	while ( copied < left ) {
+		uint64_t part = ( copied < left - copied ) ? copied : left - copied;
+		memcpy( periodic + copied, periodic, part );
+		copied += part;
+	}
+	if ( stats != NULL ) {
+		stats->digits += left;  // Without a single division by the denominator.
+		stats->seeks += 1;
+	}
+	return count;
+}
+
+// Precisions up to this many digits take the short path of `ftdc_convert_cached`:  no long division,
+//   double precision gets the digits within one, and an exact check settles them.
+#define FTDC_SHORT_DIGITS_MAX 15
+
+// Computes `floor( numerator * 10^digits / denominator )` (`numerator < denominator`, `digits <= FTDC_SHORT_DIGITS_MAX`),
+//   all fractional digits of a short precision at once, and the remainder left after them.
+// Double quotient is off by four rounding errors of 2^-53 at most, less than one unit in the last digit below 10^16,
+//   so truncated estimate is the exact quotient or one off it.  Residue  numerator * 10^digits - q * denominator,
+//   exact in 128 bits, must land in [0; denominator) for the digits to be right, and corrects one that is off.
+// Returns false if it does not, which rounding never allows, and long division should take over.
+static bool ftdc_short_fraction( uint64_t numerator, uint64_t denominator, int digits,
+	uint64_t *quotient, uint64_t *remainder )
+{
+	double estimate = ( double )numerator / ( double )denominator * ( double )ftdc_pow10[ digits ];
+	uint64_t q = ( uint64_t )estimate;
+	ftdc_u128 scaled = ( ftdc_u128 )numerator * ftdc_pow10[ digits ];
+	ftdc_u128 product = ( ftdc_u128 )q * denominator;
+	if ( product > scaled ) {
+		q -= 1;
+		product -= denominator;
+	} else if ( scaled - product >= denominator ) {
+		q += 1;
+		product += denominator;
+	}
+	if ( product > scaled || scaled - product >= denominator )  return false;
+	*quotient = q;
+	*remainder = ( uint64_t )( scaled - product );
+	return true;
+}
+
+// `ftdc_convert_cached` for `options->base` other than 10:  same steps and notation, 3.249  or  0.(5)  or  3.[1000]249...
+// Repetends of such bases are not cached, and there is no short path.
+static ftdc_status ftdc_convert_radix( uint64_t numerator, uint64_t denominator, const ftdc_options *options,
+	char *out, size_t out_size, ftdc_result *result )
+{
+	const int base = options->base;
+	uint64_t offset = ( options->offset > 1 ) ? options->offset : 1;
+	ftdc_stats *stats = options->stats;
+	ftdc_stats *timed = ftdc_stats_timed( stats );
+	uint64_t phase_start = ( timed != NULL ) ? ftdc_ticks() : 0;
+
+	ftdc_result r = { 0 };
+	r.numerator = numerator;
+	r.denominator = denominator;
+	ftdc_simplify( &r.numerator, &r.denominator );
+	ftdc_stats_phase( timed, FTDC_PHASE_SIMPLIFY, &phase_start );
+	r.fraction_numerator = r.numerator;
+	r.integer = ftdc_extract_integer( &r.fraction_numerator, r.denominator );
+	ftdc_stats_phase( timed, FTDC_PHASE_INTEGER, &phase_start );
+
+	uint64_t digits = options->precision;
+	if ( options->repeating && offset == 1 && r.fraction_numerator != 0 ) {
+		r.period = ftdc_find_period_base( r.fraction_numerator, r.denominator, base );
+		r.repeating = ( r.period.pre_period + r.period.period <= digits );
+		if ( r.repeating )  digits = r.period.pre_period + r.period.period;
+		FTDC_TRACE( "Period in base %d:  %llu / %llu  ->  pre-period %llu, period %llu",
+			base, ( unsigned long long )r.fraction_numerator, ( unsigned long long )r.denominator,
+			( unsigned long long )r.period.pre_period, ( unsigned long long )r.period.period );
+	}
+	digits = ftdc_fraction_length_base( r.fraction_numerator, r.denominator, offset, digits, base );
+
+	char offset_str[ INT64_MAX_DIGITS ];
+	int offset_length = ( offset > 1 ) ? ftdc_append_uint64( offset_str, sizeof( offset_str ), 0, offset, 0 ) : 0;
+	char integer_str[ 64 ];
+	int integer_length = ftdc_append_uint64_base( integer_str, sizeof( integer_str ), 0, r.integer, base );
+
+	r.length = integer_length;
+	if ( r.fraction_numerator != 0 ) {
+		r.length += 1 /* '.' */ + digits;
+		if ( offset > 1 )                          r.length += 2 /* '[' ']' */ + offset_length;
+		if ( r.repeating && r.period.period > 0 )  r.length += 2 /* '(' ')' */;
+	}
+	*result = r;
+	ftdc_stats_phase( timed, FTDC_PHASE_FORMAT, &phase_start );
+	if ( out == NULL || out_size < r.length + 1 /* '\0' */ )  return FTDC_ERR_BUFFER_TOO_SMALL;
+
+	size_t cursor = 0;
+	memcpy( out, integer_str, integer_length );
+	cursor += integer_length;
+	if ( r.fraction_numerator != 0 ) {
+		cursor += ftdc_append_char( out, out_size, cursor, '.' );
+		if ( offset > 1 ) {
+			cursor += ftdc_append_char( out, out_size, cursor, '[' );
+			memcpy( out + cursor, offset_str, offset_length );
+			cursor += offset_length;
+			cursor += ftdc_append_char( out, out_size, cursor, ']' );
+		}
+		if ( r.repeating && r.period.period > 0 ) {
+			r.digits = ftdc_compute_fraction_base( out + cursor, r.period.pre_period,
+				r.fraction_numerator, r.denominator, 1, base, options->threads_count, stats );
+			cursor += r.digits;
+			cursor += ftdc_append_char( out, out_size, cursor, '(' );
+			uint64_t period_digits = ftdc_compute_fraction_base( out + cursor, r.period.period,
+				r.fraction_numerator, r.denominator, 1 + r.period.pre_period, base, options->threads_count, stats );
+			cursor += period_digits;
+			r.digits += period_digits;
+			cursor += ftdc_append_char( out, out_size, cursor, ')' );
+		} else {
+			r.digits = ftdc_compute_fraction_base( out + cursor, digits,
+				r.fraction_numerator, r.denominator, offset, base, options->threads_count, stats );
+			cursor += r.digits;
+		}
+	}
+	cursor += ftdc_append_char( out, out_size, cursor, '\0' );
+	ftdc_stats_phase( timed, FTDC_PHASE_FRACTION, &phase_start );
+	if ( stats != NULL )  stats->conversions += 1;
+
+	result->digits = r.digits;
+	return FTDC_OK;
+}
+
+// Converts `numerator / denominator` into decimal notation in `out`:  3.142857  or  0.08(3)  or  3.[1000]857...
+// Digits are in `options->base`, 10 unless set.
+// Never allocates.  Output is sized exactly up front, so with `out == NULL` it only fills `result`,
+//   including `result->length` to allocate for, and returns `FTDC_ERR_BUFFER_TOO_SMALL`.
+ftdc_status ftdc_convert_ex( uint64_t numerator, uint64_t denominator, const ftdc_options *options,
+	char *out, size_t out_size, ftdc_result *result )
+{
+	return ftdc_convert_cached( NULL, numerator, denominator, options, out, out_size, result );
+}
+
+// Same as `ftdc_convert_ex`, but period, reciprocal and repetend of the denominator come from `cache`
+//   (computed once per denominator), if it is not NULL.
+// Built with `FTDC_TABLE`, denominators below `FTDC_TABLE_SIZE` come from the compiled-in table instead, cache or not.
+ftdc_status ftdc_convert_cached( ftdc_cache *cache, uint64_t numerator, uint64_t denominator, const ftdc_options *options,
+	char *out, size_t out_size, ftdc_result *result )
+{
+	if ( options == NULL || result == NULL )  return FTDC_ERR_INVALID_ARGUMENT;
+	if ( denominator == 0 )  return FTDC_ERR_DENOMINATOR_ZERO;
+	if ( options->base != 0 && options->base != 10 ) {
+		if ( options->base < FTDC_BASE_MIN || options->base > FTDC_BASE_MAX )  return FTDC_ERR_INVALID_ARGUMENT;
+		return ftdc_convert_radix( numerator, denominator, options, out, out_size, result );
+	}
+	uint64_t offset = ( options->offset > 1 ) ? options->offset : 1;
+	ftdc_stats *stats = options->stats;
+	ftdc_stats *timed = ftdc_stats_timed( stats );
+	uint64_t phase_start = ( timed != NULL ) ? ftdc_ticks() : 0;
+
+	ftdc_result r = { 0 };
+	r.numerator = numerator;
+	r.denominator = denominator;
+
+	/* 1. Simplify fraction */
+
+	ftdc_simplify( &r.numerator, &r.denominator );
+	FTDC_TRACE( "1. Simplify:  %llu / %llu  ->  %llu / %llu",
+		( unsigned long long )numerator, ( unsigned long long )denominator,
+		( unsigned long long )r.numerator, ( unsigned long long )r.denominator );
+	ftdc_stats_phase( timed, FTDC_PHASE_SIMPLIFY, &phase_start );
+
+	/* 2. Extract integer part */
+
+	r.fraction_numerator = r.numerator;
+	r.integer = ftdc_extract_integer( &r.fraction_numerator, r.denominator );
+	FTDC_TRACE( "2. Extract integer:  %llu / %llu  ->  %llu  +  %llu / %llu",
+		( unsigned long long )r.numerator, ( unsigned long long )r.denominator,
+		( unsigned long long )r.integer, ( unsigned long long )r.fraction_numerator, ( unsigned long long )r.denominator );
+	ftdc_stats_phase( timed, FTDC_PHASE_INTEGER, &phase_start );
+
+	// Short precisions skip steps 3 and 4:  digits come out of a single quotient,
+	//   and its remainder tells whether the fraction ends within them (then trailing zeros are not printed).
+	uint64_t short_quotient, short_remainder;
+	if ( r.fraction_numerator != 0 && offset == 1 && !options->repeating
+		&& options->precision >= 1 && options->precision <= FTDC_SHORT_DIGITS_MAX
+		&& ftdc_short_fraction( r.fraction_numerator, r.denominator, ( int )options->precision,
+			&short_quotient, &short_remainder ) )
+	{
+		char digits_str[ FTDC_CHUNK_DIGITS ];
+		ftdc_write_chunk_partial( digits_str, short_quotient, ( int )options->precision );
+		uint64_t digits = options->precision;
+		if ( short_remainder == 0 ) {
+			while ( digits_str[ digits - 1 ] == '0' )  digits -= 1;
+		}
+		char integer_str[ INT64_MAX_DIGITS ];
+		int integer_length = ftdc_append_uint64( integer_str, sizeof( integer_str ), 0, r.integer, 0 );
+		r.length = integer_length + 1 /* '.' */ + digits;
+		*result = r;
+		ftdc_stats_phase( timed, FTDC_PHASE_FORMAT, &phase_start );
+		if ( out == NULL || out_size < r.length + 1 /* '\0' */ )  return FTDC_ERR_BUFFER_TOO_SMALL;
+
+		memcpy( out, integer_str, integer_length );
+		out[ integer_length ] = '.';
+		memcpy( out + integer_length + 1, digits_str, digits );
+		out[ r.length ] = '\0';
+		ftdc_stats_phase( timed, FTDC_PHASE_FRACTION, &phase_start );
+		// Counted like the chunk path:  one division by the denominator, at the start.
+		ftdc_stats_count_fraction( stats, digits, 1 );
+		if ( stats != NULL )  stats->conversions += 1;
+		result->digits = digits;
+		return FTDC_OK;
+	}
+
+	/* 3. Size output */
+
+	// Repeating decimals only need pre-period and one period of digits:  1 / 6  ->  0.1(6)
+	uint64_t digits = options->precision;
+	const ftdc_cache_entry *entry = NULL;
+#ifdef FTDC_TABLE
+	ftdc_cache_entry table_entry;
+	if ( r.fraction_numerator != 0 && r.denominator < FTDC_TABLE_SIZE ) {
+		ftdc_table_fill( &table_entry, r.denominator );
+		entry = &table_entry;
+		cache = NULL;  // Table entries are not the cache's to build repetends in.
+	} else
+#endif
+	if ( cache != NULL && r.fraction_numerator != 0 )  entry = ftdc_cache_lookup( cache, r.denominator );
+	if ( options->repeating && offset == 1 && entry != NULL ) {
+		// Fraction is reduced, so its period is the denominator's.
+		r.period = *ftdc_cache_period( entry );
+		r.repeating = ( r.period.pre_period + r.period.period <= digits );
+		if ( r.repeating )  digits = r.period.pre_period + r.period.period;
+	} else if ( options->repeating && offset == 1 && r.fraction_numerator != 0 ) {
+		r.repeating = ftdc_fit_period( r.fraction_numerator, r.denominator, &digits, &r.period );
+		FTDC_TRACE( "Period:  %llu / %llu  ->  pre-period %llu, period %llu",
+			( unsigned long long )r.fraction_numerator, ( unsigned long long )r.denominator,
+			( unsigned long long )r.period.pre_period, ( unsigned long long )r.period.period );
+	}
+	digits = ftdc_fraction_length( r.fraction_numerator, r.denominator, offset, digits );
+
+	char offset_str[ INT64_MAX_DIGITS ];
+	int offset_length = ( offset > 1 ) ? ftdc_append_uint64( offset_str, sizeof( offset_str ), 0, offset, 0 ) : 0;
+	char integer_str[ INT64_MAX_DIGITS ];
+	int integer_length = ftdc_append_uint64( integer_str, sizeof( integer_str ), 0, r.integer, 0 );
+
+	r.length = integer_length;
+	if ( r.fraction_numerator != 0 ) {
+		r.length += 1 /* '.' */ + digits;
+		if ( offset > 1 )                              r.length += 2 /* '[' ']' */ + offset_length;
+		if ( r.repeating && r.period.period > 0 )  r.length += 2 /* '(' ')' */;
+	}
+	*result = r;
+	ftdc_stats_phase( timed, FTDC_PHASE_FORMAT, &phase_start );
+	if ( out == NULL || out_size < r.length + 1 /* '\0' */ )  return FTDC_ERR_BUFFER_TOO_SMALL;
+
+	/* 4. Compute fractional part */
+
+	size_t cursor = 0;
+	memcpy( out, integer_str, integer_length );
+	cursor += integer_length;
+	if ( r.fraction_numerator != 0 ) {
+		FTDC_TRACE( "3. Compute fractional part of:  %llu / %llu", ( unsigned long long )r.fraction_numerator,
+			( unsigned long long )r.denominator );
+		cursor += ftdc_append_char( out, out_size, cursor, '.' );  // Append fractional part separator
+		if ( offset > 1 ) {
+			// Mark where digits start:  3.[1000]428571...
+			cursor += ftdc_append_char( out, out_size, cursor, '[' );
+			memcpy( out + cursor, offset_str, offset_length );
+			cursor += offset_length;
+			cursor += ftdc_append_char( out, out_size, cursor, ']' );
+		}
+
+		// Every thread jumps straight to its first digit, instead of walking to it digit by digit.
+		if ( r.repeating && r.period.period > 0 ) {
+			//  0.08  ->  0.08(  ->  0.08(3  ->  0.08(3)
+			r.digits = ( entry != NULL )
+				? ftdc_cache_compute_fraction( cache, entry, out + cursor, r.period.pre_period,
+					r.fraction_numerator, 1, options->threads_count, stats )
+				: ftdc_compute_fraction_counted( out + cursor, r.period.pre_period,
+					r.fraction_numerator, r.denominator, 1, options->threads_count, stats );
+			cursor += r.digits;
+			cursor += ftdc_append_char( out, out_size, cursor, '(' );
+			uint64_t period_digits = ( entry != NULL )
+				? ftdc_cache_compute_fraction( cache, entry, out + cursor, r.period.period,
+					r.fraction_numerator, 1 + r.period.pre_period, options->threads_count, stats )
+				: ftdc_compute_fraction_counted( out + cursor, r.period.period,
+					r.fraction_numerator, r.denominator, 1 + r.period.pre_period, options->threads_count, stats );
+			cursor += period_digits;
+			r.digits += period_digits;
+			cursor += ftdc_append_char( out, out_size, cursor, ')' );
+		} else {
+			r.digits = ( entry != NULL )
+				? ftdc_cache_compute_fraction( cache, entry, out + cursor, digits,
+					r.fraction_numerator, offset, options->threads_count, stats )
+				: ftdc_compute_fraction_counted( out + cursor, digits,
+					r.fraction_numerator, r.denominator, offset, options->threads_count, stats );
+			cursor += r.digits;
+		}
+	}
+	cursor += ftdc_append_char( out, out_size, cursor, '\0' );  // Null-terminate
+	ftdc_stats_phase( timed, FTDC_PHASE_FRACTION, &phase_start );
+	if ( stats != NULL )  stats->conversions += 1;
+
+	result->digits = r.digits;
+	return FTDC_OK;
+}
+
+// Converts `numerator / denominator` with up to `precision` fractional digits into `out`.  See `ftdc_convert_ex`.
+ftdc_status ftdc_convert( uint64_t numerator, uint64_t denominator, uint64_t precision,
+	char *out, size_t out_size, ftdc_result *result )
+{
+	ftdc_options options = { .precision = precision, .offset = 1, .repeating = false, .threads_count = 1 };
+	return ftdc_convert_ex( numerator, denominator, &options, out, out_size, result );
+}
+
+/* Arbitrary-precision operands */
+
+// Drops zero top limbs.
+static void ftdc_big_trim( ftdc_big *big ) {
+	while ( big->count > 0 && big->limbs[ big->count - 1 ] == 0 )  big->count -= 1;
+}
+
+static void ftdc_big_set_uint64( ftdc_big *big, uint64_t value ) {
+	big->limbs[ 0 ] = value;
+	big->count = ( value != 0 );
+}
+
+// `*big = *big * factor + addend`.  Returns false if it does not fit into `FTDC_BIG_CAPACITY` limbs.
+static bool ftdc_big_mul_add_limb( ftdc_big *big, uint64_t factor, uint64_t addend ) {
+	uint64_t carry = addend;
+	for ( int i = 0; i < big->count; i += 1 ) {
+		ftdc_u128 product = ( ftdc_u128 )big->limbs[ i ] * factor + carry;
+		big->limbs[ i ] = ( uint64_t )product;
+		carry = ( uint64_t )( product >> 64 );
+	}
+	if ( carry != 0 ) {
+		if ( big->count == FTDC_BIG_CAPACITY )  return false;
+		big->limbs[ big->count ] = carry;
+		big->count += 1;
+	}
+	return true;
+}
+
+// `*big /= divisor`.  Returns remainder.
+static uint64_t ftdc_big_div_limb( ftdc_big *big, uint64_t divisor ) {
+	ftdc_divider divider;
+	ftdc_divider_init( &divider, divisor );
+	uint64_t remainder = 0;
+	for ( int i = big->count - 1; i >= 0; i -= 1 ) {
+		big->limbs[ i ] = ftdc_divider_div( &divider, remainder, big->limbs[ i ], &remainder );
+	}
+	ftdc_big_trim( big );
+	return remainder;
+}
+
+// Parses decimal digits of `str` (all of it) into `*big`, 19 digits per multiplication.
+ftdc_status ftdc_big_parse( ftdc_big *big, const char *str ) {
+	big->count = 0;
+	if ( *str == '\0' )  return FTDC_ERR_INVALID_ARGUMENT;
+	while ( *str != '\0' ) {
+		uint64_t chunk = 0;
+		int digits = 0;
+		while ( digits < FTDC_CHUNK_DIGITS && *str != '\0' ) {
+			if ( *str < '0' || *str > '9' )  return FTDC_ERR_INVALID_ARGUMENT;
+			chunk = chunk * 10 + ( *str - '0' );
+			digits += 1;
+			str += 1;
+		}
+		if ( !ftdc_big_mul_add_limb( big, ftdc_pow10[ digits ], chunk ) || big->count > FTDC_BIG_LIMBS_MAX ) {
+			return FTDC_ERR_TOO_LARGE;
+		}
+	}
+	return FTDC_OK;
+}
+
+// Returns true and `*value` if `big` fits into 64 bits.
+bool ftdc_big_to_uint64( const ftdc_big *big, uint64_t *value ) {
+	if ( big->count > 1 )  return false;
+	*value = ( big->count == 1 ) ? big->limbs[ 0 ] : 0;
+	return true;
+}
+
+// Writes decimal notation of `big`, null-terminated.  Returns its length, 0 if `out_size` is too small.
+// Peels 19 digits per division off the bottom, then writes them top to bottom.
+size_t ftdc_big_to_string( char *out, size_t out_size, const ftdc_big *big ) {
+	uint64_t chunks[ FTDC_BIG_CAPACITY + 4 ];  // 10^19 > 2^63:  each takes at least 63 bits.
+	int chunks_count = 0;
+	ftdc_big value = *big;
+	do {
+		chunks[ chunks_count++ ] = ftdc_big_div_limb( &value, ftdc_pow10[ FTDC_CHUNK_DIGITS ] );
+	} while ( value.count > 0 );
+
+	char top[ INT64_MAX_DIGITS ];
+	int top_length = ftdc_append_uint64( top, sizeof( top ), 0, chunks[ chunks_count - 1 ], 0 );
+	size_t length = top_length + ( size_t )( chunks_count - 1 ) * FTDC_CHUNK_DIGITS;
+	if ( out_size < length + 1 )  return 0;
+
+	memcpy( out, top, top_length );
+	for ( int i = chunks_count - 2; i >= 0; i -= 1 ) {
+		ftdc_write_chunk( out + top_length + ( size_t )( chunks_count - 2 - i ) * FTDC_CHUNK_DIGITS, chunks[ i ] );
+	}
+	out[ length ] = '\0';
+	return length;
+}
+
+// Returns -1, 0 or 1 as `a` is less than, equal to or greater than `b`.
+int ftdc_big_compare( const ftdc_big *a, const ftdc_big *b ) {
+	if ( a->count != b->count )  return ( a->count < b->count ) ? -1 : 1;
+	for ( int i = a->count - 1; i >= 0; i -= 1 ) {
+		if ( a->limbs[ i ] != b->limbs[ i ] )  return ( a->limbs[ i ] < b->limbs[ i ] ) ? -1 : 1;
+	}
+	return 0;
+}
+
+// `*product = a * b`, schoolbook.  Operands must fit into `FTDC_BIG_LIMBS_MAX` limbs.
+static void ftdc_big_mul( ftdc_big *product, const ftdc_big *a, const ftdc_big *b ) {
+	ftdc_big p;
+	p.count = a->count + b->count;
+	memset( p.limbs, 0, p.count * sizeof( uint64_t ) );
+	for ( int i = 0; i < a->count; i += 1 ) {
+		uint64_t carry = 0;
+		for ( int j = 0; j < b->count; j += 1 ) {
+			ftdc_u128 t = ( ftdc_u128 )a->limbs[ i ] * b->limbs[ j ] + p.limbs[ i + j ] + carry;
+			p.limbs[ i + j ] = ( uint64_t )t;
+			carry = ( uint64_t )( t >> 64 );
+		}
+		p.limbs[ i + b->count ] = carry;
+	}
+	ftdc_big_trim( &p );
+	*product = p;
+}
+
+// Shifts `count` limbs of `src` left by `shift` (< 64) bits into `dst`.  Returns bits shifted out of the top.
+static uint64_t ftdc_big_shift_left( uint64_t *dst, const uint64_t *src, int count, int shift ) {
+	if ( shift == 0 ) {
+		memmove( dst, src, count * sizeof( uint64_t ) );
+		return 0;
+	}
+	uint64_t out = src[ count - 1 ] >> ( 64 - shift );
+	for ( int i = count - 1; i > 0; i -= 1 )  dst[ i ] = ( src[ i ] << shift ) | ( src[ i - 1 ] >> ( 64 - shift ) );
+	dst[ 0 ] = src[ 0 ] << shift;
+	return out;
+}
+
+// Shifts `count` limbs of `src` right by `shift` (< 64) bits into `dst`.
+static void ftdc_big_shift_right( uint64_t *dst, const uint64_t *src, int count, int shift ) {
+	if ( shift == 0 ) {
+		memmove( dst, src, count * sizeof( uint64_t ) );
+		return;
+	}
+	for ( int i = 0; i < count - 1; i += 1 )  dst[ i ] = ( src[ i ] >> shift ) | ( src[ i + 1 ] << ( 64 - shift ) );
+	dst[ count - 1 ] = src[ count - 1 ] >> shift;
+}
+
+// One step of Knuth's long division (TAOCP vol. 2, 4.3.1, algorithm D):  divides `n + 1` limbs of `u`
+//   by `n` (>= 2) limbs of normalized `v`, leaving remainder in the low `n` limbs of `u`.  Returns quotient limb.
+// `top` divides by the top limb of `v`.  Quotient must fit into a limb:  `u / v < 2^64`.
+static uint64_t ftdc_big_div_step( uint64_t *u, const uint64_t *v, int n, const ftdc_divider *top ) {
+	// Estimate from the top two limbs of `u` and the top limb of `v` is at most 2 too big,
+	//   checking against the next limb of `v` makes it at most 1 too big.
+	uint64_t q, r;
+	bool r_overflow = false;
+	if ( u[ n ] >= v[ n - 1 ] ) {
+		q = ~0llu;
+		r = u[ n - 1 ] + v[ n - 1 ];
+		r_overflow = ( r < u[ n - 1 ] );
+	} else {
+		q = ftdc_divider_div_normalized( top, u[ n ], u[ n - 1 ], &r );
+	}
+	while ( !r_overflow && ( ftdc_u128 )q * v[ n - 2 ] > ( ( ( ftdc_u128 )r << 64 ) | u[ n - 2 ] ) ) {
+		q -= 1;
+		r += v[ n - 1 ];
+		r_overflow = ( r < v[ n - 1 ] );
+	}
+
+	// u -= q * v
+	uint64_t carry = 0, borrow = 0;
+	for ( int i = 0; i < n; i += 1 ) {
+		ftdc_u128 product = ( ftdc_u128 )q * v[ i ] + carry;
+		carry = ( uint64_t )( product >> 64 );
+		uint64_t low = ( uint64_t )product;
+		uint64_t difference = u[ i ] - low;
+		uint64_t next_borrow = ( u[ i ] < low );
+		next_borrow += ( difference < borrow );
+		u[ i ] = difference - borrow;
+		borrow = next_borrow;
+	}
+	bool negative = ( u[ n ] < carry ) || ( u[ n ] - carry < borrow );
+	u[ n ] = u[ n ] - carry - borrow;
+
+	if ( negative ) {
+		// Rarely, estimate was still 1 too big:  add `v` back.
+		q -= 1;
+		carry = 0;
+		for ( int i = 0; i < n; i += 1 ) {
+			ftdc_u128 sum = ( ftdc_u128 )u[ i ] + v[ i ] + carry;
+			u[ i ] = ( uint64_t )sum;
+			carry = ( uint64_t )( sum >> 64 );
+		}
+		u[ n ] += carry;
+	}
+	return q;
+}
+
+// `*quotient = u / v`,  `*remainder = u % v`.  Either can be NULL.  `v` must not be 0.
+void ftdc_big_divmod( ftdc_big *quotient, ftdc_big *remainder, const ftdc_big *u, const ftdc_big *v ) {
+	ftdc_big q = { 0 }, r = { 0 };
+	if ( ftdc_big_compare( u, v ) < 0 ) {
+		r = *u;
+	} else if ( v->count == 1 ) {
+		q = *u;
+		ftdc_big_set_uint64( &r, ftdc_big_div_limb( &q, v->limbs[ 0 ] ) );
+	} else {
+		// Normalize, so the top limb of divisor has its top bit set and quotient estimates are close.
+		int n = v->count, m = u->count - n;
+		int shift = __builtin_clzll( v->limbs[ n - 1 ] );
+		uint64_t vn[ FTDC_BIG_CAPACITY ];
+		uint64_t un[ FTDC_BIG_CAPACITY + 1 ];
+		ftdc_big_shift_left( vn, v->limbs, n, shift );
+		un[ m + n ] = ftdc_big_shift_left( un, u->limbs, m + n, shift );
+		ftdc_divider top;
+		ftdc_divider_init( &top, vn[ n - 1 ] );
+
+		for ( int j = m; j >= 0; j -= 1 )  q.limbs[ j ] = ftdc_big_div_step( un + j, vn, n, &top );
+		q.count = m + 1;
+		ftdc_big_trim( &q );
+		ftdc_big_shift_right( r.limbs, un, n, shift );
+		r.count = n;
+		ftdc_big_trim( &r );
+	}
+	if ( quotient != NULL )   *quotient = q;
+	if ( remainder != NULL )  *remainder = r;
+}
+
+// `*result = ka * a + kb * b`, where `ka` and `kb` have opposite signs (or one is 0),
+//   and the result is known to be non-negative.
+static void ftdc_big_combine( ftdc_big *result, int64_t ka, const ftdc_big *a, int64_t kb, const ftdc_big *b ) {
+	bool a_plus = ( kb <= 0 );
+	ftdc_big plus = a_plus ? *a : *b;
+	ftdc_big minus = a_plus ? *b : *a;
+	ftdc_big_mul_add_limb( &plus, ( uint64_t )( a_plus ? ka : kb ), 0 );
+	ftdc_big_mul_add_limb( &minus, ( uint64_t )( a_plus ? -kb : -ka ), 0 );
+	ftdc_big_trim( &plus );
+	ftdc_big_trim( &minus );
+
+	uint64_t borrow = 0;
+	for ( int i = 0; i < plus.count; i += 1 ) {
+		uint64_t subtrahend = ( i < minus.count ) ? minus.limbs[ i ] : 0;
+		uint64_t difference = plus.limbs[ i ] - subtrahend;
+		uint64_t next_borrow = ( plus.limbs[ i ] < subtrahend ) + ( difference < borrow );
+		plus.limbs[ i ] = difference - borrow;
+		borrow = next_borrow;
+	}
+	ftdc_big_trim( &plus );
+	*result = plus;
+}
+
+// Returns 62 bits of `big` starting from bit `start`.
+static int64_t ftdc_big_bits62( const ftdc_big *big, int start ) {
+	int limb = start / 64, offset = start % 64;
+	uint64_t bits = big->limbs[ limb ] >> offset;
+	if ( offset > 0 && limb + 1 < big->count )  bits |= big->limbs[ limb + 1 ] << ( 64 - offset );
+	return ( int64_t )( bits & ( ( 1llu << 62 ) - 1 ) );
+}
+
+// `*gcd = GCD( a, b )` by Lehmer's algorithm (TAOCP vol. 2, 4.5.2, algorithm L):  runs Euclid on the
+//   top 62 bits of both numbers in machine words, as long as their quotients are surely the same
+//   as the full numbers' ones, then applies all those steps to the full numbers at once.
+void ftdc_big_gcd( ftdc_big *gcd, const ftdc_big *a, const ftdc_big *b ) {
+	ftdc_big x = *a, y = *b, t;
+	if ( ftdc_big_compare( &x, &y ) < 0 ) {
+		t = x;
+		x = y;
+		y = t;
+	}
+
+	while ( y.count > 1 ) {
+		if ( x.count > y.count ) {
+			// Very different sizes:  one full division step shrinks `x` the most.
+			ftdc_big_divmod( NULL, &t, &x, &y );
+			x = y;
+			y = t;
+			continue;
+		}
+
+		int start = 64 * x.count - __builtin_clzll( x.limbs[ x.count - 1 ] ) - 62;
+		int64_t xh = ftdc_big_bits62( &x, start );
+		int64_t yh = ftdc_big_bits62( &y, start );
+		int64_t A = 1, B = 0, C = 0, D = 1;
+		while ( yh + C > 0 && yh + D > 0 && xh + A >= 0 && xh + B >= 0 ) {
+			int64_t q = ( xh + A ) / ( yh + C );
+			if ( q != ( xh + B ) / ( yh + D ) )  break;
+			int64_t T = A - q * C;  A = C;  C = T;
+			        T = B - q * D;  B = D;  D = T;
+			        T = xh - q * yh;  xh = yh;  yh = T;
+		}
+
+		if ( B == 0 ) {
+			// Top bits could not decide even a single quotient.
+			ftdc_big_divmod( NULL, &t, &x, &y );
+			x = y;
+			y = t;
+		} else {
+			//  x, y  ->  A x + B y,  C x + D y
+			ftdc_big_combine( &t, C, &x, D, &y );
+			ftdc_big_combine( &x, A, &x, B, &y );
+			y = t;
+		}
+	}
+
+	// The rest fits into machine words.
+	if ( y.count == 0 ) {
+		*gcd = x;
+		return;
+	}
+	uint64_t y64 = y.limbs[ 0 ];
+	ftdc_big_set_uint64( gcd, ftdc_GCD( y64, ftdc_big_div_limb( &x, y64 ) ) );
+}
+
+// Same as `ftdc_divider`, for 128-bit divisors above 64 bits:  3-by-2 limb division (Moller & Granlund).
+typedef struct ftdc_divider128 {
+	ftdc_u128 normalized;  // divisor << shift, top bit set.
+	uint64_t  reciprocal;  // floor( ( 2^192 - 1 ) / normalized ) - 2^64
+	int       shift;
+} ftdc_divider128;
+
+static void ftdc_divider128_init( ftdc_divider128 *divider, ftdc_u128 divisor ) {
+	int shift = __builtin_clzll( ( uint64_t )( divisor >> 64 ) );
+	ftdc_u128 d = divisor << shift;
+	uint64_t d1 = ( uint64_t )( d >> 64 ), d0 = ( uint64_t )d;
+
+	// Start from the 2-by-1 reciprocal of the top limb, and correct it for the low limb.
+	ftdc_divider top;
+	ftdc_divider_init( &top, d1 );
+	uint64_t v = top.reciprocal;
+	uint64_t p = d1 * v + d0;
+	if ( p < d0 ) {
+		v -= 1;
+		if ( p >= d1 ) {
+			v -= 1;
+			p -= d1;
+		}
+		p -= d1;
+	}
+	ftdc_u128 t = ( ftdc_u128 )v * d0;
+	uint64_t t1 = ( uint64_t )( t >> 64 ), t0 = ( uint64_t )t;
+	p += t1;
+	if ( p < t1 ) {
+		v -= 1;
+		if ( p > d1 || ( p == d1 && t0 >= d0 ) )  v -= 1;
+	}
+
+	divider->normalized = d;
+	divider->reciprocal = v;
+	divider->shift = shift;
+}
+
+// Divides `u2:u1:u0` by normalized divisor (`u2:u1 < normalized`).  Returns quotient limb.
+static inline uint64_t ftdc_divider128_div_normalized( const ftdc_divider128 *divider,
+	uint64_t u2, uint64_t u1, uint64_t u0, ftdc_u128 *remainder )
+{
+	const ftdc_u128 d = divider->normalized;
+	const uint64_t d1 = ( uint64_t )( d >> 64 ), d0 = ( uint64_t )d;
+	ftdc_u128 q = ( ftdc_u128 )divider->reciprocal * u2 + ( ( ( ftdc_u128 )u2 << 64 ) | u1 );
+	uint64_t q1 = ( uint64_t )( q >> 64 ), q0 = ( uint64_t )q;
+
+	// Everything is modulo 2^128, the estimate is off by at most one either way.
+	uint64_t r1 = u1 - d1 * q1;
+	ftdc_u128 r = ( ( ( ftdc_u128 )r1 << 64 ) | u0 ) - d - ( ftdc_u128 )d0 * q1;
+	q1 += 1;
+	if ( ( uint64_t )( r >> 64 ) >= q0 ) {
+		q1 -= 1;
+		r += d;
+	}
+	if ( r >= d ) {
+		q1 += 1;
+		r -= d;
+	}
+	*remainder = r;
+	return q1;
+}
+
+// Same as `ftdc_compute_fraction`, for 128-bit denominators above 64 bits:
+//   `remainder * 10^19` takes 3 limbs and divides with multiplications only, like 64-bit ones do.
+static uint64_t ftdc_compute_fraction_128( char *out, uint64_t count, ftdc_u128 *remainder, ftdc_u128 denominator ) {
+	ftdc_divider128 divider;
+	ftdc_divider128_init( &divider, denominator );
+
+	ftdc_u128 r = *remainder << divider.shift;
+	uint64_t written = 0;
+	while ( written < count && r != 0 ) {
+		uint64_t digits_left = count - written;
+		int step = ( digits_left < FTDC_CHUNK_DIGITS ) ? ( int )digits_left : FTDC_CHUNK_DIGITS;
+
+		// r * 10^step  ->  u2:u1:u0
+		ftdc_u128 low = ( ftdc_u128 )( uint64_t )r * ftdc_pow10[ step ];
+		ftdc_u128 high = ( ftdc_u128 )( uint64_t )( r >> 64 ) * ftdc_pow10[ step ] + ( uint64_t )( low >> 64 );
+		uint64_t chunk = ftdc_divider128_div_normalized( &divider,
+			( uint64_t )( high >> 64 ), ( uint64_t )high, ( uint64_t )low, &r );
+
+		if ( step == FTDC_CHUNK_DIGITS )  ftdc_write_chunk( out + written, chunk );
+		else                              ftdc_write_chunk_partial( out + written, chunk, step );
+		written += step;
+	}
+
+	if ( r == 0 ) {
+		while ( written > 0 && out[ written - 1 ] == '0' )  written -= 1;
+	}
+	*remainder = r >> divider.shift;
+	return written;
+}
+
+static ftdc_u128 ftdc_big_to_u128( const ftdc_big *big ) {
+	ftdc_u128 value = 0;
+	if ( big->count > 0 )  value = big->limbs[ 0 ];
+	if ( big->count > 1 )  value |= ( ftdc_u128 )big->limbs[ 1 ] << 64;
+	return value;
+}
+
+static void ftdc_big_set_u128( ftdc_big *big, ftdc_u128 value ) {
+	big->limbs[ 0 ] = ( uint64_t )value;
+	big->limbs[ 1 ] = ( uint64_t )( value >> 64 );
+	big->count = 2;
+	ftdc_big_trim( big );
+}
+
+// Computes up to `count` fractional digits of `*remainder / denominator` into `out`, same as `ftdc_compute_fraction`:
+//   19 digits per step, each being a single quotient limb of Knuth's division of `remainder * 10^19`.
+// Returns digits written.  Not null-terminated.
+uint64_t ftdc_big_compute_fraction( char *out, uint64_t count, ftdc_big *remainder, const ftdc_big *denominator ) {
+	int n = denominator->count;
+	if ( n == 1 ) {
+		uint64_t r = ( remainder->count == 1 ) ? remainder->limbs[ 0 ] : 0;
+		uint64_t written = ftdc_compute_fraction( out, count, &r, denominator->limbs[ 0 ] );
+		ftdc_big_set_uint64( remainder, r );
+		return written;
+	} else if ( n == 2 ) {
+		ftdc_u128 r = ftdc_big_to_u128( remainder );
+		uint64_t written = ftdc_compute_fraction_128( out, count, &r, ftdc_big_to_u128( denominator ) );
+		ftdc_big_set_u128( remainder, r );
+		return written;
+	}
+
+	// Remainder is kept normalized together with denominator, see `ftdc_compute_fraction`.
+	int shift = __builtin_clzll( denominator->limbs[ n - 1 ] );
+	uint64_t dn[ FTDC_BIG_CAPACITY ];
+	uint64_t rn[ FTDC_BIG_CAPACITY + 1 ] = { 0 };
+	ftdc_big_shift_left( dn, denominator->limbs, n, shift );
+	if ( remainder->count > 0 )  rn[ remainder->count ] = ftdc_big_shift_left( rn, remainder->limbs, remainder->count, shift );
+	ftdc_divider top;
+	ftdc_divider_init( &top, dn[ n - 1 ] );
+
+	uint64_t written = 0;
+	bool zero = ( remainder->count == 0 );
+	while ( written < count && !zero ) {
+		uint64_t digits_left = count - written;
+		int step = ( digits_left < FTDC_CHUNK_DIGITS ) ? ( int )digits_left : FTDC_CHUNK_DIGITS;
+
+		// rn * 10^step  ->  n + 1 limbs
+		uint64_t carry = 0;
+		for ( int i = 0; i < n; i += 1 ) {
+			ftdc_u128 product = ( ftdc_u128 )rn[ i ] * ftdc_pow10[ step ] + carry;
+			rn[ i ] = ( uint64_t )product;
+			carry = ( uint64_t )( product >> 64 );
+		}
+		rn[ n ] = carry;
+		uint64_t chunk = ftdc_big_div_step( rn, dn, n, &top );
+
+		if ( step == FTDC_CHUNK_DIGITS )  ftdc_write_chunk( out + written, chunk );
+		else                              ftdc_write_chunk_partial( out + written, chunk, step );
+		written += step;
+
+		uint64_t bits = 0;
+		for ( int i = 0; i < n; i += 1 )  bits |= rn[ i ];
+		zero = ( bits == 0 );
+	}
+
+	if ( zero ) {
+		while ( written > 0 && out[ written - 1 ] == '0' )  written -= 1;
+	}
+	ftdc_big_shift_right( remainder->limbs, rn, n, shift );
+	remainder->count = n;
+	ftdc_big_trim( remainder );
+	return written;
+}
+
+// Returns remainder the digit at `position` (1-based) of `numerator / denominator` is computed from,
+//   same as `ftdc_seek_remainder`:  `numerator * 10^(position - 1) mod denominator`.
+static ftdc_big ftdc_big_seek_remainder( const ftdc_big *numerator, const ftdc_big *denominator, uint64_t position ) {
+	ftdc_big result, base;
+	ftdc_big_set_uint64( &result, 1 );
+	ftdc_big_set_uint64( &base, 10 );
+	ftdc_big_divmod( NULL, &base, &base, denominator );
+	for ( uint64_t exponent = position - 1; exponent > 0; exponent >>= 1 ) {
+		if ( exponent & 1 ) {
+			ftdc_big_mul( &result, &result, &base );
+			ftdc_big_divmod( NULL, &result, &result, denominator );
+		}
+		ftdc_big_mul( &base, &base, &base );
+		ftdc_big_divmod( NULL, &base, &base, denominator );
+	}
+	ftdc_big_mul( &result, &result, numerator );
+	ftdc_big_divmod( NULL, &result, &result, denominator );
+	return result;
+}
+
+// Converts `numerator / denominator` of any size up to `FTDC_BIG_LIMBS_MAX` limbs, same as `ftdc_convert_ex`.
+// Operands up to 128 bits take native `ftdc_u128` paths (binary GCD, 3-by-2 limb division in the digit loop).
+// Fraction is fully reduced.  Period is only found when denominator, without factors of 2 and 5,
+//   fits into 64 bits.  Fractional digits are computed on the calling thread.
+ftdc_status ftdc_convert_big( const ftdc_big *numerator, const ftdc_big *denominator, const ftdc_options *options,
+	char *out, size_t out_size, ftdc_big_result *result )
+{
+	if ( options == NULL || result == NULL )  return FTDC_ERR_INVALID_ARGUMENT;
+	if ( denominator->count == 0 )  return FTDC_ERR_DENOMINATOR_ZERO;
+	if ( numerator->count > FTDC_BIG_LIMBS_MAX || denominator->count > FTDC_BIG_LIMBS_MAX )  return FTDC_ERR_TOO_LARGE;
+	uint64_t offset = ( options->offset > 1 ) ? options->offset : 1;
+	ftdc_big_result *r = result;
+	memset( r, 0, sizeof( *r ) );
+	ftdc_stats *stats = options->stats;
+	ftdc_stats *timed = ftdc_stats_timed( stats );
+	uint64_t phase_start = ( timed != NULL ) ? ftdc_ticks() : 0;
+
+	if ( numerator->count <= 2 && denominator->count <= 2 ) {
+		// Up to 128 bits:  native 128-bit arithmetic instead of limb loops.
+		ftdc_u128 n = ftdc_big_to_u128( numerator ), d = ftdc_big_to_u128( denominator );
+
+		/* 1. Simplify fraction */
+
+		ftdc_u128 gcd = ftdc_GCD128( n, d );
+		n /= gcd;
+		d /= gcd;
+		ftdc_big_set_u128( &r->numerator, n );
+		ftdc_big_set_u128( &r->denominator, d );
+		ftdc_stats_phase( timed, FTDC_PHASE_SIMPLIFY, &phase_start );
+
+		/* 2. Extract integer part */
+
+		ftdc_big_set_u128( &r->integer, n / d );
+		ftdc_big_set_u128( &r->fraction_numerator, n % d );
+	} else {
+		/* 1. Simplify fraction */
+
+		ftdc_big gcd;
+		if ( numerator->count == 0 )  ftdc_big_set_uint64( &gcd, 1 );
+		else                          ftdc_big_gcd( &gcd, numerator, denominator );
+		ftdc_big_divmod( &r->numerator, NULL, numerator, &gcd );
+		ftdc_big_divmod( &r->denominator, NULL, denominator, &gcd );
+		ftdc_stats_phase( timed, FTDC_PHASE_SIMPLIFY, &phase_start );
+
+		/* 2. Extract integer part */
+
+		ftdc_big_divmod( &r->integer, &r->fraction_numerator, &r->numerator, &r->denominator );
+	}
+	ftdc_stats_phase( timed, FTDC_PHASE_INTEGER, &phase_start );
+
+	/* 3. Size output */
+
+	// d  =  2^a * 5^b * m  ->  pre-period max( a, b ), terminates if m is 1.
+	uint64_t digits = options->precision;
+	bool terminates = false;
+	if ( r->fraction_numerator.count != 0 ) {
+		ftdc_big stripped = r->denominator, quotient;
+		uint64_t twos = 0, fives = 0;
+		while ( ( stripped.limbs[ 0 ] & 1 ) == 0 ) {
+			ftdc_big_div_limb( &stripped, 2 );
+			twos += 1;
+		}
+		while ( quotient = stripped, ftdc_big_div_limb( &quotient, 5 ) == 0 ) {
+			stripped = quotient;
+			fives += 1;
+		}
+		r->period.pre_period = ( twos > fives ) ? twos : fives;
+		terminates = ( stripped.count == 1 && stripped.limbs[ 0 ] == 1 );
+
+		uint64_t m;
+		if ( options->repeating && offset == 1 ) {
+			if ( terminates || ftdc_big_to_uint64( &stripped, &m ) ) {
+				r->period.period = terminates ? 0 : ftdc_order10( m );
+				r->repeating = ( r->period.pre_period + r->period.period <= digits );
+				if ( r->repeating )  digits = r->period.pre_period + r->period.period;
+			} else {
+				r->period_unknown = true;
+			}
+		}
+		if ( terminates ) {
+			uint64_t length = r->period.pre_period;
+			if ( offset > length )                    digits = 0;
+			else if ( digits > length - offset + 1 )  digits = length - offset + 1;
+		}
+	} else {
+		digits = 0;
+	}
+
+	char offset_str[ INT64_MAX_DIGITS ];
+	int offset_length = ( offset > 1 ) ? ftdc_append_uint64( offset_str, sizeof( offset_str ), 0, offset, 0 ) : 0;
+	char integer_str[ FTDC_BIG_DIGITS_MAX + 1 ];
+	size_t integer_length = ftdc_big_to_string( integer_str, sizeof( integer_str ), &r->integer );
+
+	r->length = integer_length;
+	if ( r->fraction_numerator.count != 0 ) {
+		r->length += 1 /* '.' */ + digits;
+		if ( offset > 1 )                              r->length += 2 /* '[' ']' */ + offset_length;
+		if ( r->repeating && r->period.period > 0 )  r->length += 2 /* '(' ')' */;
+	}
+	ftdc_stats_phase( timed, FTDC_PHASE_FORMAT, &phase_start );
+	if ( out == NULL || out_size < r->length + 1 /* '\0' */ )  return FTDC_ERR_BUFFER_TOO_SMALL;
+
+	/* 4. Compute fractional part */
+
+	size_t cursor = 0;
+	memcpy( out, integer_str, integer_length );
+	cursor += integer_length;
+	if ( r->fraction_numerator.count != 0 ) {
+		cursor += ftdc_append_char( out, out_size, cursor, '.' );
+		if ( offset > 1 ) {
+			cursor += ftdc_append_char( out, out_size, cursor, '[' );
+			memcpy( out + cursor, offset_str, offset_length );
+			cursor += offset_length;
+			cursor += ftdc_append_char( out, out_size, cursor, ']' );
+		}
+
+		ftdc_big remainder = ( offset > 1 )
+			? ftdc_big_seek_remainder( &r->fraction_numerator, &r->denominator, offset )
+			: r->fraction_numerator;
+		if ( r->repeating && r->period.period > 0 ) {
+			r->digits = ftdc_big_compute_fraction( out + cursor, r->period.pre_period, &remainder, &r->denominator );
+			cursor += r->digits;
+			cursor += ftdc_append_char( out, out_size, cursor, '(' );
+			uint64_t period_digits = ftdc_big_compute_fraction( out + cursor, r->period.period, &remainder, &r->denominator );
+			cursor += period_digits;
+			r->digits += period_digits;
+			cursor += ftdc_append_char( out, out_size, cursor, ')' );
+		} else {
+			r->digits = ftdc_big_compute_fraction( out + cursor, digits, &remainder, &r->denominator );
+			cursor += r->digits;
+		}
+		ftdc_stats_count_fraction( stats, r->digits, ( offset > 1 ) ? 1 : 0 );
+	}
+	cursor += ftdc_append_char( out, out_size, cursor, '\0' );
+	ftdc_stats_phase( timed, FTDC_PHASE_FRACTION, &phase_start );
+	if ( stats != NULL )  stats->conversions += 1;
+	return FTDC_OK;
+}
+
+#endif /* FTDC_IMPLEMENTATION */
@@ -0,0 +1,293 @@
+// ftdc_bench  --  Benchmark of `ftdc.h` conversion core.
+//
+// Build:  `cc -O2 -pthread -o ftdc_bench ftdc_bench.c`
+// Usage:  `ftdc_bench [--repeats=5] [--warmup=1] [--max-precision=1000000000] [--threads=1] [--base=10]
+//                     [--format=text|csv|json]`
+//         `ftdc_bench --verify`
+//
+// Runs every denominator of the matrix below with every precision (10, 10^3, ... up to `--max-precision`),
+//   and reports digits per second, nanoseconds per fraction and peak resident memory.
+// Each configuration is warmed up, then repeated, reporting median and min/max over repeats.
+// `--base` writes digits in another base (2 to 36), the same for the whole run.
+// `csv` and `json` (one object per line) formats are meant for tracking regressions between releases.
+// `--verify` instead checks `ftdc_divider` against hardware division and exits with non-zero code on mismatch.
+
+#define FTDC_IMPLEMENTATION
+#include "ftdc.h"
+
+#if defined( _WIN32 )
+	#include <Psapi.h>
+	#pragma comment(lib, "psapi.lib")
+#else
+	#include <time.h>
+	#include <sys/resource.h>
+#endif
+
+#define FTDC_BENCH_PRINT( format, ... ) \
+	LOGGER_INFO( stdout, NULL, 0, format, ##__VA_ARGS__ )
+
+#define FTDC_BENCH_WARN( format, ... ) \
+	LOGGER_WARN( stderr, "WARNING: ", 9, format, ##__VA_ARGS__ )
+
+// Each repeat converts fractions until it has produced at least this many digits,
+//   so short precisions are timed over many fractions rather than a single one.
+#define FTDC_BENCH_DIGITS_PER_REPEAT 10000000llu
+
+#define FTDC_BENCH_REPEATS_MAX 64
+
+typedef struct ftdc_bench_denominator {
+	const char *kind;
+	uint64_t    value;
+} ftdc_bench_denominator;
+
+static const ftdc_bench_denominator ftdc_bench_denominators[] = {
+	{ "small",      7 },
+	{ "small",      97 },
+	{ "prime",      999999937 },
+	{ "prime",      18446744073709551557llu },  // Largest 64-bit prime
+	{ "2^a*5^b",    1048576llu * 78125 },       // 2^20 * 5^7, terminates after 20 digits
+	{ "2^a*5^b",    9223372036854775808llu },   // 2^63, terminates after 63 digits
+	{ "near-2^64",  18446744073709551615llu },  // 2^64 - 1
+	{ "near-2^64",  18446744073709551000llu },
+};
+
+typedef enum ftdc_bench_format {
+	FTDC_BENCH_TEXT = 0,
+	FTDC_BENCH_CSV,
+	FTDC_BENCH_JSON
+} ftdc_bench_format;
+
+static double ftdc_bench_now_ns( void ) {
+#if defined( _WIN32 )
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &counter );
+	return ( double )counter.QuadPart * 1e9 / ( double )frequency.QuadPart;
+#else
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return ( double )now.tv_sec * 1e9 + ( double )now.tv_nsec;
+#endif
+}
+
+// Returns peak resident set size of the process in KiB, 0 if unknown.
+static uint64_t ftdc_bench_peak_rss_kb( void ) {
+#if defined( _WIN32 )
+	PROCESS_MEMORY_COUNTERS counters;
+	if ( !GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) )  return 0;
+	return counters.PeakWorkingSetSize / 1024;
+#else
+	struct rusage usage;
+	if ( getrusage( RUSAGE_SELF, &usage ) != 0 )  return 0;
+	return ( uint64_t )usage.ru_maxrss;  // Already KiB on Linux.
+#endif
+}
+
+static int ftdc_bench_compare_double( const void *a, const void *b ) {
+	double x = *( const double * )a, y = *( const double * )b;
+	return ( x > y ) - ( x < y );
+}
+
+typedef struct ftdc_bench_sample {
+	double   ns;         // Wall time of the repeat.
+	uint64_t fractions;  // Fractions converted.
+	uint64_t digits;     // Fractional digits produced.
+} ftdc_bench_sample;
+
+// Converts fractions over `denominator` until enough digits are produced.
+static ftdc_bench_sample ftdc_bench_run( uint64_t denominator, const ftdc_options *options, char *out, size_t out_size ) {
+	ftdc_bench_sample sample = { 0 };
+	uint64_t target = ( options->precision < FTDC_BENCH_DIGITS_PER_REPEAT ) ? FTDC_BENCH_DIGITS_PER_REPEAT : options->precision;
+	uint64_t numerator = 1;
+	ftdc_result result;
+	double start = ftdc_bench_now_ns();
+	do {
+		ftdc_convert_ex( numerator, denominator, options, out, out_size, &result );
+		sample.fractions += 1;
+		sample.digits += result.digits;
+		// Next numerator in [1; denominator), so every fraction has a fractional part to compute.
+		numerator = ( numerator * 6364136223846793005llu + 1442695040888963407llu ) % denominator;
+		if ( numerator == 0 )  numerator = 1;
+	} while ( sample.fractions * options->precision < target );
+	sample.ns = ftdc_bench_now_ns() - start;
+	return sample;
+}
+
+// Checks single division by `divider` against hardware `divq`.  Returns `true` if they match.
+static bool ftdc_bench_verify_division( const ftdc_divider *divider, uint64_t hi, uint64_t lo ) {
+	uint64_t r_expected, r;
+	uint64_t q_expected = ftdc_div_128by64( hi, lo, divider->divisor, &r_expected );
+	uint64_t q = ftdc_divider_div( divider, hi, lo, &r );
+	if ( q == q_expected && r == r_expected )  return true;
+	FTDC_BENCH_WARN( "%llu:%llu / %llu  ->  %llu r %llu, expected %llu r %llu\n",
+		( unsigned long long )hi, ( unsigned long long )lo, ( unsigned long long )divider->divisor,
+		( unsigned long long )q, ( unsigned long long )r, ( unsigned long long )q_expected,
+		( unsigned long long )r_expected );
+	return false;
+}
+
+// Checks `ftdc_divider` bit-exactly against hardware division:  edge-case divisors (1, powers of 2,
+//   2^k +- 1, 2^64 - 1) and random divisors of every bit width, each with edge-case and random dividends.
+// Returns mismatches found.
+static uint64_t ftdc_bench_verify( void ) {
+	uint64_t divisors[ 64 * 4 + 1024 * 64 ];
+	size_t divisors_count = 0;
+	for ( int k = 0; k < 64; k += 1 ) {
+		uint64_t p = 1llu << k;
+		divisors[ divisors_count++ ] = p;
+		divisors[ divisors_count++ ] = p + 1;
+		divisors[ divisors_count++ ] = p - 1;  // 0 for k = 0, skipped below.
+		divisors[ divisors_count++ ] = ~0llu - p;
+	}
+	uint64_t state = 88172645463325252llu;
+	#define FTDC_BENCH_XORSHIFT( x ) ( x ^= x << 13, x ^= x >> 7, x ^= x << 17 )
+	for ( int bits = 1; bits <= 64; bits += 1 ) {
+		for ( int i = 0; i < 1024; i += 1 ) {
+			uint64_t x = FTDC_BENCH_XORSHIFT( state );
+			x = ( bits == 64 ) ? x : ( x & ( ( 1llu << bits ) - 1 ) ) | ( 1llu << ( bits - 1 ) );
+			divisors[ divisors_count++ ] = x;
+		}
+	}
+
+	uint64_t checks = 0, mismatches = 0;
+	for ( size_t i = 0; i < divisors_count; i += 1 ) {
+		uint64_t d = divisors[ i ];
+		if ( d == 0 )  continue;
+		ftdc_divider divider;
+		ftdc_divider_init( &divider, d );
+		// Extreme dividends:  largest allowed high half, smallest and largest low halves.
+		uint64_t his[] = { 0, d - 1, d >> 1 };
+		uint64_t los[] = { 0, 1, d - 1, d, ~0llu };
+		for ( int h = 0; h < 3; h += 1 ) {
+			for ( int l = 0; l < 5; l += 1 ) {
+				mismatches += !ftdc_bench_verify_division( &divider, his[ h ], los[ l ] );
+				checks += 1;
+			}
+		}
+		for ( int j = 0; j < 256; j += 1 ) {
+			uint64_t hi = FTDC_BENCH_XORSHIFT( state ) % d;
+			uint64_t lo = FTDC_BENCH_XORSHIFT( state );
+			mismatches += !ftdc_bench_verify_division( &divider, hi, lo );
+			checks += 1;
+		}
+	}
+	#undef FTDC_BENCH_XORSHIFT
+
+	FTDC_BENCH_PRINT( "Verified %llu divisions by %zu divisors: %llu mismatches.\n", ( unsigned long long )checks,
+		divisors_count, ( unsigned long long )mismatches );
+	return mismatches;
+}
+
+static char *ftdc_bench_option_value( char *arg ) {
+	while ( *arg != '\0' && *arg != '=' )  arg += 1;
+	return ( *arg == '=' ) ? arg + 1 : NULL;
+}
+
+int main( int arguments_count, char *arguments[] ) {
+	uint64_t repeats = 5;
+	uint64_t warmup = 1;
+	uint64_t precision_max = 1000000000;
+	ftdc_bench_format format = FTDC_BENCH_TEXT;
+	ftdc_options options = { .precision = 0, .offset = 1, .repeating = false, .threads_count = 1 };
+
+	for ( int i = 1; i < arguments_count; i += 1 ) {
+		char *arg = arguments[ i ];
+		char *value = ftdc_bench_option_value( arg );
+		if ( strcmp( arg, "--verify" ) == 0 ) {
+			return ( ftdc_bench_verify() == 0 ) ? 0 : -1;
+		} else if ( value == NULL ) {
+			FTDC_BENCH_WARN( "Unknown option '%s', ignoring it.\n", arg );
+		} else if ( strncmp( arg, "--repeats", 9 ) == 0 ) {
+			repeats = strtoull( value, NULL, 10 );
+			if ( repeats < 1 )  repeats = 1;
+			if ( repeats > FTDC_BENCH_REPEATS_MAX )  repeats = FTDC_BENCH_REPEATS_MAX;
+		} else if ( strncmp( arg, "--warmup", 8 ) == 0 ) {
+			warmup = strtoull( value, NULL, 10 );
+		} else if ( strncmp( arg, "--max-precision", 15 ) == 0 ) {
+			precision_max = strtoull( value, NULL, 10 );
+		} else if ( strncmp( arg, "--threads", 9 ) == 0 ) {
+			uint64_t threads = strtoull( value, NULL, 10 );
+			options.threads_count = ( threads == 0 ) ? ftdc_cpu_count() : ( threads > FTDC_THREADS_MAX ) ? FTDC_THREADS_MAX : ( int )threads;
+		} else if ( strncmp( arg, "--base", 6 ) == 0 ) {
+			uint64_t base = strtoull( value, NULL, 10 );
+			options.base = ( base < FTDC_BASE_MIN || base > FTDC_BASE_MAX ) ? 10 : ( int )base;
+		} else if ( strncmp( arg, "--format", 8 ) == 0 ) {
+			if      ( strcmp( value, "csv" ) == 0 )   format = FTDC_BENCH_CSV;
+			else if ( strcmp( value, "json" ) == 0 )  format = FTDC_BENCH_JSON;
+			else                                      format = FTDC_BENCH_TEXT;
+		} else {
+			FTDC_BENCH_WARN( "Unknown option '%s', ignoring it.\n", arg );
+		}
+	}
+
+	ftdc_detect_cpu();
+
+	// One output buffer for the largest precision, reused by every run.
+	size_t out_size = INT64_MAX_DIGITS + 1 + precision_max + 1;
+	char *out = FTDC_ALLOC( out_size, char );
+	if ( out == NULL ) {
+		LOGGER_ERROR( stderr, "ERROR: ", 7, "Could not allocate %zu bytes of output buffer, try lower `--max-precision`.\n", out_size );
+		return -1;
+	}
+
+	if ( format == FTDC_BENCH_CSV ) {
+		FTDC_BENCH_PRINT( "kind,denominator,precision,threads,repeats,fractions,digits,"
+			"digits_per_sec_median,digits_per_sec_min,digits_per_sec_max,ns_per_fraction_median,peak_rss_kb\n" );
+	} else if ( format == FTDC_BENCH_TEXT ) {
+		FTDC_BENCH_PRINT( "%-10s %20s %10s %14s %14s %14s %14s %12s\n",
+			"kind", "denominator", "precision", "digits/s", "(min)", "(max)", "ns/fraction", "peak RSS KiB" );
+	}
+
+	size_t denominators_count = sizeof( ftdc_bench_denominators ) / sizeof( ftdc_bench_denominators[ 0 ] );
+	for ( size_t d = 0; d < denominators_count; d += 1 ) {
+		const ftdc_bench_denominator *denominator = &ftdc_bench_denominators[ d ];
+		for ( uint64_t precision = 10; precision <= precision_max; precision *= 100 ) {
+			options.precision = precision;
+			for ( uint64_t i = 0; i < warmup; i += 1 )  ftdc_bench_run( denominator->value, &options, out, out_size );
+
+			ftdc_bench_sample samples[ FTDC_BENCH_REPEATS_MAX ];
+			double digits_per_sec[ FTDC_BENCH_REPEATS_MAX ];
+			double ns_per_fraction[ FTDC_BENCH_REPEATS_MAX ];
+			for ( uint64_t i = 0; i < repeats; i += 1 ) {
+				samples[ i ] = ftdc_bench_run( denominator->value, &options, out, out_size );
+				digits_per_sec[ i ] = ( double )samples[ i ].digits * 1e9 / samples[ i ].ns;
+				ns_per_fraction[ i ] = samples[ i ].ns / ( double )samples[ i ].fractions;
+			}
+			qsort( digits_per_sec, repeats, sizeof( double ), ftdc_bench_compare_double );
+			qsort( ns_per_fraction, repeats, sizeof( double ), ftdc_bench_compare_double );
+			double dps_median = digits_per_sec[ repeats / 2 ];
+			double dps_min = digits_per_sec[ 0 ];
+			double dps_max = digits_per_sec[ repeats - 1 ];
+			double ns_median = ns_per_fraction[ repeats / 2 ];
+			uint64_t rss = ftdc_bench_peak_rss_kb();
+
+			switch ( format ) {
+				case FTDC_BENCH_TEXT:
+					FTDC_BENCH_PRINT( "%-10s %20llu %10llu %14.4g %14.4g %14.4g %14.4g %12llu\n",
+						denominator->kind, ( unsigned long long )denominator->value, ( unsigned long long )precision,
+						dps_median, dps_min, dps_max, ns_median, ( unsigned long long )rss );
+					break;
+				case FTDC_BENCH_CSV:
+					FTDC_BENCH_PRINT( "%s,%llu,%llu,%d,%llu,%llu,%llu,%.0f,%.0f,%.0f,%.1f,%llu\n",
+						denominator->kind, ( unsigned long long )denominator->value, ( unsigned long long )precision,
+						options.threads_count, ( unsigned long long )repeats,
+						( unsigned long long )samples[ 0 ].fractions, ( unsigned long long )samples[ 0 ].digits,
+						dps_median, dps_min, dps_max, ns_median, ( unsigned long long )rss );
+					break;
+				case FTDC_BENCH_JSON:
+					FTDC_BENCH_PRINT( "{\"kind\":\"%s\",\"denominator\":%llu,\"precision\":%llu,\"threads\":%d,\"repeats\":%llu,"
+						"\"fractions\":%llu,\"digits\":%llu,\"digits_per_sec_median\":%.0f,\"digits_per_sec_min\":%.0f,"
+						"\"digits_per_sec_max\":%.0f,\"ns_per_fraction_median\":%.1f,\"peak_rss_kb\":%llu}\n",
+						denominator->kind, ( unsigned long long )denominator->value, ( unsigned long long )precision,
+						options.threads_count, ( unsigned long long )repeats,
+						( unsigned long long )samples[ 0 ].fractions, ( unsigned long long )samples[ 0 ].digits,
+						dps_median, dps_min, dps_max, ns_median, ( unsigned long long )rss );
+					break;
+			}
+			logger_flush();  // Written out before the next measurement starts.
+		}
+	}
+
+	FTDC_FREE( out );
+	return 0;
+}
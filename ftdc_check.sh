@@ -0,0 +1,40 @@
+#!/bin/sh
+# ftdc_check  --  Regression checks of `ftdc` output that only show from outside the process.
+#
+# Usage:  `./ftdc_check.sh [path/to/ftdc]`  (default `./ftdc`, build it first:  `cc -O2 -pthread -o ftdc ftdc.c`)
+#
+# Checks:
+#   order  --  With `--stats` and a result too long for the logger queue, stdout and stderr sharing a terminal
+#              (or a pipe, here) still come out in program order:  the whole `Result` line, then every `Stats` line.
+
+FTDC=${1:-./ftdc}
+FAILED=0
+
+fail() {
+	echo "FAIL: $*"
+	FAILED=1
+}
+
+# What every line of `2>&1` output is, in the order `ftdc` printed them.
+ACTUAL=$( "$FTDC" --stats -P=1000000 -- 1 999999937 2>&1 \
+	| awk '{ if ( $1 == "Stats:" ) print $1, ( $2 == "parse" ) ? "phases" : $3; else print $1 }' )
+EXPECTED="Set
+Given:
+Simplified:
+Result:
+Stats: phases
+Stats: conversions,
+Stats: allocations,"
+if [ "$ACTUAL" != "$EXPECTED" ]; then
+	fail "order:  stdout and stderr interleaved, got:"
+	printf '%s\n' "$ACTUAL" | cut -c 1-60
+fi
+
+# `Result` line is written whole, ending with the fraction it came from.
+TAIL=$( "$FTDC" --stats -P=1000000 -- 1 999999937 2>&1 | grep '^Result:' | tail -c 24 )
+if [ "$TAIL" != "( 0  +  1 / 999999937 )" ]; then
+	fail "order:  'Result' line cut by other output, ends with '$TAIL'"
+fi
+
+[ "$FAILED" -eq 0 ] && echo "OK"
+exit "$FAILED"
@@ -0,0 +1,204 @@
+// ftdc_loadgen  --  Load generator for `ftdc --serve`.
+//
+// Build:  `cc -O2 -pthread -o ftdc_loadgen ftdc_loadgen.c`
+// Usage:  `ftdc_loadgen --socket=PATH [--connections=16] [--pipeline=8] [--requests=200000] [--denominator-max=1000000]
+//            [--seed=1]`
+//
+// Opens `--connections` connections to the server, keeps up to `--pipeline` requests in flight on each,
+//   and sends random `numerator denominator` requests until `--requests` replies came back.
+// Reports requests per second and latency percentiles, from sending a request to receiving its reply line.
+// Runs on a single thread with epoll, so on the same box it takes one CPU away from the server.
+
+#define FTDC_IMPLEMENTATION
+#include "ftdc.h"
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define FTDC_LOADGEN_PRINT( format, ... ) \
+	LOGGER_INFO( stdout, NULL, 0, format, ##__VA_ARGS__ )
+
+#define FTDC_LOADGEN_ERROR( exit_code, format, ... ) \
+	LOGGER_ERROR( stderr, "ERROR: ", 7, format, ##__VA_ARGS__ ); \
+	exit( exit_code )
+
+#define FTDC_LOADGEN_PIPELINE_MAX 1024
+
+#define FTDC_LOADGEN_EVENTS_MAX 64
+
+// Longest request line:  two 64-bit numbers, separator and '\n'.
+#define FTDC_LOADGEN_REQUEST_MAX ( 2 * INT64_MAX_DIGITS + 2 )
+
+typedef struct ftdc_loadgen_connection {
+	int      fd;
+	uint64_t sent_ns[ FTDC_LOADGEN_PIPELINE_MAX ];  // Ring of send times of requests in flight, oldest first.
+	uint32_t oldest;
+	uint32_t in_flight;
+	bool     reply_start;  // Next byte starts a reply line.
+} ftdc_loadgen_connection;
+
+typedef struct ftdc_loadgen {
+	uint64_t  requests;         // To send in total.
+	uint64_t  sent;
+	uint64_t  received;
+	uint64_t  errors;           // Replies starting with `error:`.
+	uint64_t  denominator_max;
+	uint64_t  seed;             // xorshift64 state.
+	uint32_t  pipeline;
+	uint64_t *latencies_ns;     // Of every reply, in order received.
+} ftdc_loadgen;
+
+static uint64_t ftdc_loadgen_random( ftdc_loadgen *loadgen ) {
+	loadgen->seed ^= loadgen->seed << 13;
+	loadgen->seed ^= loadgen->seed >> 7;
+	loadgen->seed ^= loadgen->seed << 17;
+	return loadgen->seed;
+}
+
+// Sends requests until `pipeline` of them are in flight on `connection`, or all are sent.
+static void ftdc_loadgen_send( ftdc_loadgen *loadgen, ftdc_loadgen_connection *connection ) {
+	char buffer[ FTDC_LOADGEN_PIPELINE_MAX * FTDC_LOADGEN_REQUEST_MAX + 1 /* '\0' of the last line */ ];
+	size_t used = 0;
+	uint64_t now = ftdc_clock_ns();
+	while ( connection->in_flight < loadgen->pipeline && loadgen->sent < loadgen->requests ) {
+		uint64_t denominator = 1 + ftdc_loadgen_random( loadgen ) % loadgen->denominator_max;
+		uint64_t numerator = ftdc_loadgen_random( loadgen ) % ( 10 * denominator );
+		used += snprintf( buffer + used, sizeof( buffer ) - used, "%llu %llu\n",
+			( unsigned long long )numerator, ( unsigned long long )denominator );
+		connection->sent_ns[ ( connection->oldest + connection->in_flight ) % FTDC_LOADGEN_PIPELINE_MAX ] = now;
+		connection->in_flight += 1;
+		loadgen->sent += 1;
+	}
+
+	// Up to `pipeline` lines, about 43 KB with the largest one and longest numbers.  Socket is blocking,
+	//   so when they do not fit into the socket buffer, `send` waits for the server to read some.
+	size_t written = 0;
+	while ( written < used ) {
+		ssize_t count = send( connection->fd, buffer + written, used - written, MSG_NOSIGNAL );
+		if ( count < 0 && errno == EINTR )  continue;
+		if ( count < 0 ) {
+			FTDC_LOADGEN_ERROR( -3, "Could not send requests, server closed connection.\n" );
+		}
+		written += count;
+	}
+}
+
+// Reads replies available on `connection`, recording latency of every complete one.
+static void ftdc_loadgen_receive( ftdc_loadgen *loadgen, ftdc_loadgen_connection *connection ) {
+	char buffer[ 1 << 16 ];
+	ssize_t count = recv( connection->fd, buffer, sizeof( buffer ), 0 );
+	if ( count < 0 && ( errno == EAGAIN || errno == EINTR ) )  return;
+	if ( count <= 0 ) {
+		FTDC_LOADGEN_ERROR( -3, "Server closed connection with %u requests in flight.\n", connection->in_flight );
+	}
+
+	uint64_t now = ftdc_clock_ns();
+	for ( ssize_t i = 0; i < count; i += 1 ) {
+		if ( connection->reply_start && buffer[ i ] == 'e' )  loadgen->errors += 1;
+		connection->reply_start = ( buffer[ i ] == '\n' );
+		if ( buffer[ i ] != '\n' )  continue;
+		loadgen->latencies_ns[ loadgen->received ] = now - connection->sent_ns[ connection->oldest ];
+		loadgen->received += 1;
+		connection->oldest = ( connection->oldest + 1 ) % FTDC_LOADGEN_PIPELINE_MAX;
+		connection->in_flight -= 1;
+	}
+}
+
+static int ftdc_loadgen_compare( const void *a, const void *b ) {
+	uint64_t x = *( const uint64_t * )a, y = *( const uint64_t * )b;
+	return ( x > y ) - ( x < y );
+}
+
+static double ftdc_loadgen_percentile_us( const ftdc_loadgen *loadgen, double percentile ) {
+	uint64_t index = ( uint64_t )( percentile / 100.0 * ( double )( loadgen->received - 1 ) );
+	return ( double )loadgen->latencies_ns[ index ] / 1e3;
+}
+
+// Returns value of `--option=value` argument `arg`, or NULL if it is not `name`.
+static const char *ftdc_loadgen_option( const char *arg, const char *name ) {
+	size_t length = strlen( name );
+	if ( strncmp( arg, name, length ) != 0 || arg[ length ] != '=' )  return NULL;
+	return arg + length + 1;
+}
+
+int main( int arguments_count, char *arguments[] ) {
+	const char *path = NULL;
+	uint64_t connections_count = 16;
+	ftdc_loadgen loadgen = { .requests = 200000, .denominator_max = 1000000, .seed = 1, .pipeline = 8 };
+	for ( int i = 1; i < arguments_count; i += 1 ) {
+		const char *value;
+		if      ( ( value = ftdc_loadgen_option( arguments[ i ], "--socket" ) ) != NULL )           path = value;
+		else if ( ( value = ftdc_loadgen_option( arguments[ i ], "--connections" ) ) != NULL )      connections_count = strtoull( value, NULL, 10 );
+		else if ( ( value = ftdc_loadgen_option( arguments[ i ], "--pipeline" ) ) != NULL )         loadgen.pipeline = ( uint32_t )strtoull( value, NULL, 10 );
+		else if ( ( value = ftdc_loadgen_option( arguments[ i ], "--requests" ) ) != NULL )         loadgen.requests = strtoull( value, NULL, 10 );
+		else if ( ( value = ftdc_loadgen_option( arguments[ i ], "--denominator-max" ) ) != NULL )  loadgen.denominator_max = strtoull( value, NULL, 10 );
+		else if ( ( value = ftdc_loadgen_option( arguments[ i ], "--seed" ) ) != NULL )             loadgen.seed = strtoull( value, NULL, 10 );
+		else {
+			FTDC_LOADGEN_ERROR( -1, "Unknown option '%s'.\n", arguments[ i ] );
+		}
+	}
+	if ( path == NULL ) {
+		FTDC_LOADGEN_ERROR( -1, "Usage: ftdc_loadgen --socket=PATH [--connections=16] [--pipeline=8] [--requests=200000]"
+			" [--denominator-max=1000000] [--seed=1]\n" );
+	}
+	if ( connections_count == 0 )  connections_count = 1;
+	if ( loadgen.pipeline == 0 )  loadgen.pipeline = 1;
+	if ( loadgen.pipeline > FTDC_LOADGEN_PIPELINE_MAX )  loadgen.pipeline = FTDC_LOADGEN_PIPELINE_MAX;
+	if ( loadgen.denominator_max == 0 )  loadgen.denominator_max = 1;
+	if ( loadgen.seed == 0 )  loadgen.seed = 1;
+
+	ftdc_loadgen_connection *connections = FTDC_ALLOC( connections_count, ftdc_loadgen_connection );
+	loadgen.latencies_ns = FTDC_ALLOC( loadgen.requests + 1, uint64_t );
+	if ( connections == NULL || loadgen.latencies_ns == NULL ) {
+		FTDC_LOADGEN_ERROR( -2, "Could not allocate memory for %llu connections and %llu requests.\n",
+			( unsigned long long )connections_count, ( unsigned long long )loadgen.requests );
+	}
+
+	struct sockaddr_un address = { .sun_family = AF_UNIX };
+	strncpy( address.sun_path, path, sizeof( address.sun_path ) - 1 );
+	int epoll = epoll_create1( 0 );
+	for ( uint64_t i = 0; i < connections_count; i += 1 ) {
+		ftdc_loadgen_connection *connection = &connections[ i ];
+		memset( connection, 0, sizeof( *connection ) );
+		connection->reply_start = true;
+		connection->fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+		if ( connection->fd < 0 || connect( connection->fd, ( struct sockaddr * )&address, sizeof( address ) ) != 0 ) {
+			FTDC_LOADGEN_ERROR( -3, "Could not connect to '%s'.\n", path );
+		}
+		struct epoll_event event = { .events = EPOLLIN, .data.ptr = connection };
+		epoll_ctl( epoll, EPOLL_CTL_ADD, connection->fd, &event );
+	}
+
+	uint64_t start_ns = ftdc_clock_ns();
+	for ( uint64_t i = 0; i < connections_count; i += 1 )  ftdc_loadgen_send( &loadgen, &connections[ i ] );
+	struct epoll_event events[ FTDC_LOADGEN_EVENTS_MAX ];
+	while ( loadgen.received < loadgen.requests ) {
+		int count = epoll_wait( epoll, events, FTDC_LOADGEN_EVENTS_MAX, -1 );
+		for ( int i = 0; i < count; i += 1 ) {
+			ftdc_loadgen_connection *connection = events[ i ].data.ptr;
+			ftdc_loadgen_receive( &loadgen, connection );
+			ftdc_loadgen_send( &loadgen, connection );
+		}
+	}
+	double seconds = ( double )( ftdc_clock_ns() - start_ns ) / 1e9;
+
+	qsort( loadgen.latencies_ns, loadgen.received, sizeof( uint64_t ), ftdc_loadgen_compare );
+	FTDC_LOADGEN_PRINT( "Requests:  %llu in %.3f s  ->  %.0f requests/s, %llu errors.\n",
+		( unsigned long long )loadgen.received, seconds, ( double )loadgen.received / seconds,
+		( unsigned long long )loadgen.errors );
+	if ( loadgen.received > 0 ) {
+		FTDC_LOADGEN_PRINT( "Latency:   p50 %.1f us, p90 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us"
+			"  (%llu connections, %u in flight each).\n",
+			ftdc_loadgen_percentile_us( &loadgen, 50.0 ), ftdc_loadgen_percentile_us( &loadgen, 90.0 ),
+			ftdc_loadgen_percentile_us( &loadgen, 99.0 ), ftdc_loadgen_percentile_us( &loadgen, 99.9 ),
+			ftdc_loadgen_percentile_us( &loadgen, 100.0 ), ( unsigned long long )connections_count, loadgen.pipeline );
+	}
+
+	for ( uint64_t i = 0; i < connections_count; i += 1 )  close( connections[ i ].fd );
+	close( epoll );
+	FTDC_FREE( connections );
+	FTDC_FREE( loadgen.latencies_ns );
+	return 0;
+}
@@ -0,0 +1,99 @@
+// ftdc_table_gen  --  Generates `ftdc_table.h`, the table of small-denominator expansions.
+//
+// Build:  `cc -O2 -o ftdc_table_gen ftdc_table_gen.c && ./ftdc_table_gen > ftdc_table.h`
+// Then build `ftdc` (or anything including `ftdc.h`) with `-DFTDC_TABLE` to compile the table in,
+//   `ftdc.h` refuses a table generated by another version of this program.
+// Usage:  `ftdc_table_gen [--repetend-digits-max=1024]`
+//
+// For every denominator below `FTDC_TABLE_SIZE` the table keeps what `ftdc_cache` would compute for it:
+//   reciprocal, pre-period, period and index of its repetend in a packed blob of 10^19 base limbs,
+//   so conversions over such denominators do no period finding and no per-denominator setup at runtime.
+// Repetends longer than `--repetend-digits-max` are left out (blob grows about quadratically with it,
+//   1024 digits is ~1.4 MB), those denominators still get everything else from the table.
+
+#define FTDC_IMPLEMENTATION
+#include "ftdc.h"
+
+#define FTDC_TABLE_GEN_SIZE 65536
+
+#define FTDC_TABLE_GEN_NONE UINT32_MAX
+
+int main( int argc, char **argv ) {
+	uint64_t repetend_digits_max = 1024;
+	for ( int i = 1; i < argc; i += 1 ) {
+		if ( strncmp( argv[ i ], "--repetend-digits-max=", 22 ) == 0 ) {
+			repetend_digits_max = strtoull( argv[ i ] + 22, NULL, 10 );
+		} else {
+			fprintf( stderr, "Usage: ftdc_table_gen [--repetend-digits-max=1024] > ftdc_table.h\n" );
+			return -1;
+		}
+	}
+
+	// Repetend of every stripped denominator is stored once, shared by all  2^a * 5^b * m  over it.
+	uint32_t *repetend_index = FTDC_ALLOC( FTDC_TABLE_GEN_SIZE, uint32_t );
+	uint16_t *periods = FTDC_ALLOC( FTDC_TABLE_GEN_SIZE, uint16_t );
+	char *digits = FTDC_ALLOC( FTDC_TABLE_GEN_SIZE + FTDC_CHUNK_DIGITS, char );
+	if ( repetend_index == NULL || periods == NULL || digits == NULL ) {
+		fprintf( stderr, "ERROR: Out of memory.\n" );
+		return -2;
+	}
+
+	printf( "// ftdc_table.h  --  Generated by `ftdc_table_gen --repetend-digits-max=%llu`, do not edit.\n\n",
+		( unsigned long long )repetend_digits_max );
+	printf( "#define FTDC_TABLE_GEN_VERSION %d\n", FTDC_TABLE_VERSION );
+	printf( "#define FTDC_TABLE_SIZE %d\n\n", FTDC_TABLE_GEN_SIZE );
+
+	// Repetends of  1 / m  as the integer  R  ( 1 / m  =  R / ( 10^L - 1 ) ),  least significant limb first.
+	printf( "static const uint64_t ftdc_table_repetends[] = {\n" );
+	uint32_t limbs_count = 0;
+	for ( uint32_t m = 0; m < FTDC_TABLE_GEN_SIZE; m += 1 ) {
+		repetend_index[ m ] = FTDC_TABLE_GEN_NONE;
+		periods[ m ] = 0;
+		if ( m < 3 || m % 2 == 0 || m % 5 == 0 )  continue;
+		uint64_t period = ftdc_order10( m );
+		periods[ m ] = ( uint16_t )period;
+		if ( period > repetend_digits_max )  continue;
+
+		uint64_t remainder = 1;
+		ftdc_compute_fraction( digits, period, &remainder, m );
+		uint64_t limbs = ( period + FTDC_CHUNK_DIGITS - 1 ) / FTDC_CHUNK_DIGITS;
+		repetend_index[ m ] = limbs_count;
+		printf( "\t/* %u */ ", m );
+		for ( uint64_t i = 0; i < limbs; i += 1 ) {
+			uint64_t end = period - i * FTDC_CHUNK_DIGITS;
+			uint64_t start = ( end > FTDC_CHUNK_DIGITS ) ? end - FTDC_CHUNK_DIGITS : 0;
+			uint64_t limb = 0;
+			for ( uint64_t j = start; j < end; j += 1 )  limb = limb * 10 + ( digits[ j ] - '0' );
+			printf( "%llullu,", ( unsigned long long )limb );
+		}
+		printf( "\n" );
+		limbs_count += ( uint32_t )limbs;
+	}
+	if ( limbs_count == 0 )  printf( "\t0\n" );  // No empty initializers in C.
+	printf( "};\n\n" );
+
+	// Rows:  { reciprocal, repetend, period, twos, fives }
+	printf( "static const ftdc_table_row ftdc_table[ FTDC_TABLE_SIZE ] = {\n" );
+	printf( "\t{ 0, UINT32_MAX, 0, 0, 0 },  // 0\n" );
+	for ( uint32_t d = 1; d < FTDC_TABLE_GEN_SIZE; d += 1 ) {
+		uint64_t m = d;
+		int twos = 0;
+		int fives = 0;
+		while ( m % 2 == 0 ) { m /= 2; twos += 1; }
+		while ( m % 5 == 0 ) { m /= 5; fives += 1; }
+		ftdc_divider divider;
+		ftdc_divider_init( &divider, d );
+		if ( repetend_index[ m ] == FTDC_TABLE_GEN_NONE )  printf( "\t{ 0x%016llxllu, UINT32_MAX, %u, %d, %d },",
+			( unsigned long long )divider.reciprocal, periods[ m ], twos, fives );
+		else                                               printf( "\t{ 0x%016llxllu, %u, %u, %d, %d },",
+			( unsigned long long )divider.reciprocal, repetend_index[ m ], periods[ m ], twos, fives );
+		if ( d % 16 == 0 )  printf( "  // %u", d );
+		printf( "\n" );
+	}
+	printf( "};\n" );
+
+	FTDC_FREE( repetend_index );
+	FTDC_FREE( periods );
+	FTDC_FREE( digits );
+	return 0;
+}
@@ -0,0 +1,433 @@
+// logger.h  --  Buffered asynchronous logger, shared by `ftdc` and `controller`.
+//
+// Single-header library.  Include it anywhere for declarations, and in exactly one C file define implementation:
+//   #define LOGGER_IMPLEMENTATION
+//   #include "logger.h"
+//
+// A call formats its message into a buffer of the calling thread and copies it into a lock-free queue,
+//   a background writer thread then writes queued messages to their streams, in order.
+// So logging costs a `vsnprintf` and a few atomic operations, not a locked stdio write,
+//   and traces in hot loops do not stall them on the terminal.
+//
+// Usage:
+//   LOGGER_WARN( stdout, "WARNING: ", 9, "Could not open '%s'.\n", path );
+//   logger_flush();  // Before writing to stdout or stderr directly, to keep order with queued messages.
+//
+// Calls below `LOGGER_LEVEL_MIN` (define it before including, default `LOGGER_LEVEL_INFO`) compile to nothing.
+// Queued messages are flushed at exit too, `exit` after an error message does not lose it.
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+
+#define LOGGER_LEVEL_TRACE 0  // Dropped instead of waiting when the queue is full, counted and reported at exit.
+#define LOGGER_LEVEL_INFO  1
+#define LOGGER_LEVEL_WARN  2
+#define LOGGER_LEVEL_ERROR 3
+
+#ifndef LOGGER_LEVEL_MIN
+	#define LOGGER_LEVEL_MIN LOGGER_LEVEL_INFO
+#endif
+
+// Longest message formatted on the calling thread, prefix included.
+// Longer ones flush the queue and are written straight to their stream.
+#define LOGGER_MESSAGE_SIZE 8192
+
+// Queue is a ring of this many cache-line slots, a message takes as many adjacent ones as it needs.
+#define LOGGER_QUEUE_SLOTS 4096
+#define LOGGER_SLOT_SIZE   64
+
+#if LOGGER_LEVEL_MIN <= LOGGER_LEVEL_TRACE
+	#define LOGGER_TRACE( stream, prefix, prefix_size, format, ... ) \
+		logger_printf( LOGGER_LEVEL_TRACE, stream, prefix, prefix_size, format, ##__VA_ARGS__ )
+#else
+	#define LOGGER_TRACE( stream, prefix, prefix_size, format, ... )
+#endif
+
+#if LOGGER_LEVEL_MIN <= LOGGER_LEVEL_INFO
+	#define LOGGER_INFO( stream, prefix, prefix_size, format, ... ) \
+		logger_printf( LOGGER_LEVEL_INFO, stream, prefix, prefix_size, format, ##__VA_ARGS__ )
+#else
+	#define LOGGER_INFO( stream, prefix, prefix_size, format, ... )
+#endif
+
+#if LOGGER_LEVEL_MIN <= LOGGER_LEVEL_WARN
+	#define LOGGER_WARN( stream, prefix, prefix_size, format, ... ) \
+		logger_printf( LOGGER_LEVEL_WARN, stream, prefix, prefix_size, format, ##__VA_ARGS__ )
+#else
+	#define LOGGER_WARN( stream, prefix, prefix_size, format, ... )
+#endif
+
+#if LOGGER_LEVEL_MIN <= LOGGER_LEVEL_ERROR
+	#define LOGGER_ERROR( stream, prefix, prefix_size, format, ... ) \
+		logger_printf( LOGGER_LEVEL_ERROR, stream, prefix, prefix_size, format, ##__VA_ARGS__ )
+#else
+	#define LOGGER_ERROR( stream, prefix, prefix_size, format, ... )
+#endif
+
+// Lets the compiler check arguments of every message against its format.
+#if defined( __GNUC__ )
+	#define LOGGER_PRINTF_FORMAT __attribute__(( format( printf, 5, 6 ) ))
+#else
+	#define LOGGER_PRINTF_FORMAT
+#endif
+
+void logger_printf( int level, FILE *stream, const char *prefix, size_t prefix_size, const char *format, ... ) LOGGER_PRINTF_FORMAT;
+void logger_vprintf( int level, FILE *stream, const char *prefix, size_t prefix_size, const char *format, va_list args );
+void logger_flush( void );
+
+#endif /* LOGGER_H */
+
+#if defined( LOGGER_IMPLEMENTATION ) && !defined( LOGGER_IMPLEMENTED )
+#define LOGGER_IMPLEMENTED
+
+#if defined( _WIN32 )
+	#include <Windows.h>
+#else
+	#include <pthread.h>  // Link with `-pthread`.
+	#include <sched.h>
+	#include <time.h>
+#endif
+
+#if defined( _MSC_VER ) && !defined( __clang__ )
+	#define LOGGER_THREAD_LOCAL __declspec( thread )
+#else
+	#define LOGGER_THREAD_LOCAL _Thread_local
+#endif
+
+#define LOGGER_SLOT_DATA ( LOGGER_SLOT_SIZE - sizeof( uint64_t ) )
+
+#define LOGGER_BATCH_SIZE ( 1 << 16 )
+
+// While messages keep coming, the writer wakes up this often to write them out, instead of on every message:
+//   waking it per message would cost a context switch each, more than the logging itself.
+#define LOGGER_NAP_MS 5
+
+typedef enum logger_sleep {
+	LOGGER_AWAKE = 0,
+	LOGGER_NAPPING,   // For `LOGGER_NAP_MS`, woken up early only when the queue fills up to half.
+	LOGGER_SLEEPING   // Until woken up, queue was empty for a whole nap.
+} logger_sleep;
+
+typedef enum logger_status {
+	LOGGER_STOPPED = 0,  // Nothing logged yet.
+	LOGGER_STARTING,
+	LOGGER_RUNNING,
+	LOGGER_FAILED        // Writer thread could not start, messages are written on calling threads.
+} logger_status;
+
+// Slots are free for a message of lap `L` (position / LOGGER_QUEUE_SLOTS) when `turn == 2 * L`,
+//   and hold one when `turn == 2 * L + 1`.  So a zeroed queue is an empty one, it needs no setup.
+typedef struct logger_slot {
+	volatile uint64_t turn;
+	char              data[ LOGGER_SLOT_DATA ];
+} logger_slot;
+
+// Start of every message in the queue, its text follows.
+typedef struct logger_header {
+	FILE    *stream;
+	uint64_t size;
+} logger_header;
+
+static struct {
+	logger_slot       slots[ LOGGER_QUEUE_SLOTS ];
+	volatile uint64_t head;  // Slots claimed by producers so far.
+	char              padding_head[ LOGGER_SLOT_SIZE - sizeof( uint64_t ) ];
+	volatile uint64_t tail;  // Slots read by the writer so far.
+	volatile uint64_t written;  // Slots whose messages are written out and flushed.
+	volatile uint64_t sleeping;  // `logger_sleep` of the writer.
+	volatile uint64_t status;
+	volatile uint64_t dropped;  // Traces that found the queue full.
+	volatile uint64_t drain_lock;
+	// Writer side only.
+	FILE             *batch_stream;
+	size_t            batch_used;
+	char              batch[ LOGGER_BATCH_SIZE ];
+} logger_state;
+
+#if defined( _WIN32 )
+static HANDLE logger_event;  // Auto-reset.
+#else
+static pthread_mutex_t logger_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t logger_cond = PTHREAD_COND_INITIALIZER;
+static int logger_pending = 0;
+#endif
+
+#if defined( _MSC_VER ) && !defined( __clang__ )
+static uint64_t logger_load( volatile uint64_t *value ) {
+	return ( uint64_t )InterlockedOr64( ( volatile LONG64 * )value, 0 );
+}
+static void logger_store( volatile uint64_t *value, uint64_t store ) {
+	InterlockedExchange64( ( volatile LONG64 * )value, ( LONG64 )store );
+}
+static uint64_t logger_fetch_add( volatile uint64_t *value, uint64_t add ) {
+	return ( uint64_t )InterlockedExchangeAdd64( ( volatile LONG64 * )value, ( LONG64 )add );
+}
+static int logger_compare_exchange( volatile uint64_t *value, uint64_t expected, uint64_t desired ) {
+	return InterlockedCompareExchange64( ( volatile LONG64 * )value, ( LONG64 )desired, ( LONG64 )expected ) == ( LONG64 )expected;
+}
+static void logger_fence( void ) {
+	MemoryBarrier();
+}
+#else
+static uint64_t logger_load( volatile uint64_t *value ) {
+	return __atomic_load_n( value, __ATOMIC_ACQUIRE );
+}
+static void logger_store( volatile uint64_t *value, uint64_t store ) {
+	__atomic_store_n( value, store, __ATOMIC_RELEASE );
+}
+static uint64_t logger_fetch_add( volatile uint64_t *value, uint64_t add ) {
+	return __atomic_fetch_add( value, add, __ATOMIC_ACQ_REL );
+}
+static int logger_compare_exchange( volatile uint64_t *value, uint64_t expected, uint64_t desired ) {
+	return __atomic_compare_exchange_n( value, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE );
+}
+static void logger_fence( void ) {
+	__atomic_thread_fence( __ATOMIC_SEQ_CST );
+}
+#endif
+
+static void logger_yield( void ) {
+#if defined( _WIN32 )
+	SwitchToThread();
+#else
+	sched_yield();
+#endif
+}
+
+static int logger_published( uint64_t position ) {
+	return logger_load( &logger_state.slots[ position % LOGGER_QUEUE_SLOTS ].turn ) == 2 * ( position / LOGGER_QUEUE_SLOTS ) + 1;
+}
+
+static void logger_wake( void ) {
+#if defined( _WIN32 )
+	SetEvent( logger_event );
+#else
+	pthread_mutex_lock( &logger_mutex );
+	logger_pending = 1;
+	pthread_cond_signal( &logger_cond );
+	pthread_mutex_unlock( &logger_mutex );
+#endif
+}
+
+// Waits for `logger_wake`, or `LOGGER_NAP_MS` at most if `nap`.
+static void logger_wait( int nap ) {
+#if defined( _WIN32 )
+	WaitForSingleObject( logger_event, nap ? LOGGER_NAP_MS : INFINITE );
+#else
+	struct timespec until;
+	clock_gettime( CLOCK_REALTIME, &until );
+	until.tv_nsec += LOGGER_NAP_MS * 1000000l;
+	if ( until.tv_nsec >= 1000000000l ) {
+		until.tv_sec += 1;
+		until.tv_nsec -= 1000000000l;
+	}
+	pthread_mutex_lock( &logger_mutex );
+	int timed_out = 0;
+	while ( !logger_pending && !timed_out ) {
+		if ( nap )  timed_out = ( pthread_cond_timedwait( &logger_cond, &logger_mutex, &until ) != 0 );
+		else        pthread_cond_wait( &logger_cond, &logger_mutex );
+	}
+	logger_pending = 0;
+	pthread_mutex_unlock( &logger_mutex );
+#endif
+}
+
+// Writes out the batch, flushing its stream so order with the other stream holds on a terminal too.
+static void logger_batch_flush( void ) {
+	if ( logger_state.batch_stream == NULL )  return;
+	fwrite( logger_state.batch, sizeof( char ), logger_state.batch_used, logger_state.batch_stream );
+	fflush( logger_state.batch_stream );
+	logger_state.batch_stream = NULL;
+	logger_state.batch_used = 0;
+}
+
+static void logger_batch_put( FILE *stream, const char *text, size_t size ) {
+	if ( stream != logger_state.batch_stream || logger_state.batch_used + size > LOGGER_BATCH_SIZE )  logger_batch_flush();
+	logger_state.batch_stream = stream;
+	memcpy( logger_state.batch + logger_state.batch_used, text, size );
+	logger_state.batch_used += size;
+}
+
+// Writes out messages queued so far, one lap of the queue at most.  Runs on one thread at a time only.
+static void logger_drain( void ) {
+	uint64_t tail = logger_state.tail;
+	uint64_t end = tail + LOGGER_QUEUE_SLOTS;
+	while ( tail < end && logger_published( tail ) ) {
+		logger_header header;
+		memcpy( &header, logger_state.slots[ tail % LOGGER_QUEUE_SLOTS ].data, sizeof( header ) );
+		uint64_t bytes = sizeof( header ) + header.size;
+		uint64_t count = ( bytes + LOGGER_SLOT_DATA - 1 ) / LOGGER_SLOT_DATA;
+		for ( uint64_t i = 0; i < count; i += 1 ) {
+			// Producer may still be copying the rest of its message.
+			while ( !logger_published( tail + i ) )  logger_yield();
+			logger_slot *slot = &logger_state.slots[ ( tail + i ) % LOGGER_QUEUE_SLOTS ];
+			size_t start = ( i == 0 ) ? sizeof( header ) : 0;
+			size_t stop = ( bytes - i * LOGGER_SLOT_DATA < LOGGER_SLOT_DATA ) ? bytes - i * LOGGER_SLOT_DATA : LOGGER_SLOT_DATA;
+			logger_batch_put( header.stream, slot->data + start, stop - start );
+			logger_store( &slot->turn, 2 * ( ( tail + i ) / LOGGER_QUEUE_SLOTS + 1 ) );
+		}
+		tail += count;
+		logger_store( &logger_state.tail, tail );
+	}
+	logger_batch_flush();
+	logger_store( &logger_state.written, tail );
+}
+
+// Drains the queue on the calling thread, when there is no writer thread.
+static void logger_drain_locked( void ) {
+	while ( !logger_compare_exchange( &logger_state.drain_lock, 0, 1 ) )  logger_yield();
+	while ( logger_published( logger_state.tail ) )  logger_drain();
+	logger_store( &logger_state.drain_lock, 0 );
+}
+
+static void logger_writer_run( void ) {
+	while ( 1 ) {
+		uint64_t tail = logger_state.tail;
+		logger_drain();
+		int nap = ( logger_state.tail != tail );
+		// Producers publish, then check `sleeping`;  writer sets `sleeping`, then checks for published messages.
+		// With a full fence on both sides one of them sees the other, no wake up from `LOGGER_SLEEPING` is lost.
+		logger_store( &logger_state.sleeping, nap ? LOGGER_NAPPING : LOGGER_SLEEPING );
+		logger_fence();
+		if ( !logger_published( logger_state.tail ) )  logger_wait( nap );
+		logger_store( &logger_state.sleeping, LOGGER_AWAKE );
+	}
+}
+
+#if defined( _WIN32 )
+static DWORD WINAPI logger_writer_thread( LPVOID unused ) {
+	( void )unused;
+	logger_writer_run();
+	return 0;
+}
+#else
+static void *logger_writer_thread( void *unused ) {
+	( void )unused;
+	logger_writer_run();
+	return NULL;
+}
+#endif
+
+static void logger_exit( void ) {
+	logger_flush();
+	uint64_t dropped = logger_load( &logger_state.dropped );
+	if ( dropped > 0 ) {
+		fprintf( stderr, "WARNING: %llu trace messages dropped, log queue was full.\n", ( unsigned long long )dropped );
+	}
+}
+
+// Starts the writer thread on first use.  Messages logged while it starts wait in the queue.
+static void logger_start( void ) {
+	if ( logger_load( &logger_state.status ) != LOGGER_STOPPED )  return;
+	if ( !logger_compare_exchange( &logger_state.status, LOGGER_STOPPED, LOGGER_STARTING ) )  return;
+
+#if defined( _WIN32 )
+	logger_event = CreateEventA( NULL, FALSE, FALSE, NULL );
+	HANDLE thread = ( logger_event != NULL ) ? CreateThread( NULL, 0, logger_writer_thread, NULL, 0, NULL ) : NULL;
+	int started = ( thread != NULL );
+	if ( started )  CloseHandle( thread );
+#else
+	pthread_t thread;
+	int started = ( pthread_create( &thread, NULL, logger_writer_thread, NULL ) == 0 );
+	if ( started )  pthread_detach( thread );
+#endif
+	atexit( logger_exit );
+	logger_store( &logger_state.status, started ? LOGGER_RUNNING : LOGGER_FAILED );
+	if ( !started )  logger_drain_locked();
+}
+
+// Copies `size` bytes of message at `message` (header and text) into the queue.
+static void logger_enqueue( int level, const char *message, uint64_t size ) {
+	uint64_t count = ( size + LOGGER_SLOT_DATA - 1 ) / LOGGER_SLOT_DATA;
+	if ( level == LOGGER_LEVEL_TRACE
+		&& logger_load( &logger_state.head ) + count - logger_load( &logger_state.tail ) > LOGGER_QUEUE_SLOTS )
+	{
+		logger_fetch_add( &logger_state.dropped, 1 );
+		return;
+	}
+
+	uint64_t position = logger_fetch_add( &logger_state.head, count );
+	for ( uint64_t i = 0; i < count; i += 1 ) {
+		logger_slot *slot = &logger_state.slots[ ( position + i ) % LOGGER_QUEUE_SLOTS ];
+		uint64_t lap = ( position + i ) / LOGGER_QUEUE_SLOTS;
+		while ( logger_load( &slot->turn ) != 2 * lap ) {
+			// Queue is full, wait for the writer to free slots.
+			if ( logger_load( &logger_state.status ) == LOGGER_FAILED )  logger_drain_locked();
+			else                                                          logger_yield();
+		}
+		uint64_t offset = i * LOGGER_SLOT_DATA;
+		memcpy( slot->data, message + offset, ( size - offset < LOGGER_SLOT_DATA ) ? size - offset : LOGGER_SLOT_DATA );
+		logger_store( &slot->turn, 2 * lap + 1 );
+	}
+
+	logger_fence();
+	uint64_t sleeping = logger_load( &logger_state.sleeping );
+	if ( sleeping == LOGGER_SLEEPING
+		|| ( sleeping == LOGGER_NAPPING && position + count - logger_load( &logger_state.tail ) >= LOGGER_QUEUE_SLOTS / 2 ) )
+	{
+		logger_wake();
+	}
+}
+
+void logger_vprintf( int level, FILE *stream, const char *prefix, size_t prefix_size, const char *format, va_list args ) {
+	static LOGGER_THREAD_LOCAL char message[ LOGGER_MESSAGE_SIZE ];
+	logger_start();
+	if ( logger_load( &logger_state.status ) == LOGGER_FAILED ) {
+		logger_drain_locked();
+		if ( prefix_size > 0 )  fwrite( prefix, sizeof( char ), prefix_size, stream );
+		vfprintf( stream, format, args );
+		fflush( stream );
+		return;
+	}
+
+	size_t text_size = LOGGER_MESSAGE_SIZE - sizeof( logger_header ) - prefix_size;
+	va_list copy;
+	va_copy( copy, args );
+	int length = vsnprintf( message + sizeof( logger_header ) + prefix_size, text_size, format, args );
+	if ( length < 0 || ( size_t )length >= text_size ) {
+		// Too long for the queue, like a whole expansion (or failed to format):  written in place of the message,
+		//   after everything before it and flushed before anything after it, so streams sharing a terminal stay in order.
+		logger_flush();
+		if ( prefix_size > 0 )  fwrite( prefix, sizeof( char ), prefix_size, stream );
+		vfprintf( stream, format, copy );
+		fflush( stream );
+		va_end( copy );
+		return;
+	}
+	va_end( copy );
+
+	logger_header header = { .stream = stream, .size = prefix_size + ( uint64_t )length };
+	memcpy( message, &header, sizeof( header ) );
+	if ( prefix_size > 0 )  memcpy( message + sizeof( header ), prefix, prefix_size );
+	logger_enqueue( level, message, sizeof( header ) + header.size );
+}
+
+void logger_printf( int level, FILE *stream, const char *prefix, size_t prefix_size, const char *format, ... ) {
+	va_list args;
+	va_start( args, format );
+	logger_vprintf( level, stream, prefix, prefix_size, format, args );
+	va_end( args );
+}
+
+// Waits until messages queued so far, by any thread, are written out and their streams flushed.
+void logger_flush( void ) {
+	uint64_t status = logger_load( &logger_state.status );
+	if ( status == LOGGER_STOPPED )  return;
+	if ( status == LOGGER_FAILED ) {
+		logger_drain_locked();
+		return;
+	}
+	uint64_t target = logger_load( &logger_state.head );
+	while ( logger_load( &logger_state.written ) < target ) {
+		if ( logger_load( &logger_state.sleeping ) != LOGGER_AWAKE )  logger_wake();
+		logger_yield();
+	}
+}
+
+#endif /* LOGGER_IMPLEMENTATION */